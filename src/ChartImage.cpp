@@ -1,6 +1,8 @@
 #include "ChartImage.h"
 #include "debug.h"
 #include "ChartItemTools.h"
+#include "scene.h"
+#include "tiledimage.h"
 #include <QMessageBox>
 
 ChartImage::ChartImage(const QString& filename, QGraphicsItem* parent)
@@ -9,19 +11,16 @@ ChartImage::ChartImage(const QString& filename, QGraphicsItem* parent)
     , mFilename(filename)
 {
     setZLayer("Background");
-    mPixmap = new QPixmap(filename);
+    init();
 
     // if the image is invalid
-    if (mPixmap->isNull())
+    if (!mImage->setFile(filename))
     {
         // show an error
         QMessageBox message;
         message.setText("The chosen file (" + filename + ") is not a valid image.");
         message.exec();
     }
-
-    setFlag(QGraphicsItem::ItemIsMovable);
-    setFlag(QGraphicsItem::ItemIsSelectable);
 }
 
 ChartImage::ChartImage(QDataStream& stream, QGraphicsItem* parent)
@@ -29,40 +28,77 @@ ChartImage::ChartImage(QDataStream& stream, QGraphicsItem* parent)
     , mLayer(0)
     , mFilename("Loaded from chart")
 {
+    init();
+
     // load the pixmap from the stream
-    mPixmap = new QPixmap();
-    stream >> *mPixmap;
+    QPixmap pixmap;
+    stream >> pixmap;
+    mImage->setImage(pixmap.toImage());
+}
+
+void
+ChartImage::init()
+{
+    mImage = new TiledImage(this);
+    connect(mImage, SIGNAL(tilesLoaded()), SLOT(tilesLoaded()));
 
     setFlag(QGraphicsItem::ItemIsMovable);
     setFlag(QGraphicsItem::ItemIsSelectable);
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges);
+    // paint is only given the part of the image that's exposed with this.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
 ChartImage::~ChartImage()
 {
-    delete mPixmap;
+    // deleting the item takes it out of its scene.
+    Scene::trackSelection(this, ItemSceneChange, QVariant());
+}
+
+QVariant
+ChartImage::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    Scene::trackSelection(this, change, value);
+    return QGraphicsObject::itemChange(change, value);
+}
+
+void
+ChartImage::tilesLoaded()
+{
+    update();
+}
+
+QImage
+ChartImage::image() const
+{
+    return mImage->image();
+}
+
+QSize
+ChartImage::imageSize() const
+{
+    return mImage->size();
 }
 
 QRectF
 ChartImage::boundingRect() const
 {
-    if (mPixmap)
-    {
-        QRectF bb = mPixmap->rect();
-        return bb;
-    }
-    else
-    {
-        WARN("No pixmap in ChartImage.");
-        return QRectF();
-    }
+    return QRectF(QPointF(0, 0), mImage->size());
 }
 
 void
-ChartImage::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* /*widget*/)
+ChartImage::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-    if (mPixmap)
+    int device = painter->device()->devType();
+    if (device == QInternal::Picture || device == QInternal::Printer)
+    {
+        // pictures can be played back at any size, give them everything.
+        mImage->paintFull(painter);
+    }
+    else
     {
-        painter->drawPixmap(option->rect.x(), option->rect.y(), *mPixmap);
+        // views get what's loaded so far, anything else is rendered once and can't wait.
+        mImage->paint(painter, option->exposedRect, !widget);
     }
     if (option->state & QStyle::State_Selected)
     {
@@ -75,19 +111,22 @@ ChartImage::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWi
 void
 ChartImage::setFile(const QString& filename)
 {
-    QPixmap* newPixmap = new QPixmap(filename);
+    TiledImage* image = new TiledImage(this);
 
-    // if the new pixmap is not a valid image, cancel the operation
-    if (newPixmap->isNull())
+    // if the new file is not a valid image, cancel the operation
+    if (!image->setFile(filename))
     {
-        delete newPixmap;
+        delete image;
         return;
     }
 
-    // otherwise, delete the old pixmap and replace it
-    delete mPixmap;
-    mPixmap = newPixmap;
+    // otherwise, replace the old image
+    prepareGeometryChange();
+    delete mImage;
+    mImage = image;
+    connect(mImage, SIGNAL(tilesLoaded()), SLOT(tilesLoaded()));
     mFilename = filename;
+    update();
 }
 
 void
@@ -7,6 +7,8 @@
 #include <QStyleOptionGraphicsItem>
 #include <QDataStream>
 
+class TiledImage;
+
 class ChartImage : public QGraphicsObject
 {
     Q_OBJECT
@@ -28,11 +30,11 @@ public:
         return Type;
     }
 
-    const QPixmap*
-    pixmap() const
-    {
-        return mPixmap;
-    }
+    /**
+     * the whole image at full size, it's decoded from the file each time.
+     */
+    QImage image() const;
+    QSize imageSize() const;
 
     unsigned int
     layer() const
@@ -59,9 +61,17 @@ public:
         return mZLayer;
     }
 
+protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value);
+
+private slots:
+    void tilesLoaded();
+
 private:
+    void init();
+
     unsigned int mLayer;
-    QPixmap* mPixmap;
+    TiledImage* mImage;
     QString mFilename;
     QString mZLayer;
 };
@@ -4,6 +4,8 @@
 #include <QTransform>
 #include <QVector2D>
 
+#include "scene.h"
+
 #define ROTATION_MATRIX_INDEX 0
 #define SCALE_MATRIX_INDEX 1
 
@@ -35,6 +37,7 @@ void
 ChartItemTools::setRotation(QGraphicsItem* item, qreal rotation)
 {
     getGraphicsRotation(item)->setAngle(rotation);
+    transformationsChanged(item);
 }
 
 void
@@ -42,6 +45,7 @@ ChartItemTools::addRotation(QGraphicsItem* item, qreal rotation)
 {
     QGraphicsRotation* r = getGraphicsRotation(item);
     r->setAngle(r->angle() + rotation);
+    transformationsChanged(item);
 }
 
 QPointF
@@ -85,6 +89,7 @@ void
 ChartItemTools::setScaleX(QGraphicsItem* item, qreal scaleX)
 {
     getGraphicsScale(item)->setXScale(scaleX);
+    transformationsChanged(item);
 }
 
 void
@@ -92,6 +97,7 @@ ChartItemTools::addScaleX(QGraphicsItem* item, qreal scaleX)
 {
     QGraphicsScale* s = getGraphicsScale(item);
     s->setXScale(s->xScale() + scaleX);
+    transformationsChanged(item);
 }
 
 qreal
@@ -104,6 +110,7 @@ void
 ChartItemTools::setScaleY(QGraphicsItem* item, qreal scaleY)
 {
     getGraphicsScale(item)->setYScale(scaleY);
+    transformationsChanged(item);
 }
 
 void
@@ -111,6 +118,7 @@ ChartItemTools::addScaleY(QGraphicsItem* item, qreal scaleY)
 {
     QGraphicsScale* s = getGraphicsScale(item);
     s->setYScale(s->yScale() + scaleY);
+    transformationsChanged(item);
 }
 
 QPointF
@@ -186,6 +194,13 @@ ChartItemTools::mapToRotationAndScale(QGraphicsItem* item, QPointF point)
     return mat.map(point);
 }
 
+void
+ChartItemTools::transformationsChanged(QGraphicsItem* item)
+{
+    // the transformations don't go through itemChange.
+    Scene::trackSelection(item, QGraphicsItem::ItemTransformHasChanged, QVariant());
+}
+
 void
 ChartItemTools::initIfNotAlreadyInitialised(QGraphicsItem* item)
 {
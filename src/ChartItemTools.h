@@ -64,6 +64,10 @@ public:
     static QList<QGraphicsTransform*> cloneGraphicsTransformations(QGraphicsItem* item);
 
     static void initIfNotAlreadyInitialised(QGraphicsItem* item);
+    /**
+     * tell the scene of item that its rotation or scale changed.
+     */
+    static void transformationsChanged(QGraphicsItem* item);
 
 protected:
     static QGraphicsRotation* getGraphicsRotation(QGraphicsItem* item);
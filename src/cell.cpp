@@ -27,6 +27,7 @@
 #include "stitchset.h"
 #include "settings.h"
 #include "ChartItemTools.h"
+#include "scene.h"
 #include <QStyleOption>
 #include <QEvent>
 
@@ -42,6 +43,8 @@ Cell::Cell(QGraphicsItem* parent)
     setAcceptHoverEvents(true);
     setFlag(QGraphicsItem::ItemIsMovable);
     setFlag(QGraphicsItem::ItemIsSelectable);
+    // moves reach itemChange, which keeps the scene's selection properties up to date.
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges);
 
     // if we don't set the bgColor it'll end up black.
     setBgColor();
@@ -49,6 +52,17 @@ Cell::Cell(QGraphicsItem* parent)
 
 Cell::~Cell()
 {
+    // deleting the item takes it out of its scene.
+    Scene::trackSelection(this, ItemSceneChange, QVariant());
+    Scene::trackCell(this, ItemSceneChange, QVariant());
+}
+
+QVariant
+Cell::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    Scene::trackSelection(this, change, value);
+    Scene::trackCell(this, change, value);
+    return QGraphicsSvgItem::itemChange(change, value);
 }
 
 QRectF
@@ -103,15 +117,18 @@ Cell::event(QEvent* e)
 {
     // Pass the mouse control back to the scene,
     // allowing for changing stitches by click.
-    int selectedItems = 1;
-
-    if (scene())
-    {
-        selectedItems = scene()->selectedItems().count();
-    }
-
-    if (isSelected() && selectedItems == 1
-        && Settings::inst()->value("replaceStitchWithPress").toBool() == true)
+    if (!isSelected())
+        return QGraphicsSvgItem::event(e);
+
+    // this runs for every event the cell gets, so don't build the list of selected items.
+    bool single = true;
+    Scene* s = qobject_cast<Scene*>(scene());
+    if (s)
+        single = s->isSingleSelection();
+    else if (scene())
+        single = scene()->selectedItems().count() == 1;
+
+    if (single && Settings::inst()->value("replaceStitchWithPress").toBool() == true)
     {
         e->setAccepted(false);
         return false;
@@ -169,7 +186,7 @@ Cell::setBgColor(QColor c)
         if (mBgColor.isValid())
             old = mBgColor.name();
         mBgColor = c;
-        emit colorChanged(old, c.name());
+        emit bgColorChanged(old, c.name());
         update();
     }
 }
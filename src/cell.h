@@ -106,6 +106,9 @@ signals:
     void colorChanged(QString oldColor, QString newColor);
     void bgColorChanged(QString oldColor, QString newColor);
 
+protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value);
+
 private:
     // the layer of the cell
     unsigned int mLayer;
@@ -0,0 +1,515 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "chartexportjob.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "chartsnapshot.h"
+#include "charttiler.h"
+#include "debug.h"
+
+struct ChartExportJob::State
+{
+    struct Page
+    {
+        QSharedPointer<ChartSnapshot> chart;
+        QString header;
+        QString footer;
+        // set for the pages of a tiled chart instead of chart.
+        QSharedPointer<ChartTiler> tiler;
+        int tile;
+    };
+
+    QList<Page> pages;
+
+    QMutex mutex;
+    QWaitCondition changed;
+    QAtomicInt canceled;
+
+    // tasks that haven't finished their work.
+    int remaining;
+    // tasks that may still post to the job.
+    int active;
+
+    int done;
+    int total;
+    bool ok;
+    bool finishedEmitted;
+
+    QVector<QPicture> pictures;
+    // a page is claimed by whoever renders it, its own task or the pdf writer.
+    QVector<bool> claimed;
+    QVector<bool> rendered;
+    QVector<QImage> bands;
+    int bandsDone;
+
+    /**
+     * forget tasks that were counted by start() but will never be queued.
+     */
+    void
+    dropTasks(int tasks)
+    {
+        QMutexLocker locker(&mutex);
+        remaining -= tasks;
+        active -= tasks;
+        total -= tasks;
+    }
+};
+
+/**
+ * runs one piece of a job on the thread pool and reports back to the job when it's done.
+ */
+class ChartExportTask : public QRunnable
+{
+public:
+    ChartExportTask(QSharedPointer<ChartExportJob::State> state,
+                    ChartExportJob* job,
+                    std::function<bool()> work)
+        : mState(state)
+        , mJob(job)
+        , mWork(work)
+    {
+    }
+
+    void
+    run()
+    {
+        bool ok = false;
+        if (!mState->canceled.load())
+            ok = mWork();
+
+        {
+            QMutexLocker locker(&mState->mutex);
+            mState->remaining--;
+            mState->done++;
+            if (!ok)
+                mState->ok = false;
+        }
+
+        // the job waits for active tasks before it's deleted, so it's still there to post to.
+        QMetaObject::invokeMethod(mJob, "taskFinished", Qt::QueuedConnection);
+
+        QMutexLocker locker(&mState->mutex);
+        mState->active--;
+        mState->changed.wakeAll();
+    }
+
+private:
+    QSharedPointer<ChartExportJob::State> mState;
+    ChartExportJob* mJob;
+    std::function<bool()> mWork;
+};
+
+ChartExportJob::ChartExportJob(QObject* parent)
+    : QObject(parent)
+    , mState(new State)
+{
+    mState->canceled.store(0);
+    mState->remaining = 0;
+    mState->active = 0;
+    mState->done = 0;
+    mState->total = 0;
+    mState->ok = true;
+    mState->finishedEmitted = false;
+    mState->bandsDone = 0;
+}
+
+ChartExportJob::~ChartExportJob()
+{
+    cancel();
+
+    QMutexLocker locker(&mState->mutex);
+    while (mState->active > 0)
+        mState->changed.wait(&mState->mutex);
+}
+
+void
+ChartExportJob::addPage(QSharedPointer<ChartSnapshot> chart,
+                        const QString& header,
+                        const QString& footer)
+{
+    State::Page page;
+    page.chart = chart;
+    page.header = header;
+    page.footer = footer;
+    page.tile = 0;
+    mState->pages.append(page);
+}
+
+void
+ChartExportJob::addTiledPages(const ChartTiler& tiler)
+{
+    State::Page page;
+    page.tiler = QSharedPointer<ChartTiler>(new ChartTiler(tiler));
+    for (int i = 0; i < tiler.pageCount(); ++i)
+    {
+        page.tile = i;
+        mState->pages.append(page);
+    }
+}
+
+int
+ChartExportJob::pageCount() const
+{
+    return mState->pages.count();
+}
+
+void
+ChartExportJob::start(int tasks)
+{
+    mState->remaining = tasks;
+    mState->active = tasks;
+    mState->done = 0;
+    mState->total = tasks;
+    mState->ok = true;
+    mState->finishedEmitted = false;
+
+    // with nothing to run finish from the event loop anyway, the caller is waiting for it.
+    if (tasks == 0)
+        QMetaObject::invokeMethod(this, "taskFinished", Qt::QueuedConnection);
+}
+
+QPicture
+ChartExportJob::renderPage(const State& state, int page, const QRect& pageRect)
+{
+    const State::Page& p = state.pages.at(page);
+
+    QPicture picture;
+    picture.setBoundingRect(pageRect);
+    QPainter painter(&picture);
+    if (p.tiler)
+        p.tiler->paintPage(&painter, p.tile);
+    else
+        paintPage(&painter, pageRect, *p.chart, p.header, p.footer);
+    painter.end();
+
+    return picture;
+}
+
+void
+ChartExportJob::renderPictures(const QRect& pageRect)
+{
+    start(mState->pages.count());
+    preparePages();
+
+    for (int i = 0; i < mState->pages.count(); ++i)
+        queuePage(i, pageRect);
+}
+
+void
+ChartExportJob::preparePages()
+{
+    int count = mState->pages.count();
+
+    mState->pictures = QVector<QPicture>(count);
+    mState->claimed = QVector<bool>(count, false);
+    mState->rendered = QVector<bool>(count, false);
+}
+
+void
+ChartExportJob::queuePage(int page, const QRect& pageRect)
+{
+    QSharedPointer<State> state = mState;
+
+    QThreadPool::globalInstance()->start(new ChartExportTask(state, this, [state, page, pageRect]() {
+        {
+            QMutexLocker locker(&state->mutex);
+            if (state->claimed[page])
+                return true;
+            state->claimed[page] = true;
+        }
+
+        QPicture picture = renderPage(*state, page, pageRect);
+
+        QMutexLocker locker(&state->mutex);
+        state->pictures[page] = picture;
+        state->rendered[page] = true;
+        state->changed.wakeAll();
+        return true;
+    }));
+}
+
+void
+ChartExportJob::writePdf(const QString& fileName, const QPageLayout& layout, int resolution)
+{
+    QSharedPointer<State> state = mState;
+    int count = state->pages.count();
+
+    QString title = QFileInfo(fileName).baseName();
+    QString creator = QCoreApplication::applicationName();
+
+    // the painter's origin is the top left of the area inside the margins.
+    QRect pageRect(QPoint(0, 0), layout.paintRectPixels(resolution).size());
+
+    // a page is only queued once the writer has made room for it, so the pictures waiting to
+    // be written stay a few pages long however long the pdf is.
+    int ahead = qMax(2, QThreadPool::globalInstance()->maxThreadCount());
+
+    start(count + 1);
+    preparePages();
+    for (int i = 0; i < qMin(count, ahead); ++i)
+        queuePage(i, pageRect);
+
+    QThreadPool::globalInstance()->start(new ChartExportTask(state, this, [=]() {
+        int queued = qMin(count, ahead);
+        {
+            QPdfWriter writer(fileName);
+            writer.setPageLayout(layout);
+            writer.setResolution(resolution);
+            writer.setTitle(title);
+            writer.setCreator(creator);
+
+            QPainter p;
+            if (!p.begin(&writer))
+            {
+                qWarning() << "Could not write the pdf" << fileName;
+                state->dropTasks(count - queued);
+                return false;
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                QPicture picture;
+                bool claimed = false;
+                {
+                    QMutexLocker locker(&state->mutex);
+                    // a page no thread has picked up yet is quicker to render here than to wait for.
+                    if (!state->claimed[i])
+                    {
+                        state->claimed[i] = true;
+                        claimed = true;
+                    }
+
+                    while (!claimed && !state->rendered[i] && !state->canceled.load())
+                        state->changed.wait(&state->mutex);
+
+                    if (state->canceled.load())
+                        break;
+
+                    // written pages don't need to be kept around.
+                    picture = state->pictures[i];
+                    state->pictures[i] = QPicture();
+                }
+
+                if (claimed)
+                    picture = renderPage(*state, i, pageRect);
+
+                if (queued < count)
+                    queuePage(queued++, pageRect);
+
+                if (i > 0)
+                    writer.newPage();
+                p.drawPicture(0, 0, picture);
+            }
+
+            p.end();
+        }
+
+        state->dropTasks(count - queued);
+
+        // don't leave half a pdf behind, the writer has closed it.
+        if (state->canceled.load())
+        {
+            QFile::remove(fileName);
+            return false;
+        }
+        return true;
+    }));
+}
+
+void
+ChartExportJob::writeImage(const QString& fileName, const QSize& size, int resolution)
+{
+    QSharedPointer<State> state = mState;
+    if (state->pages.isEmpty())
+    {
+        start(0);
+        return;
+    }
+    Q_ASSERT(!state->pages.first().tiler);
+
+    int bandCount = qBound(1, QThread::idealThreadCount() * 2, qMax(1, size.height() / 64));
+    int bandHeight = (size.height() + bandCount - 1) / bandCount;
+    bandCount = (size.height() + bandHeight - 1) / bandHeight;
+    int dpm = qRound(resolution * 39.3700787);
+
+    state->bands = QVector<QImage>(bandCount);
+    state->bandsDone = 0;
+    start(bandCount);
+
+    for (int b = 0; b < bandCount; ++b)
+    {
+        QThreadPool::globalInstance()->start(new ChartExportTask(state, this, [=]() {
+            const State::Page& page = state->pages.first();
+            QRect rect(0, 0, size.width(), size.height());
+
+            int top = b * bandHeight;
+            QImage band(size.width(), qMin(bandHeight, size.height() - top),
+                        QImage::Format_ARGB32);
+            band.setDotsPerMeterX(dpm);
+            band.setDotsPerMeterY(dpm);
+            band.fill(Qt::white);
+
+            QPainter p(&band);
+            p.translate(0, -top);
+            paintPage(&p, rect, *page.chart, page.header, page.footer);
+            p.end();
+
+            bool last = false;
+            {
+                QMutexLocker locker(&state->mutex);
+                state->bands[b] = band;
+                state->bandsDone++;
+                last = (state->bandsDone == state->bands.count());
+            }
+
+            if (!last)
+                return true;
+
+            // the last band to finish puts the image together.
+            QImage img(size, QImage::Format_ARGB32);
+            img.setDotsPerMeterX(dpm);
+            img.setDotsPerMeterY(dpm);
+
+            QPainter imgPainter(&img);
+            for (int i = 0; i < state->bands.count(); ++i)
+            {
+                imgPainter.drawImage(0, i * bandHeight, state->bands.at(i));
+            }
+            imgPainter.end();
+            state->bands.clear();
+
+            if (state->canceled.load())
+                return false;
+
+            return img.save(fileName);
+        }));
+    }
+}
+
+QPicture
+ChartExportJob::picture(int page) const
+{
+    QMutexLocker locker(&mState->mutex);
+    return mState->pictures.value(page);
+}
+
+bool
+ChartExportJob::isRunning() const
+{
+    QMutexLocker locker(&mState->mutex);
+    return mState->remaining > 0;
+}
+
+bool
+ChartExportJob::isCanceled() const
+{
+    return mState->canceled.load();
+}
+
+void
+ChartExportJob::cancel()
+{
+    QMutexLocker locker(&mState->mutex);
+    mState->canceled.store(1);
+    mState->changed.wakeAll();
+}
+
+void
+ChartExportJob::taskFinished()
+{
+    int done, total;
+    bool isFinished = false;
+    bool ok = false;
+    {
+        QMutexLocker locker(&mState->mutex);
+        done = mState->done;
+        total = mState->total;
+
+        if (mState->remaining == 0 && !mState->finishedEmitted)
+        {
+            mState->finishedEmitted = true;
+            isFinished = true;
+            ok = mState->ok && !mState->canceled.load();
+        }
+    }
+
+    emit progress(done, total);
+    if (isFinished)
+        emit finished(ok);
+}
+
+int
+ChartExportJob::paintHeader(QPainter* painter, const QRect& page, const QString& text)
+{
+    painter->save();
+    painter->setFont(QFont("Courier New", 12));
+    QRect boundingRect
+        = painter->boundingRect(page, Qt::AlignJustify | Qt::TextWordWrap, text);
+    painter->drawText(boundingRect, Qt::AlignJustify | Qt::TextWordWrap, text);
+    painter->restore();
+    return boundingRect.height();
+}
+
+int
+ChartExportJob::paintFooter(QPainter* painter, const QRect& page, const QString& text)
+{
+    painter->save();
+    painter->setFont(QFont("Courier New", 12));
+    QRect boundingRect
+        = painter->boundingRect(page, Qt::AlignJustify | Qt::TextWordWrap, text);
+    boundingRect.moveBottom(page.bottom());
+    painter->drawText(boundingRect, Qt::AlignJustify | Qt::TextWordWrap, text);
+    painter->restore();
+    return boundingRect.height();
+}
+
+void
+ChartExportJob::paintPage(QPainter* painter,
+                          const QRect& page,
+                          const ChartSnapshot& chart,
+                          const QString& header,
+                          const QString& footer)
+{
+    int headerSize = 0;
+    int footerSize = 0;
+
+    if (!header.isEmpty())
+        headerSize = paintHeader(painter, page, header);
+    if (!footer.isEmpty())
+        footerSize = paintFooter(painter, page, footer);
+
+    chart.paint(painter, QRectF(page.x(), page.y() + headerSize, page.width(),
+                                page.height() - headerSize - footerSize));
+}
@@ -0,0 +1,125 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef CHARTEXPORTJOB_H
+#define CHARTEXPORTJOB_H
+
+#include <QObject>
+#include <QPageLayout>
+#include <QPicture>
+#include <QSharedPointer>
+#include <QStringList>
+
+class ChartSnapshot;
+class ChartTiler;
+class QPainter;
+
+/**
+ * Renders chart pages on the global thread pool.
+ *
+ * Pages are painted from ChartSnapshots so the gui thread can keep going while a job runs.
+ * A pdf is written page by page, in order, as soon as each page is rendered, and only a few
+ * pages past the last one written are rendered ahead of it. An image is split into bands that
+ * are rendered in parallel and put back together before it's saved.
+ */
+class ChartExportJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChartExportJob(QObject* parent = nullptr);
+    /**
+     * cancels the job and waits for the running pages to stop.
+     */
+    ~ChartExportJob();
+
+    void addPage(QSharedPointer<ChartSnapshot> chart,
+                 const QString& header = QString(),
+                 const QString& footer = QString());
+
+    /**
+     * add every page of tiler, painted at the tiler's scale instead of fitted to the page.
+     * Tiled pages can be rendered to pictures or a pdf but not to an image.
+     */
+    void addTiledPages(const ChartTiler& tiler);
+
+    int pageCount() const;
+
+    /**
+     * render every page into a picture of pageRect, available from picture() once finished.
+     * All the pictures are kept until the job is deleted.
+     */
+    void renderPictures(const QRect& pageRect);
+
+    /**
+     * write all the pages to a pdf file.
+     */
+    void writePdf(const QString& fileName, const QPageLayout& layout, int resolution);
+
+    /**
+     * render the first page into an image of size and save it to fileName.
+     */
+    void writeImage(const QString& fileName, const QSize& size, int resolution);
+
+    QPicture picture(int page) const;
+
+    bool isRunning() const;
+    bool isCanceled() const;
+
+    /**
+     * paint a header or footer across the top or bottom of page and return its height.
+     */
+    static int paintHeader(QPainter* painter, const QRect& page, const QString& text);
+    static int paintFooter(QPainter* painter, const QRect& page, const QString& text);
+
+    /**
+     * paint the header, footer and chart of a page.
+     */
+    static void paintPage(QPainter* painter,
+                          const QRect& page,
+                          const ChartSnapshot& chart,
+                          const QString& header,
+                          const QString& footer);
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(int value, int maximum);
+    void finished(bool ok);
+
+private slots:
+    void taskFinished();
+
+private:
+    struct State;
+    friend class ChartExportTask;
+
+    /**
+     * reset the progress for a run of tasks, before any of them is queued.
+     */
+    void start(int tasks);
+    void preparePages();
+    void queuePage(int page, const QRect& pageRect);
+    static QPicture renderPage(const State& state, int page, const QRect& pageRect);
+
+    QSharedPointer<State> mState;
+};
+
+#endif  // CHARTEXPORTJOB_H
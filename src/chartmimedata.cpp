@@ -0,0 +1,390 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "chartmimedata.h"
+
+#include <QDataStream>
+
+#include "ChartImage.h"
+#include "ChartItemTools.h"
+#include "cell.h"
+#include "debug.h"
+#include "indicator.h"
+#include "itemgroup.h"
+
+const char* ChartMimeData::format = "application/crochet-cells";
+
+// the start of the clipboard data, the old format started with the number of items.
+static const quint32 gMagic = 0x43434c50;
+static const quint32 gVersion = 1;
+
+ChartMimeData::ChartMimeData()
+    : QMimeData()
+    , mTopLevelCount(0)
+{
+}
+
+void
+ChartMimeData::addItems(const QList<QGraphicsItem*>& items)
+{
+    mEncoded.clear();
+
+    foreach (QGraphicsItem* item, items)
+    {
+        switch (item->type())
+        {
+        case Cell::Type:
+        case Indicator::Type:
+        case ItemGroup::Type:
+        case ChartImage::Type:
+            addItem(item);
+            mTopLevelCount++;
+            break;
+        default:
+            WARN("Unknown data type: " + QString::number(item->type()));
+            break;
+        }
+    }
+}
+
+void
+ChartMimeData::addItem(QGraphicsItem* item)
+{
+    Record record;
+    record.flags = 0;
+    record.key = 0;
+    record.color = 0;
+    record.bgColor = 0;
+
+    switch (item->type())
+    {
+    case Cell::Type:
+    {
+        Cell* c = qgraphicsitem_cast<Cell*>(item);
+        record.type = CellItem;
+        record.key = stringKey(c->name());
+        record.color = colorIndex(c->color());
+        record.bgColor = colorIndex(c->bgColor());
+        record.pos = c->pos();
+        addTransform(c, &record, true);
+        mRecords.append(record);
+        break;
+    }
+    case Indicator::Type:
+    {
+        Indicator* i = qgraphicsitem_cast<Indicator*>(item);
+        record.type = IndicatorItem;
+        record.key = stringKey(i->text());
+        record.pos = i->scenePos();
+        addTransform(i, &record);
+        mRecords.append(record);
+        break;
+    }
+    case ChartImage::Type:
+    {
+        ChartImage* image = qgraphicsitem_cast<ChartImage*>(item);
+        record.type = ImageItem;
+        record.key = stringKey(image->filename());
+        record.pos = image->pos();
+        addTransform(image, &record);
+        mRecords.append(record);
+        break;
+    }
+    case ItemGroup::Type:
+    {
+        ItemGroup* group = qgraphicsitem_cast<ItemGroup*>(item);
+        ChartItemTools::recalculateTransformations(group);
+
+        QList<QGraphicsItem*> childs = group->childItems();
+        record.type = GroupItem;
+        record.key = 0;
+        record.pos = group->pos();
+        addTransform(group, &record);
+
+        int index = mRecords.count();
+        mRecords.append(record);
+
+        // the children are stored in scene coordinates.
+        foreach (QGraphicsItem* child, childs)
+        {
+            group->removeFromGroup(child);
+            ChartItemTools::recalculateTransformations(child);
+        }
+
+        foreach (QGraphicsItem* child, childs)
+        {
+            if (child->type() != Cell::Type && child->type() != Indicator::Type
+                && child->type() != ItemGroup::Type && child->type() != ChartImage::Type)
+                continue;
+            addItem(child);
+            mRecords[index].key++;
+        }
+
+        foreach (QGraphicsItem* child, childs)
+        {
+            group->addToGroup(child);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void
+ChartMimeData::addTransform(QGraphicsItem* item, Record* record, bool origin)
+{
+    qreal rotation = ChartItemTools::getRotation(item);
+    QPointF rotationPivot = ChartItemTools::getRotationPivot(item);
+    if (rotation != 0 || !rotationPivot.isNull())
+    {
+        record->flags |= Rotated;
+        mTransforms << rotation << rotationPivot.x() << rotationPivot.y();
+    }
+
+    qreal scaleX = ChartItemTools::getScaleX(item);
+    qreal scaleY = ChartItemTools::getScaleY(item);
+    QPointF scalePivot = ChartItemTools::getScalePivot(item);
+    if (scaleX != 1 || scaleY != 1 || !scalePivot.isNull())
+    {
+        record->flags |= Scaled;
+        mTransforms << scaleX << scaleY << scalePivot.x() << scalePivot.y();
+    }
+
+    // only cells keep their transform origin.
+    QPointF point = item->transformOriginPoint();
+    if (origin && !point.isNull())
+    {
+        record->flags |= Origin;
+        mTransforms << point.x() << point.y();
+    }
+}
+
+quint32
+ChartMimeData::stringKey(const QString& s)
+{
+    QHash<QString, quint32>::const_iterator it = mStringKeys.constFind(s);
+    if (it != mStringKeys.constEnd())
+        return it.value();
+
+    quint32 key = mStrings.count();
+    mStrings.append(s);
+    mStringKeys.insert(s, key);
+    return key;
+}
+
+quint32
+ChartMimeData::colorIndex(const QColor& c)
+{
+    qint64 rgba = c.isValid() ? qint64(c.rgba()) : -1;
+    QHash<qint64, quint32>::const_iterator it = mColorIndexes.constFind(rgba);
+    if (it != mColorIndexes.constEnd())
+        return it.value();
+
+    quint32 index = mColors.count();
+    mColors.append(c);
+    mColorIndexes.insert(rgba, index);
+    return index;
+}
+
+ChartMimeData::Transform
+ChartMimeData::transform(const Record& record, int* cursor) const
+{
+    Transform t;
+    t.rotation = 0;
+    t.scaleX = 1;
+    t.scaleY = 1;
+
+    const qreal* v = mTransforms.constData() + *cursor;
+    if (record.flags & Rotated)
+    {
+        t.rotation = v[0];
+        t.rotationPivot = QPointF(v[1], v[2]);
+        v += 3;
+    }
+    if (record.flags & Scaled)
+    {
+        t.scaleX = v[0];
+        t.scaleY = v[1];
+        t.scalePivot = QPointF(v[2], v[3]);
+        v += 4;
+    }
+    if (record.flags & Origin)
+    {
+        t.origin = QPointF(v[0], v[1]);
+        v += 2;
+    }
+
+    *cursor = v - mTransforms.constData();
+    return t;
+}
+
+/**
+ * the number of transform values stored for flags.
+ */
+static int
+transformSize(quint8 flags)
+{
+    return (flags & ChartMimeData::Rotated ? 3 : 0) + (flags & ChartMimeData::Scaled ? 4 : 0)
+           + (flags & ChartMimeData::Origin ? 2 : 0);
+}
+
+QByteArray
+ChartMimeData::encode() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << gMagic << gVersion;
+    stream << mStrings;
+
+    stream << quint32(mColors.count());
+    foreach (const QColor& c, mColors)
+        stream << c;
+
+    stream << qint32(mTopLevelCount) << quint32(mRecords.count());
+    foreach (const Record& r, mRecords)
+    {
+        stream << r.type << r.flags << r.key << r.color << r.bgColor << r.pos.x() << r.pos.y();
+    }
+
+    stream << quint32(mTransforms.count());
+    foreach (qreal v, mTransforms)
+        stream << double(v);
+
+    return data;
+}
+
+bool
+ChartMimeData::isEncoded(const QByteArray& data)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    stream >> magic;
+    return magic == gMagic;
+}
+
+bool
+ChartMimeData::decode(const QByteArray& data)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (magic != gMagic || version > gVersion)
+        return false;
+
+    QStringList strings;
+    stream >> strings;
+
+    quint32 colorCount = 0;
+    stream >> colorCount;
+    QVector<QColor> colors;
+    for (quint32 i = 0; i < colorCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        QColor c;
+        stream >> c;
+        colors.append(c);
+    }
+
+    qint32 topLevelCount = 0;
+    quint32 recordCount = 0;
+    stream >> topLevelCount >> recordCount;
+
+    QVector<Record> records;
+    int transformCount = 0;
+    for (quint32 i = 0; i < recordCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        Record r;
+        double x, y;
+        stream >> r.type >> r.flags >> r.key >> r.color >> r.bgColor >> x >> y;
+        r.pos = QPointF(x, y);
+
+        if (r.color >= quint32(colors.count()) || r.bgColor >= quint32(colors.count()))
+            r.color = r.bgColor = 0;
+        if (r.type != GroupItem && r.key >= quint32(strings.count()))
+            return false;
+
+        transformCount += transformSize(r.flags);
+        records.append(r);
+    }
+
+    quint32 valueCount = 0;
+    stream >> valueCount;
+    if (int(valueCount) != transformCount)
+        return false;
+
+    QVector<qreal> transforms;
+    transforms.reserve(transformCount);
+    for (quint32 i = 0; i < valueCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        double v;
+        stream >> v;
+        transforms.append(v);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    mStrings = strings;
+    mStringKeys.clear();
+    for (int i = 0; i < mStrings.count(); ++i)
+        mStringKeys.insert(mStrings.at(i), i);
+
+    mColors = colors;
+    mColorIndexes.clear();
+    for (int i = 0; i < mColors.count(); ++i)
+        mColorIndexes.insert(mColors.at(i).isValid() ? qint64(mColors.at(i).rgba()) : -1, i);
+
+    mTopLevelCount = topLevelCount;
+    mRecords = records;
+    mTransforms = transforms;
+    mEncoded = data;
+    return true;
+}
+
+QStringList
+ChartMimeData::formats() const
+{
+    return QStringList() << format;
+}
+
+bool
+ChartMimeData::hasFormat(const QString& mimeType) const
+{
+    return mimeType == format;
+}
+
+QVariant
+ChartMimeData::retrieveData(const QString& mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+
+    if (mimeType != format)
+        return QVariant();
+
+    if (mEncoded.isEmpty())
+        mEncoded = encode();
+    return mEncoded;
+}
@@ -0,0 +1,157 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef CHARTMIMEDATA_H
+#define CHARTMIMEDATA_H
+
+#include <QColor>
+#include <QHash>
+#include <QMimeData>
+#include <QPointF>
+#include <QStringList>
+#include <QVector>
+
+class QGraphicsItem;
+
+/**
+ * The items copied from a chart, kept in a compact form until something asks for them.
+ *
+ * Stitch names, indicator text, image file names and colours are stored once in a dictionary
+ * and every item is a fixed size record that refers to them. Only the transforms that aren't
+ * the default are stored. The clipboard bytes are only put together when another application
+ * asks for them, pasting in the same application reads the records directly.
+ */
+class ChartMimeData : public QMimeData
+{
+    Q_OBJECT
+public:
+    enum Flag
+    {
+        Rotated = 0x01,
+        Scaled = 0x02,
+        Origin = 0x04
+    };
+
+    enum ItemType
+    {
+        CellItem = 1,
+        IndicatorItem = 2,
+        GroupItem = 3,
+        ImageItem = 4
+    };
+
+    struct Record
+    {
+        quint8 type;
+        quint8 flags;
+        // the stitch, text or file name, or for a group the number of items directly in it.
+        quint32 key;
+        quint32 color;
+        quint32 bgColor;
+        QPointF pos;
+    };
+
+    struct Transform
+    {
+        qreal rotation;
+        QPointF rotationPivot;
+        qreal scaleX;
+        qreal scaleY;
+        QPointF scalePivot;
+        QPointF origin;
+    };
+
+    static const char* format;
+
+    ChartMimeData();
+
+    /**
+     * add items and their children in the state they're in now.
+     */
+    void addItems(const QList<QGraphicsItem*>& items);
+
+    /**
+     * the items in the order they were added, the items in a group follow the group.
+     */
+    const QVector<Record>&
+    records() const
+    {
+        return mRecords;
+    }
+    int
+    topLevelCount() const
+    {
+        return mTopLevelCount;
+    }
+
+    QString
+    string(quint32 key) const
+    {
+        return mStrings.value(key);
+    }
+    QColor
+    color(quint32 index) const
+    {
+        return mColors.value(index);
+    }
+
+    /**
+     * the transform of a record, cursor is moved past it. Transforms are read in the same
+     * order as the records.
+     */
+    Transform transform(const Record& record, int* cursor) const;
+
+    QByteArray encode() const;
+
+    /**
+     * read data written by encode, returns false if it isn't in this format.
+     */
+    bool decode(const QByteArray& data);
+    /**
+     * true if data starts the way data written by encode does, even if decode can't read it.
+     */
+    static bool isEncoded(const QByteArray& data);
+
+    QStringList formats() const;
+    bool hasFormat(const QString& mimeType) const;
+
+protected:
+    QVariant retrieveData(const QString& mimeType, QVariant::Type type) const;
+
+private:
+    void addItem(QGraphicsItem* item);
+    void addTransform(QGraphicsItem* item, Record* record, bool origin = false);
+    quint32 stringKey(const QString& s);
+    quint32 colorIndex(const QColor& c);
+
+    QStringList mStrings;
+    QHash<QString, quint32> mStringKeys;
+    QVector<QColor> mColors;
+    // invalid colours are -1.
+    QHash<qint64, quint32> mColorIndexes;
+
+    QVector<Record> mRecords;
+    QVector<qreal> mTransforms;
+    int mTopLevelCount;
+
+    mutable QByteArray mEncoded;
+};
+
+#endif  // CHARTMIMEDATA_H
@@ -0,0 +1,219 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "chartsnapshot.h"
+
+#include <QHash>
+#include <QPainter>
+#include <QPicture>
+#include <QStyleOptionGraphicsItem>
+#include <QThreadStorage>
+#include <QtSvg/QSvgRenderer>
+
+#include "cell.h"
+#include "itemgroup.h"
+#include "scene.h"
+
+/**
+ * svg renderers for the snapshots painted in one thread, keyed by their svg data.
+ */
+class SnapshotRendererCache
+{
+public:
+    ~SnapshotRendererCache()
+    {
+        qDeleteAll(mRenderers);
+    }
+
+    QSvgRenderer*
+    renderer(const QByteArray& svg)
+    {
+        QSvgRenderer* r = mRenderers.value(svg);
+        if (!r)
+        {
+            r = new QSvgRenderer(svg);
+            mRenderers.insert(svg, r);
+        }
+        return r;
+    }
+
+    /**
+     * drop the renderers once the cache gets large. Only call this between paints, renderers
+     * handed out before are deleted.
+     */
+    void
+    trim()
+    {
+        if (mRenderers.count() < 256)
+            return;
+
+        qDeleteAll(mRenderers);
+        mRenderers.clear();
+    }
+
+private:
+    QHash<QByteArray, QSvgRenderer*> mRenderers;
+};
+
+static QThreadStorage<SnapshotRendererCache*> sRendererCache;
+
+ChartSnapshot::ChartSnapshot(const QList<QGraphicsItem*>& items, const QRectF& source)
+    : mSource(source)
+{
+    QList<QGraphicsItem*> sorted;
+    foreach (QGraphicsItem* item, items)
+    {
+        // groups don't draw anything themselves.
+        if (item->type() == ItemGroup::Type || !item->isVisible())
+            continue;
+        if (item->sceneBoundingRect().intersects(source))
+            sorted.append(item);
+    }
+    Scene::sortByStackingOrder(sorted);
+
+    // stitch, color and background -> index into mSymbols.
+    QHash<QString, int> symbols;
+    QStyleOptionGraphicsItem option;
+
+    foreach (QGraphicsItem* item, sorted)
+    {
+        Op op;
+        op.symbol = -1;
+        op.picture = -1;
+        op.transform = item->sceneTransform();
+        op.sceneRect = item->sceneBoundingRect();
+
+        if (item->type() == Cell::Type)
+        {
+            Cell* c = qgraphicsitem_cast<Cell*>(item);
+            Stitch* s = c->stitch();
+            if (!s)
+                continue;
+
+            QColor bg = c->bgColor();
+            if (bg == Qt::white)
+                bg = QColor();
+
+            QString key = QString::number((quintptr)s, 16) + c->color().name();
+            if (bg.isValid())
+                key += "/" + bg.name();
+
+            int index = symbols.value(key, -1);
+            if (index == -1)
+            {
+                Symbol symbol;
+                symbol.rect = c->boundingRect();
+                symbol.bgColor = bg;
+                if (s->isSvg())
+                    symbol.svg = s->svgData(c->color().name());
+                else
+                    symbol.image = s->renderPixmap()->toImage();
+
+                index = mSymbols.count();
+                mSymbols.append(symbol);
+                symbols.insert(key, index);
+            }
+            op.symbol = index;
+        }
+        else
+        {
+            QRectF rect = item->boundingRect();
+            option.state = item->isEnabled() ? QStyle::State_Enabled : QStyle::State_None;
+            option.rect = rect.toAlignedRect();
+            option.exposedRect = rect;
+
+            QPicture picture;
+            QPainter p(&picture);
+            p.setOpacity(item->effectiveOpacity());
+            item->paint(&p, &option, 0);
+            p.end();
+
+            op.picture = mPictures.count();
+            mPictures.append(QByteArray(picture.data(), picture.size()));
+        }
+
+        mOps.append(op);
+    }
+}
+
+void
+ChartSnapshot::paint(QPainter* painter, const QRectF& target) const
+{
+    paint(painter, target, mSource);
+}
+
+void
+ChartSnapshot::paint(QPainter* painter, const QRectF& target, const QRectF& source) const
+{
+    if (source.isEmpty() || target.isEmpty())
+        return;
+
+    if (!sRendererCache.hasLocalData())
+        sRendererCache.setLocalData(new SnapshotRendererCache());
+    SnapshotRendererCache* cache = sRendererCache.localData();
+    cache->trim();
+
+    painter->save();
+    painter->setClipRect(target, Qt::IntersectClip);
+    painter->setWorldTransform(Scene::renderTransform(source, target), true);
+    painter->fillRect(source, Qt::white);
+
+    QTransform base = painter->worldTransform();
+    QRectF visible = painter->clipBoundingRect().intersected(source);
+
+    QVector<QSvgRenderer*> renderers(mSymbols.count(), 0);
+
+    foreach (const Op& op, mOps)
+    {
+        if (!op.sceneRect.intersects(visible))
+            continue;
+
+        painter->setWorldTransform(op.transform * base);
+
+        if (op.symbol >= 0)
+        {
+            const Symbol& symbol = mSymbols.at(op.symbol);
+
+            if (symbol.bgColor.isValid())
+                painter->fillRect(symbol.rect, symbol.bgColor);
+
+            if (!symbol.svg.isEmpty())
+            {
+                if (!renderers[op.symbol])
+                    renderers[op.symbol] = cache->renderer(symbol.svg);
+                renderers[op.symbol]->render(painter, symbol.rect);
+            }
+            else
+            {
+                painter->drawImage(symbol.rect.topLeft(), symbol.image);
+            }
+        }
+        else
+        {
+            // each paint gets its own picture, playing one back isn't thread safe.
+            const QByteArray& data = mPictures.at(op.picture);
+            QPicture picture;
+            picture.setData(data.constData(), data.size());
+            painter->drawPicture(0, 0, picture);
+        }
+    }
+
+    painter->restore();
+}
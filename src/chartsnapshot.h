@@ -0,0 +1,92 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef CHARTSNAPSHOT_H
+#define CHARTSNAPSHOT_H
+
+#include <QByteArray>
+#include <QColor>
+#include <QImage>
+#include <QList>
+#include <QRectF>
+#include <QTransform>
+#include <QVector>
+
+class QGraphicsItem;
+class QPainter;
+
+/**
+ * A copy of what a chart draws that can be painted from any thread.
+ *
+ * QGraphicsItems and the stitch renderers belong to the gui thread, so the snapshot keeps the
+ * svg data of every stitch and color in use and builds its own renderers in the thread that
+ * paints it. Items other than cells are recorded into pictures when the snapshot is taken.
+ */
+class ChartSnapshot
+{
+public:
+    /**
+     * take a snapshot of the visible items inside source. Must be called on the gui thread.
+     */
+    ChartSnapshot(const QList<QGraphicsItem*>& items, const QRectF& source);
+
+    const QRectF&
+    sourceRect() const
+    {
+        return mSource;
+    }
+
+    /**
+     * paint the snapshot into target, keeping the aspect ratio like Scene::renderItems.
+     * Only the part of the chart inside the painter's clip is drawn. Thread safe.
+     */
+    void paint(QPainter* painter, const QRectF& target) const;
+
+    /**
+     * paint the area source of the chart into target. Thread safe.
+     */
+    void paint(QPainter* painter, const QRectF& target, const QRectF& source) const;
+
+private:
+    struct Symbol
+    {
+        QByteArray svg;
+        QImage image;
+        QRectF rect;
+        QColor bgColor;
+    };
+
+    struct Op
+    {
+        // index into mSymbols, or -1 if the op draws mPictures[picture].
+        int symbol;
+        int picture;
+        QTransform transform;
+        QRectF sceneRect;
+    };
+
+    QVector<Symbol> mSymbols;
+    QVector<QByteArray> mPictures;
+    QVector<Op> mOps;
+
+    QRectF mSource;
+};
+
+#endif  // CHARTSNAPSHOT_H
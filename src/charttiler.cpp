@@ -0,0 +1,160 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "charttiler.h"
+
+#include <QObject>
+#include <QPainter>
+#include <QtMath>
+
+#include "chartsnapshot.h"
+
+/**
+ * the number of tiles of size with overlap needed to cover length.
+ */
+static int
+tileCount(qreal length, qreal size, qreal overlap)
+{
+    if (length <= size)
+        return 1;
+
+    return 1 + qCeil((length - size) / (size - overlap));
+}
+
+ChartTiler::ChartTiler(QSharedPointer<ChartSnapshot> chart,
+                       const QString& title,
+                       const QRect& pageRect,
+                       int resolution,
+                       qreal scale,
+                       int overlap)
+    : mChart(chart)
+    , mTitle(title)
+    , mPageRect(pageRect)
+    , mLabelHeight(resolution / 4)
+    , mScale(qMax(scale, 0.0001))
+    , mRows(1)
+    , mColumns(1)
+{
+    QRect area = chartArea();
+    mTileSize = QSizeF(area.width() / mScale, area.height() / mScale);
+
+    // an overlap of half a tile or more would never get across the chart.
+    qreal o = overlap / mScale;
+    mOverlap = QSizeF(qMin(o, mTileSize.width() / 2), qMin(o, mTileSize.height() / 2));
+
+    if (mTileSize.isEmpty())
+        return;
+
+    QSizeF chartSize = mChart->sourceRect().size();
+    mColumns = tileCount(chartSize.width(), mTileSize.width(), mOverlap.width());
+    mRows = tileCount(chartSize.height(), mTileSize.height(), mOverlap.height());
+}
+
+qreal
+ChartTiler::scaleFor(int resolution, qreal stitchSize, int cellWidth)
+{
+    if (cellWidth <= 0)
+        return 1.0;
+
+    return (stitchSize / 25.4) * resolution / cellWidth;
+}
+
+QRect
+ChartTiler::chartArea() const
+{
+    return mPageRect.adjusted(0, mLabelHeight, 0, 0);
+}
+
+QRectF
+ChartTiler::tileSource(int page) const
+{
+    int row = page / mColumns;
+    int column = page % mColumns;
+
+    QPointF topLeft = mChart->sourceRect().topLeft();
+    topLeft += QPointF(column * (mTileSize.width() - mOverlap.width()),
+                       row * (mTileSize.height() - mOverlap.height()));
+
+    return QRectF(topLeft, mTileSize);
+}
+
+QString
+ChartTiler::label(int page) const
+{
+    return QObject::tr("%1 - page %2 of %3 (row %4 of %5, column %6 of %7)")
+        .arg(mTitle)
+        .arg(page + 1)
+        .arg(pageCount())
+        .arg(page / mColumns + 1)
+        .arg(mRows)
+        .arg(page % mColumns + 1)
+        .arg(mColumns);
+}
+
+void
+ChartTiler::paintPage(QPainter* painter, int page) const
+{
+    QRect area = chartArea();
+    mChart->paint(painter, area, tileSource(page));
+
+    painter->save();
+
+    QFont font("Courier New");
+    font.setPixelSize(qMax(1, mLabelHeight * 2 / 3));
+    painter->setFont(font);
+    painter->setPen(Qt::black);
+    painter->drawText(QRect(mPageRect.topLeft(), QSize(mPageRect.width(), mLabelHeight)),
+                      Qt::AlignLeft | Qt::AlignVCenter, label(page));
+
+    // mark where the neighbouring pages start.
+    QPen pen(Qt::gray, qMax(1, mLabelHeight / 32), Qt::DashLine);
+    painter->setPen(pen);
+
+    int row = page / mColumns;
+    int column = page % mColumns;
+    qreal dx = mOverlap.width() * mScale;
+    qreal dy = mOverlap.height() * mScale;
+
+    if (column > 0)
+        painter->drawLine(QLineF(area.left() + dx, area.top(), area.left() + dx, area.bottom()));
+    if (column < mColumns - 1)
+        painter->drawLine(
+            QLineF(area.right() - dx, area.top(), area.right() - dx, area.bottom()));
+    if (row > 0)
+        painter->drawLine(QLineF(area.left(), area.top() + dy, area.right(), area.top() + dy));
+    if (row < mRows - 1)
+        painter->drawLine(
+            QLineF(area.left(), area.bottom() - dy, area.right(), area.bottom() - dy));
+
+    painter->restore();
+}
+
+QPicture
+ChartTiler::picture(int page) const
+{
+    QPicture picture;
+    picture.setBoundingRect(mPageRect);
+
+    QPainter p(&picture);
+    paintPage(&p, page);
+    p.end();
+
+    return picture;
+}
@@ -0,0 +1,107 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef CHARTTILER_H
+#define CHARTTILER_H
+
+#include <QPicture>
+#include <QRect>
+#include <QSharedPointer>
+#include <QString>
+
+class ChartSnapshot;
+class QPainter;
+
+/**
+ * Splits a chart across several pages so it prints at a fixed size instead of being scaled down
+ * to fit one page.
+ *
+ * The pages are laid out in rows and columns that overlap a little so they can be lined up
+ * when they're put back together. Each page has a label with its position at the top and
+ * dashed lines where it overlaps the pages next to it.
+ */
+class ChartTiler
+{
+public:
+    /**
+     * pageRect is the printable area of a page in device pixels, scale the number of device
+     * pixels per unit of the scene and overlap the width of the overlap in device pixels.
+     */
+    ChartTiler(QSharedPointer<ChartSnapshot> chart,
+               const QString& title,
+               const QRect& pageRect,
+               int resolution,
+               qreal scale,
+               int overlap);
+
+    /**
+     * the number of device pixels per unit of the scene for a cell of cellWidth to print
+     * stitchSize millimeters wide.
+     */
+    static qreal scaleFor(int resolution, qreal stitchSize, int cellWidth);
+
+    int
+    rows() const
+    {
+        return mRows;
+    }
+    int
+    columns() const
+    {
+        return mColumns;
+    }
+    int
+    pageCount() const
+    {
+        return mRows * mColumns;
+    }
+
+    /**
+     * the area of the scene printed on page, pages go across each row first.
+     */
+    QRectF tileSource(int page) const;
+
+    QString label(int page) const;
+
+    void paintPage(QPainter* painter, int page) const;
+
+    /**
+     * record page into a picture that can be kept and played back later.
+     */
+    QPicture picture(int page) const;
+
+private:
+    QRect chartArea() const;
+
+    QSharedPointer<ChartSnapshot> mChart;
+    QString mTitle;
+    QRect mPageRect;
+    int mLabelHeight;
+
+    qreal mScale;
+    // the size of a tile and of the overlap in scene units.
+    QSizeF mTileSize;
+    QSizeF mOverlap;
+
+    int mRows;
+    int mColumns;
+};
+
+#endif  // CHARTTILER_H
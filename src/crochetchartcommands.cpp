@@ -339,6 +339,37 @@ SetItemCoordinates::setPosition(QGraphicsItem* item, QPointF position)
     item->setPos(position);
 }
 
+/*************************************************\
+| SetItemsCoordinates                             |
+\*************************************************/
+SetItemsCoordinates::SetItemsCoordinates(QList<QGraphicsItem*> itemList,
+                                         QVector<QPointF> newPositions,
+                                         QUndoCommand* parent)
+    : QUndoCommand(parent)
+    , items(itemList)
+    , newCoords(newPositions)
+{
+    oldCoords.reserve(items.count());
+    foreach (QGraphicsItem* i, items)
+        oldCoords.append(i->pos());
+
+    setText(QObject::tr("change item positions"));
+}
+
+void
+SetItemsCoordinates::undo()
+{
+    for (int i = 0; i < items.count(); ++i)
+        items.at(i)->setPos(oldCoords.at(i));
+}
+
+void
+SetItemsCoordinates::redo()
+{
+    for (int i = 0; i < items.count(); ++i)
+        items.at(i)->setPos(newCoords.at(i));
+}
+
 /*************************************************\
  | SetItemScale                                   |
 \*************************************************/
@@ -289,6 +289,36 @@ private:
     QGraphicsItem* i = nullptr;
 };
 
+/**
+ * move many items in one step, items are moved to newPositions when it's pushed.
+ */
+class SetItemsCoordinates : public QUndoCommand
+{
+public:
+    enum
+    {
+        Id = 1185
+    };
+
+    SetItemsCoordinates(QList<QGraphicsItem*> itemList,
+                        QVector<QPointF> newPositions,
+                        QUndoCommand* parent = nullptr);
+
+    void undo();
+    void redo();
+
+    int
+    id() const
+    {
+        return Id;
+    }
+
+private:
+    QList<QGraphicsItem*> items;
+    QVector<QPointF> oldCoords;
+    QVector<QPointF> newCoords;
+};
+
 class SetItemScale : public QUndoCommand
 {
 public:
@@ -35,6 +35,7 @@
 
 #include "scene.h"
 #include "textview.h"
+#include "chartsnapshot.h"
 
 #include "settings.h"
 #include <QDate>
@@ -117,9 +118,67 @@ CrochetTab::CrochetTab(Scene::ChartStyle style,
 
 CrochetTab::~CrochetTab()
 {
+    delete mPendingChart;
     delete ui;
 }
 
+void
+CrochetTab::setPendingChart(PendingChart* chart,
+                            const QMap<QString, int>& stitches,
+                            const QMap<QString, int>& colors)
+{
+    delete mPendingChart;
+    mPendingChart = chart;
+
+    addPatternCounts(stitches, colors);
+}
+
+void
+CrochetTab::addPatternCounts(const QMap<QString, int>& stitches, const QMap<QString, int>& colors)
+{
+    foreach (QString st, stitches.keys())
+        mPatternStitches->operator[](st) += stitches.value(st);
+
+    qint64 added = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    foreach (QString color, colors.keys())
+    {
+        if (!mPatternColors->contains(color))
+        {
+            if (colors.value(color) <= 0)
+                continue;
+            QMap<QString, qint64> properties;
+            properties["added"] = added;
+            properties["count"] = 0;
+            mPatternColors->insert(color, properties);
+        }
+
+        qint64& count = mPatternColors->operator[](color)["count"];
+        count += colors.value(color);
+        if (count <= 0)
+            mPatternColors->remove(color);
+    }
+
+    emit chartStitchChanged();
+    emit patternColorsChanged();
+    emit chartColorChanged();
+}
+
+void
+CrochetTab::loadPendingChart()
+{
+    if (!mPendingChart)
+        return;
+
+    PendingChart* chart = mPendingChart;
+    mPendingChart = nullptr;
+
+    mLoadingChart = true;
+    chart->load(this);
+    mLoadingChart = false;
+
+    delete chart;
+}
+
 QStringList
 CrochetTab::editModes()
 {
@@ -153,63 +212,83 @@ CrochetTab::selectMode() const
 void
 CrochetTab::renderChartSelected(QPainter* painter, QRectF rect)
 {
-    QRectF r = mScene->selectedItemsBoundingRect(mScene->selectedItems());
-    // make all unselected items invisible
-    QList<QGraphicsItem*> selected = mScene->selectedItems();
-    foreach (QGraphicsItem* item, mScene->items())
-    {
-        item->setVisible(false);
-    }
-    foreach (QGraphicsItem* item, selected)
-    {
-        item->setVisible(true);
-    }
-    mScene->render(painter, rect, r);
+    QList<QGraphicsItem*> items = scene()->selectedItemsInStackingOrder();
+    QRectF r = scene()->selectedItemsBoundingRect(scene()->selectedItems());
 
-    mView->centerOn(r.center());
+    scene()->renderItems(painter, items, rect, r);
 
-    // and make them visible once more
-    foreach (QGraphicsItem* item, mScene->items())
-    {
-        item->setVisible(true);
-    }
+    mView->centerOn(r.center());
 }
 
 void
 CrochetTab::renderChart(QPainter* painter, QRectF rect)
 {
-    QRectF r = mScene->itemsBoundingRect();
-    mScene->render(painter, rect, r);
+    QRectF r = scene()->itemsBoundingRect();
+    scene()->renderItems(painter, scene()->items(Qt::AscendingOrder), rect, r);
 
     mView->centerOn(r.center());
 }
 
+QSharedPointer<ChartSnapshot>
+CrochetTab::snapshot(bool selectedOnly)
+{
+    if (!selectedOnly)
+    {
+        return QSharedPointer<ChartSnapshot>(
+            new ChartSnapshot(scene()->items(Qt::AscendingOrder), scene()->itemsBoundingRect()));
+    }
+
+    QList<QGraphicsItem*> items = scene()->selectedItemsInStackingOrder();
+    QRectF r = scene()->selectedItemsBoundingRect(scene()->selectedItems());
+
+    return QSharedPointer<ChartSnapshot>(new ChartSnapshot(items, r));
+}
+
 void
 CrochetTab::stitchChanged(QString oldSt, QString newSt)
 {
+    if (mLoadingChart)
+        return;
+
+    // the stitch list only shows which stitches are used, it's only rebuilt when that changes.
+    bool changed = false;
     if (!oldSt.isEmpty())
     {
         mPatternStitches->operator[](oldSt)--;
         if (mPatternStitches->operator[](oldSt) == 0)
+        {
             mPatternStitches->remove(oldSt);
+            changed = true;
+        }
     }
 
     if (!mPatternStitches->contains(newSt))
+    {
         mPatternStitches->insert(newSt, 1);
+        changed = true;
+    }
     else
         mPatternStitches->operator[](newSt)++;
 
-    emit chartStitchChanged();
+    if (changed)
+        emit chartStitchChanged();
 }
 
 void
 CrochetTab::colorChanged(QString oldColor, QString newColor)
 {
+    if (mLoadingChart)
+        return;
+
+    bool changed = false;
     if (!oldColor.isEmpty())
     {
         mPatternColors->operator[](oldColor)["count"]--;
         if (mPatternColors->operator[](oldColor)["count"] == 0)
+        {
             mPatternColors->remove(oldColor);
+            changed = true;
+        }
     }
 
     if (!mPatternColors->contains(newColor))
@@ -218,10 +297,13 @@ CrochetTab::colorChanged(QString oldColor, QString newColor)
         properties["added"] = QDateTime::currentDateTime().toMSecsSinceEpoch();
         properties["count"] = 1;
         mPatternColors->insert(newColor, properties);
+        changed = true;
     }
     else
         mPatternColors->operator[](newColor)["count"]++;
 
+    if (changed)
+        emit patternColorsChanged();
     emit chartColorChanged();
 }
 
@@ -277,19 +359,19 @@ CrochetTab::createChart(
 {
     if (style == Scene::Rows)
     {
-        mScene->createRowsChart(rows, cols, defStitch, rowSize);
+        scene()->createRowsChart(rows, cols, defStitch, rowSize);
 
-        mView->centerOn(mView->mapFromScene(mScene->itemsBoundingRect().bottomRight()));
-        QPointF pt = mScene->itemsBoundingRect().topLeft();
+        mView->centerOn(mView->mapFromScene(scene()->itemsBoundingRect().bottomRight()));
+        QPointF pt = scene()->itemsBoundingRect().topLeft();
         mView->ensureVisible(pt.x(), pt.y(), 50, 50);
     }
     else if (style == Scene::Rounds)
     {
-        mScene->createRoundsChart(rows, cols, defStitch, rowSize, increaseBy);
+        scene()->createRoundsChart(rows, cols, defStitch, rowSize, increaseBy);
     }
     else if (style == Scene::Blank)
     {
-        mScene->createBlankChart();
+        scene()->createBlankChart();
     }
 
     mRowEditDialog->updateRowList();
@@ -318,6 +400,7 @@ CrochetTab::copyInstructions()
 {
     QClipboard* clipboard = QApplication::clipboard();
 
+    loadPendingChart();
     QString instructions = mTextView->copyInstructions();
     clipboard->setText(instructions);
 }
@@ -325,7 +408,7 @@ CrochetTab::copyInstructions()
 void
 CrochetTab::setShowChartCenter(bool state)
 {
-    mScene->setShowChartCenter(state);
+    scene()->setShowChartCenter(state);
 
     emit tabModified(true);
 }
@@ -333,14 +416,14 @@ CrochetTab::setShowChartCenter(bool state)
 void
 CrochetTab::sceneUpdate()
 {
-    mScene->update();
+    scene()->update();
 }
 
 void
 CrochetTab::clearSelection()
 {
-    mScene->clearSelection();
-    mScene->update();
+    scene()->clearSelection();
+    scene()->update();
 }
 
 void
@@ -362,151 +445,164 @@ CrochetTab::showRowEditor(bool state)
 void
 CrochetTab::replaceStitches(QString original, QString replacement)
 {
-    mScene->replaceStitches(original, replacement);
+    scene()->replaceStitches(original, replacement);
 }
 
 void
 CrochetTab::replaceColor(QColor original, QColor replacement, int selection)
 {
-    mScene->replaceColor(original, replacement, selection);
+    scene()->replaceColor(original, replacement, selection);
+}
+
+void
+CrochetTab::selectStitch(QString stitch)
+{
+    scene()->selectStitch(stitch);
+}
+
+void
+CrochetTab::selectColor(QColor color)
+{
+    scene()->selectColor(color);
 }
 
 void
 CrochetTab::updateRows()
 {
+    loadPendingChart();
     mRowEditDialog->updateRowList();
 }
 
 void
 CrochetTab::alignSelection(int alignmentStyle)
 {
-    mScene->alignSelection(alignmentStyle);
+    scene()->alignSelection(alignmentStyle);
 }
 
 void
 CrochetTab::distributeSelection(int distributionStyle)
 {
-    mScene->distributeSelection(distributionStyle);
+    scene()->distributeSelection(distributionStyle);
 }
 
 void
 CrochetTab::arrangeGrid(QSize grid, QSize alignment, QSize spacing, bool useSelection)
 {
-    mScene->arrangeGrid(grid, alignment, spacing, useSelection);
+    scene()->arrangeGrid(grid, alignment, spacing, useSelection);
 }
 
 void
 CrochetTab::addLayer(const QString& layer)
 {
-    mScene->addLayerUndoable(layer);
+    scene()->addLayerUndoable(layer);
 }
 
 void
 CrochetTab::addLayer(const QString& layer, unsigned int uid)
 {
-    mScene->addLayerUndoable(layer, uid);
+    scene()->addLayerUndoable(layer, uid);
 }
 
 void
 CrochetTab::removeSelectedLayer()
 {
-    mScene->removeSelectedLayer();
+    scene()->removeSelectedLayer();
 }
 
 void
 CrochetTab::mergeLayer(unsigned int from, unsigned int to)
 {
-    mScene->mergeLayer(from, to);
+    scene()->mergeLayer(from, to);
 }
 
 void
 CrochetTab::selectLayer(unsigned int uid)
 {
-    mScene->selectLayer(uid);
+    scene()->selectLayer(uid);
 }
 
 void
 CrochetTab::editedLayer(ChartLayer* layer)
 {
-    mScene->editedLayer(layer);
+    scene()->editedLayer(layer);
 }
 
 void
 CrochetTab::copy(int direction)
 {
-    mScene->copy(direction);
+    scene()->copy(direction);
 }
 
 void
 CrochetTab::mirror(int direction)
 {
-    mScene->mirror(direction);
+    scene()->mirror(direction);
 }
 
 void
 CrochetTab::rotate(qreal degrees)
 {
-    mScene->rotate(degrees);
+    scene()->rotate(degrees);
 }
 
 void
 CrochetTab::resizeScene(QRectF rectangle)
 {
-    mScene->resizeScene(rectangle);
+    scene()->resizeScene(rectangle);
 }
 
 void
 CrochetTab::copy()
 {
-    mScene->copy();
+    scene()->copy();
 }
 
 void
 CrochetTab::cut()
 {
-    mScene->cut();
+    scene()->cut();
 }
 
 void
 CrochetTab::paste()
 {
-    mScene->paste();
+    scene()->paste();
 }
 
 void
 CrochetTab::insertImage(const QString& filename, QPointF pos)
 {
-    mScene->insertImage(filename, pos);
+    scene()->insertImage(filename, pos);
 }
 
 void
 CrochetTab::group()
 {
-    mScene->group();
+    scene()->group();
 }
 
 void
 CrochetTab::ungroup()
 {
-    mScene->ungroup();
+    scene()->ungroup();
 }
 
 bool
 CrochetTab::hasChartCenter()
 {
-    return mScene->showChartCenter();
+    return scene()->showChartCenter();
 }
 
 void
 CrochetTab::setChartCenter(bool state)
 {
-    mScene->setShowChartCenter(state);
+    scene()->setShowChartCenter(state);
 }
 
 bool
 CrochetTab::hasGuidelines()
 {
-    if (mScene->guidelines().type() != tr("None"))
+    if (scene()->guidelines().type() != tr("None"))
         return true;
     return false;
 }
@@ -514,23 +610,23 @@ CrochetTab::hasGuidelines()
 void
 CrochetTab::propertiesUpdate(QString property, QVariant newValue)
 {
-    mScene->propertiesUpdate(property, newValue);
+    scene()->propertiesUpdate(property, newValue);
 }
 
 void
 CrochetTab::updateDefaultStitchColor(QColor originalColor, QColor newColor)
 {
-    mScene->updateDefaultStitchColor(originalColor, newColor);
+    scene()->updateDefaultStitchColor(originalColor, newColor);
 }
 
 QList<QGraphicsItem*>
 CrochetTab::selectedItems()
 {
-    return mScene->selectedItems();
+    return scene()->selectedItems();
 }
 
 void
 CrochetTab::setGuidelinesType(QString guide)
 {
-    mScene->setGuidelinesType(guide);
+    scene()->setGuidelinesType(guide);
 }
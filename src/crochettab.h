@@ -26,14 +26,31 @@
 
 #include "chartview.h"
 #include <QPointer>
+#include <QSharedPointer>
 
 #include "scene.h"
 
 #include "roweditdialog.h"
 
 class QGraphicsView;
+class ChartSnapshot;
 class TextView;
 class QUndoStack;
+class CrochetTab;
+
+/**
+ * Chart contents that have been read from a file but not turned into scene items yet.
+ */
+class PendingChart
+{
+public:
+    virtual ~PendingChart() {}
+
+    /**
+     * create the scene items for the chart in tab.
+     */
+    virtual void load(CrochetTab* tab) = 0;
+};
 
 namespace Ui
 {
@@ -62,6 +79,11 @@ public:
     void renderChart(QPainter* painter, QRectF rect = QRectF());
     void renderChartSelected(QPainter* painter, QRectF rect = QRectF());
 
+    /**
+     * copy the chart, or the selected part of it, for painting from another thread.
+     */
+    QSharedPointer<ChartSnapshot> snapshot(bool selectedOnly = false);
+
     void
     setPatternStitches(QMap<QString, int>* stitches)
     {
@@ -126,10 +148,42 @@ public:
 
     QList<QGraphicsItem*> selectedItems();
 
+    /**
+     * Charts that aren't visible when a file is opened are kept as a PendingChart and only
+     * loaded into the scene the first time it's needed. The tab takes ownership of chart.
+     * stitches and colors are the pattern stitch and colour counts the chart will add.
+     */
+    void setPendingChart(PendingChart* chart,
+                         const QMap<QString, int>& stitches,
+                         const QMap<QString, int>& colors);
+
+    bool
+    hasPendingChart() const
+    {
+        return mPendingChart != nullptr;
+    }
+
+    void loadPendingChart();
+
+    /**
+     * the cells of a chart that's being loaded don't count their stitches and colours one at a
+     * time, the file adds the counts of the whole chart with addPatternCounts() instead.
+     */
+    void
+    setLoadingChart(bool loading)
+    {
+        mLoadingChart = loading;
+    }
+    void addPatternCounts(const QMap<QString, int>& stitches, const QMap<QString, int>& colors);
+
 signals:
     void layersChanged(QList<ChartLayer*>& layers, ChartLayer* selected);
     void chartStitchChanged();
     void chartColorChanged();
+    /**
+     * a colour was added to or removed from the pattern.
+     */
+    void patternColorsChanged();
     void tabModified(bool state);
 
     void guidelinesUpdated(Guidelines guidelines);
@@ -170,6 +224,12 @@ public slots:
     void replaceStitches(QString original, QString replacement);
     void replaceColor(QColor original, QColor replacement, int selection);
 
+    /**
+     * select all the cells with stitch or color.
+     */
+    void selectStitch(QString stitch);
+    void selectColor(QColor color);
+
 protected:
     QMap<QString, int>*
     patternStitches()
@@ -187,6 +247,8 @@ public:
     Scene*
     scene()
     {
+        if (mPendingChart)
+            loadPendingChart();
         return mScene;
     }
 
@@ -210,6 +272,11 @@ private:
     RowEditDialog* mRowEditDialog = nullptr;
 
     Scene::ChartStyle mChartStyle;
+
+    PendingChart* mPendingChart = nullptr;
+
+    // the pattern counts of a chart that's being loaded are added by the file.
+    bool mLoadingChart = false;
 };
 
 #endif  // CROCHETTAB_H
@@ -27,12 +27,18 @@
 #include "math.h"
 
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QEventLoop>
 #include <QFileDialog>
+#include <QFile>
 
 #include <QPrinter>       //for pdf
 #include <QSvgGenerator>  //for svg
 
 #include "crochettab.h"
+#include "svgsymbolwriter.h"
+#include "chartexportjob.h"
+#include "charttiler.h"
 #include "scene.h"  // for to connect the scene to the view.
 
 ExportUi::ExportUi(QTabWidget* tab,
@@ -41,12 +47,14 @@ ExportUi::ExportUi(QTabWidget* tab,
                    QWidget* parent)
     : QDialog(parent)
     , exportType("")
+    , tilePages(false)
     , selectionOnly(false)
     , scene(new QGraphicsScene(this))
     , ui(new Ui::ExportDialog)
     , mTabWidget(tab)
     , mStitches(stitches)
     , mColors(colors)
+    , mProgress(nullptr)
 {
     ui->setupUi(this);
     ui->view->scale(.6, .6);
@@ -59,6 +67,8 @@ ExportUi::ExportUi(QTabWidget* tab,
     // FIXME: chart options...
     ui->chartOptions->hide();
 
+    ui->tilePages->setChecked(Settings::inst()->value("printTiled").toBool());
+
     setupChartOptions();
     setupColorLegendOptions();
     setupStitchLegendOptions();
@@ -189,13 +199,15 @@ ExportUi::updateExportOptions(QString expType)
 
         ui->pageToChartSize->setVisible(true);
         ui->pageSizeLbl->setVisible(true);
+        ui->tilePages->setVisible(true);
+        ui->tilePagesLbl->setVisible(true);
 
         ui->headerFooter->setVisible(true);
         ui->headerFooterLbl->setVisible(true);
         if (ui->headerFooter->isChecked())
             ui->headerFooterLayout->show();
     }
-    else if (exportType == "svg")
+    else if (exportType == "svg" || exportType == "svg (symbols)")
     {
         // eui->optionsGroupBox->setVisible(false);
         ui->selectionLbl->setVisible(true);
@@ -213,6 +225,8 @@ ExportUi::updateExportOptions(QString expType)
 
         ui->pageToChartSize->setVisible(false);
         ui->pageSizeLbl->setVisible(false);
+        ui->tilePages->setVisible(false);
+        ui->tilePagesLbl->setVisible(false);
 
         ui->headerFooter->setVisible(false);
         ui->headerFooterLbl->setVisible(false);
@@ -237,6 +251,8 @@ ExportUi::updateExportOptions(QString expType)
 
         ui->pageToChartSize->setVisible(false);
         ui->pageSizeLbl->setVisible(false);
+        ui->tilePages->setVisible(false);
+        ui->tilePagesLbl->setVisible(false);
 
         ui->headerFooter->setVisible(true);
         ui->headerFooterLbl->setVisible(true);
@@ -314,6 +330,7 @@ ExportUi::exportData()
     width = ui->width->text().remove(" px").toInt();
     height = ui->height->text().remove(" px").toInt();
     pageToChartSize = ui->pageToChartSize->isChecked();
+    tilePages = ui->tilePages->isChecked();
     selectionOnly = ui->selectionOnly->isChecked();
     includeHeaderFooter = ui->headerFooter->isChecked();
 
@@ -322,6 +339,8 @@ ExportUi::exportData()
         filter = tr("Portable Document Format (pdf)(*.pdf)");
     else if (exportType == "svg")
         filter = tr("Scaled Vector Graphics (svg)(*.svg *.svgz)");
+    else if (exportType == "svg (symbols)")
+        filter = tr("Scaled Vector Graphics (svg)(*.svg)");
     else if (exportType == "jpeg")
         filter = tr("Joint Photographic Experts Group (jpeg)(*.jpeg *.jpg)");
     else if (exportType == "png")
@@ -358,7 +377,7 @@ ExportUi::exportData()
     {
         if (exportType == "pdf")
             exportLegendPdf();
-        else if (exportType == "svg")
+        else if (exportType == "svg" || exportType == "svg (symbols)")
             exportLegendSvg();
         else
             exportLegendImg();
@@ -369,6 +388,8 @@ ExportUi::exportData()
             exportPdf();
         else if (exportType == "svg")
             exportSvg();
+        else if (exportType == "svg (symbols)")
+            exportSvgSymbols();
         else
             exportImg();
     }
@@ -545,12 +566,9 @@ ExportUi::renderHeader(QPainter& painter, QString text)
 {
     painter.save();
     painter.resetTransform();
-    painter.setFont(QFont("Courier New", 12));
-    QRect boundingRect
-        = painter.boundingRect(painter.window(), Qt::AlignJustify | Qt::TextWordWrap, text);
-    painter.drawText(boundingRect, Qt::AlignJustify | Qt::TextWordWrap, text);
+    int height = ChartExportJob::paintHeader(&painter, painter.window(), text);
     painter.restore();
-    return boundingRect.height();
+    return height;
 }
 
 int
@@ -558,76 +576,77 @@ ExportUi::renderFooter(QPainter& painter, QString text)
 {
     painter.save();
     painter.resetTransform();
-    painter.setFont(QFont("Courier New", 12));
-    QRect boundingRect
-        = painter.boundingRect(painter.window(), Qt::AlignJustify | Qt::TextWordWrap, text);
-    painter.translate(0, painter.window().height() - boundingRect.height());
-    painter.drawText(boundingRect, Qt::AlignJustify | Qt::TextWordWrap, text);
+    int height = ChartExportJob::paintFooter(&painter, painter.window(), text);
     painter.restore();
-    return boundingRect.height();
+    return height;
 }
 
 void
 ExportUi::exportPdf()
 {
-    int tabCount = mTabWidget->count();
-    QPainter* p = new QPainter();
+    if (tilePages)
+    {
+        exportTiledPdf();
+        return;
+    }
 
-    QPrinter* printer = new QPrinter(QPrinter::HighResolution);
-    printer->setOutputFormat(QPrinter::PdfFormat);
-    printer->setOutputFileName(fileName);
-    printer->setResolution(96);
+    ChartExportJob* job = new ChartExportJob(this);
 
-    QSizeF size = ui->view->scene()->sceneRect().size();
-    if (pageToChartSize) {
-        QPageSize pageSize(size, QPageSize::Point);
-        printer->setPageSize(pageSize);
+    QString header, footer;
+    if (includeHeaderFooter)
+    {
+        header = ui->headerEdit->toPlainText();
+        footer = ui->footerEdit->toPlainText();
     }
 
-    p->begin(printer);
-
-    bool firstPass = true;
-    for (int i = 0; i < tabCount; ++i)
+    for (int i = 0; i < mTabWidget->count(); ++i)
     {
-        // every pass
-        if (!firstPass)
+        if (selection == tr("All Charts") || selection == mTabWidget->tabText(i))
         {
-            // start a new page with the printer
-            printer->newPage();
+            CrochetTab* tab = qobject_cast<CrochetTab*>(mTabWidget->widget(i));
+            job->addPage(tab->snapshot(selectionOnly), header, footer);
+
+            if (selection != tr("All Charts"))
+                break;
         }
+    }
 
-        // we store the height of the header for later
-        int headerSize = 0;
-        int footerSize = 0;
+    QPageLayout layout = QPrinter(QPrinter::HighResolution).pageLayout();
+    if (pageToChartSize)
+    {
+        QSizeF size = ui->view->scene()->sceneRect().size();
+        layout.setPageSize(QPageSize(size, QPageSize::Point));
+    }
 
-        // and print the header
-        if (includeHeaderFooter)
-        {
-            headerSize = renderHeader(*p, ui->headerEdit->toPlainText());
-            footerSize = renderFooter(*p, ui->footerEdit->toPlainText());
-        }
+    job->writePdf(fileName, layout, 96);
+    runExportJob(job);
+}
+
+void
+ExportUi::exportTiledPdf()
+{
+    const int pdfResolution = 300;
 
+    QPageLayout layout = QPrinter(QPrinter::HighResolution).pageLayout();
+    QRect pageRect(QPoint(0, 0), layout.paintRectPixels(pdfResolution).size());
+    qreal scale = ChartTiler::scaleFor(pdfResolution,
+                                       Settings::inst()->value("printStitchSize").toInt(),
+                                       Settings::inst()->value("cellWidth").toInt());
+    int overlap = qRound(Settings::inst()->value("printOverlap").toInt() / 25.4 * pdfResolution);
+
+    ChartExportJob* job = new ChartExportJob(this);
+    for (int i = 0; i < mTabWidget->count(); ++i)
+    {
         if (selection == tr("All Charts") || selection == mTabWidget->tabText(i))
         {
             CrochetTab* tab = qobject_cast<CrochetTab*>(mTabWidget->widget(i));
-
-            // calculate the position of the drawing, because of the header
-            QRectF renderRect = p->window();
-            renderRect.moveTop(headerSize);
-
-            // only render the selection if we must
-            if (selectionOnly)
-                tab->renderChartSelected(p, QRectF(0, headerSize, p->window().width(),
-                                                   p->window().height() - headerSize - footerSize));
-            else
-                tab->renderChart(p, QRectF(0, headerSize, p->window().width(),
-                                           p->window().height() - headerSize - footerSize));
-            firstPass = false;
-            if (selection != tr("All Charts"))
-                break;
+            job->addTiledPages(ChartTiler(tab->snapshot(selectionOnly), mTabWidget->tabText(i),
+                                          pageRect, pdfResolution, scale, overlap));
         }
     }
-    p->end();
+
+    job->writePdf(fileName, layout, pdfResolution);
+    runExportJob(job);
 }
 
 void
@@ -671,49 +690,129 @@ ExportUi::exportSvg()
 }
 
 void
-ExportUi::exportImg()
+ExportUi::exportSvgSymbols()
 {
-    int tabCount = mTabWidget->count();
-    QPainter* p = new QPainter();
+    CrochetTab* tab = nullptr;
 
-    double dpm = resolution * (39.3700787);
-    QImage img = QImage(QSize(width, height), QImage::Format_ARGB32);
-    img.setDotsPerMeterX(dpm);
-    img.setDotsPerMeterY(dpm);
+    for (int i = 0; i < mTabWidget->count(); ++i)
+    {
+        if (selection == mTabWidget->tabText(i))
+        {
+            tab = qobject_cast<CrochetTab*>(mTabWidget->widget(i));
+        }
+    }
 
-    p->begin(&img);
-    p->fillRect(0, 0, width, height, QColor(Qt::white));
+    Q_ASSERT(tab != nullptr);
 
-    // we store the height of the header for later
-    int headerSize = 0;
-    int footerSize = 0;
+    QList<QGraphicsItem*> items;
+    QRectF rect;
 
-    // and print the header
+    if (selectionOnly)
+    {
+        items = tab->scene()->selectedItemsInStackingOrder();
+        rect = tab->scene()->selectedItemsBoundingRect(tab->scene()->selectedItems());
+    }
+    else
+    {
+        items = tab->scene()->items(Qt::AscendingOrder);
+        rect = tab->scene()->itemsBoundingRect();
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        QMessageBox::warning(this, tr("Export Pattern"), tr("Could not write to %1.").arg(fileName));
+        return;
+    }
+
+    SvgSymbolWriter writer;
+    writer.setTitle(QFileInfo(fileName).baseName() + " ("
+                    + mTabWidget->tabText(mTabWidget->indexOf(tab)) + ")");
+    writer.setDescription(tr("This file was generated by %1").arg(qApp->applicationName()));
+    writer.write(&file, items, rect);
+
+    file.close();
+}
+
+void
+ExportUi::exportImg()
+{
+    ChartExportJob* job = new ChartExportJob(this);
+
+    QString header, footer;
     if (includeHeaderFooter)
     {
-        headerSize = renderHeader(*p, ui->headerEdit->toPlainText());
-        footerSize = renderFooter(*p, ui->footerEdit->toPlainText());
+        header = ui->headerEdit->toPlainText();
+        footer = ui->footerEdit->toPlainText();
     }
 
-    for (int i = 0; i < tabCount; ++i)
+    for (int i = 0; i < mTabWidget->count(); ++i)
     {
         if (selection == mTabWidget->tabText(i))
         {
             CrochetTab* tab = qobject_cast<CrochetTab*>(mTabWidget->widget(i));
-            if (selectionOnly)
-                tab->renderChartSelected(
-                    p, QRectF(QPointF(0, headerSize),
-                              QSizeF((qreal)width, (qreal)height - headerSize - footerSize)));
-            else
-                tab->renderChart(
-                    p, QRectF(QPointF(0, headerSize),
-                              QSizeF((qreal)width, (qreal)height - headerSize - footerSize)));
+            job->addPage(tab->snapshot(selectionOnly), header, footer);
+            break;
         }
     }
 
-    p->end();
+    if (job->pageCount() == 0)
+    {
+        delete job;
+        return;
+    }
+
+    job->writeImage(fileName, QSize(width, height), resolution);
+    runExportJob(job);
+}
+
+void
+ExportUi::runExportJob(ChartExportJob* job)
+{
+    mProgress = new QProgressDialog(tr("Exporting %1...").arg(QFileInfo(fileName).fileName()),
+                                    tr("Cancel"), 0, 0, this);
+    mProgress->setWindowModality(Qt::WindowModal);
+    mProgress->setMinimumDuration(500);
+
+    connect(job, SIGNAL(progress(int, int)), SLOT(exportProgress(int, int)));
+    connect(job, SIGNAL(finished(bool)), SLOT(exportFinished(bool)));
+    connect(mProgress, SIGNAL(canceled()), job, SLOT(cancel()));
+
+    // the dialog closes once the data is exported, keep it around until the job is done.
+    QEventLoop loop;
+    connect(job, SIGNAL(finished(bool)), &loop, SLOT(quit()));
+    loop.exec();
+}
+
+void
+ExportUi::exportProgress(int value, int maximum)
+{
+    if (!mProgress)
+        return;
+
+    mProgress->setMaximum(maximum);
+    mProgress->setValue(value);
+}
+
+void
+ExportUi::exportFinished(bool ok)
+{
+    ChartExportJob* job = qobject_cast<ChartExportJob*>(sender());
+
+    if (mProgress)
+    {
+        mProgress->deleteLater();
+        mProgress = nullptr;
+    }
+
+    if (!ok && job && !job->isCanceled())
+    {
+        QMessageBox::warning(this, tr("Export Pattern"),
+                             tr("There was an error exporting %1.").arg(fileName));
+    }
 
-    img.save(fileName);
+    if (job)
+        job->deleteLater();
 }
 
 void
@@ -27,6 +27,9 @@
 #include <QMap>
 #include "legends.h"
 
+class ChartExportJob;
+class QProgressDialog;
+
 namespace Ui
 {
 class ExportDialog;
@@ -46,6 +49,7 @@ public:
     QString exportType, selection, fileName;
     int resolution, width, height;
     bool pageToChartSize;
+    bool tilePages;
     bool selectionOnly;
     bool includeHeaderFooter;
     QGraphicsScene* scene;
@@ -66,6 +70,9 @@ private slots:
     void updateHightFromWidth(int width);
     void updateWidthFromHeight(int height);
 
+    void exportProgress(int value, int maximum);
+    void exportFinished(bool ok);
+
 private:
     void generateSelectionList(bool showAll);
 
@@ -78,13 +85,24 @@ private:
     void exportLegendImg();
 
     void exportPdf();
+    /**
+     * write each chart across as many pages as it needs at the stitch size from the settings.
+     */
+    void exportTiledPdf();
     void exportSvg();
+    void exportSvgSymbols();
     void exportImg();
 
     // returns the height of the rendered text
     int renderFooter(QPainter& painter, QString text);
     int renderHeader(QPainter& painter, QString text);
 
+    /**
+     * show the progress of job, which runs in the background, and let the user cancel it.
+     * Returns once the job has finished.
+     */
+    void runExportJob(ChartExportJob* job);
+
     void updateChartSizeRatio(QString selection);
     qreal sceneRatio(QRectF rect);
 
@@ -96,6 +114,8 @@ private:
 
     QMap<QString, int>* mStitches;
     QMap<QString, QMap<QString, qint64> >* mColors;
+
+    QProgressDialog* mProgress;
 };
 
 #endif  // EXPORTUI_H
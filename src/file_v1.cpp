@@ -53,9 +53,6 @@ File_v1::load(QDataStream* stream)
     mInternalStitchSet = new StitchSet();
     mInternalStitchSet->isTemporary = true;
     mInternalStitchSet->stitchSetFileName = StitchLibrary::inst()->nextSetSaveFile();
-    QString dest = mInternalStitchSet->stitchSetFileName;
-    QFileInfo info(dest);
-    QDir(info.path()).mkpath(info.path() + "/" + info.baseName());
 
     mInternalStitchSet->loadIcons(stream);
 
@@ -276,7 +273,7 @@ File_v1::loadGrid(QXmlStreamReader* stream, Scene* scene)
             {
                 row.append(0);
             }
-            scene->grid.append(row);
+            scene->gridAddRow(row);
         }
     }
 }
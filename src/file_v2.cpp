@@ -27,6 +27,7 @@
 #include <QFileInfo>
 #include <QTextDocument>
 #include <QDir>
+#include <QPainter>
 
 #include "stitchlibrary.h"
 #include "mainwindow.h"
@@ -42,16 +43,116 @@ File_v2::File_v2(MainWindow* mw, FileFactory* parent)
 {
 }
 
+qreal
+File_v2::toReal(const QStringRef& str)
+{
+    // Powers of ten that are exactly representable as a double.
+    static const double powers[]
+        = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const QChar* c = str.unicode();
+    const QChar* end = c + str.length();
+
+    bool negative = false;
+    if (c != end && (c->unicode() == '-' || c->unicode() == '+'))
+    {
+        negative = (c->unicode() == '-');
+        ++c;
+    }
+
+    // QString::number() writes plain decimals for everything we save. Up to 15 significant
+    // digits fit exactly into a double, and dividing by an exact power of ten rounds the same
+    // way a full conversion would. Anything else goes through the regular parser.
+    quint64 mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool fraction = false, hasDigits = false;
+
+    for (; c != end; ++c)
+    {
+        ushort u = c->unicode();
+        if (u >= '0' && u <= '9')
+        {
+            hasDigits = true;
+            if (mantissa != 0 || u != '0')
+            {
+                if (++digits > 15)
+                    return str.toDouble();
+                mantissa = mantissa * 10 + (u - '0');
+            }
+            if (fraction)
+                --exponent;
+        }
+        else if (u == '.' && !fraction)
+        {
+            fraction = true;
+        }
+        else
+        {
+            return str.toDouble();
+        }
+    }
+
+    if (!hasDigits)
+        return 0.0;
+
+    if (exponent < -22)
+        return str.toDouble();
+
+    double value = double(mantissa) / powers[-exponent];
+    return negative ? -value : value;
+}
+
+QColor
+File_v2::internColor(const QString& name)
+{
+    QHash<QString, QColor>::const_iterator it = mColorCache.constFind(name);
+    if (it != mColorCache.constEnd())
+        return it.value();
+
+    QColor color(name);
+    mColorCache.insert(name, color);
+    return color;
+}
+
+Stitch*
+File_v2::findStitch(const QString& name)
+{
+    QHash<QString, Stitch*>::const_iterator it = mStitchCache.constFind(name);
+    if (it != mStitchCache.constEnd())
+        return it.value();
+
+    Stitch* s = StitchLibrary::inst()->findStitch(name, true);
+    mStitchCache.insert(name, s);
+    return s;
+}
+
+void
+File_v2::countCell(const QString& stitch,
+                   const QColor& color,
+                   const QColor& bgColor,
+                   QMap<QString, int>* stitches,
+                   QMap<QString, int>* colors)
+{
+    (*stitches)[stitch]++;
+
+    // a new cell has a white background and no colour, Cell only reports the ones that change.
+    static const QColor white(Qt::white);
+    if (bgColor != white)
+    {
+        (*colors)[white.name()]--;
+        (*colors)[bgColor.name()]++;
+    }
+    if (color.isValid())
+        (*colors)[color.name()]++;
+}
+
 FileFactory::FileError
 File_v2::load(QDataStream* stream)
 {
     mInternalStitchSet = new StitchSet();
     mInternalStitchSet->isTemporary = true;
     mInternalStitchSet->stitchSetFileName = StitchLibrary::inst()->nextSetSaveFile();
-    QString dest = mInternalStitchSet->stitchSetFileName;
-
-    QFileInfo info(dest);
-    QDir(info.path()).mkpath(info.path() + "/" + info.baseName());
 
     mInternalStitchSet->loadIcons(stream);
 
@@ -95,9 +196,16 @@ File_v2::load(QDataStream* stream)
 FileFactory::FileError
 File_v2::save(QDataStream* stream)
 {
-    *stream << (qint32)FileFactory::Version_1_2;
+    qint32 version = FileFactory::Version_1_3;
+    if (mParent->mCurrentFileVersion == FileFactory::Version_1_2)
+        version = FileFactory::Version_1_2;
+
+    *stream << version;
     stream->setVersion(QDataStream::Qt_4_7);
 
+    if (version == FileFactory::Version_1_3)
+        saveMetadata(stream);
+
     if (!mInternalStitchSet)
     {
         mInternalStitchSet = new StitchSet();
@@ -147,17 +255,18 @@ File_v2::loadColors(QXmlStreamReader* stream)
 
     mw->patternColors().clear();
 
-    while (!(stream->isEndElement() && stream->name() == "colors"))
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("colors")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "color")
+        if (tag == QLatin1String("color"))
         {
+            const QXmlStreamAttributes attrs = stream->attributes();
             QMap<QString, qint64> properties;
             properties.insert("count", 0);  // count = 0 because we haven't added any cells yet.
             properties.insert("added",
-                              (qint64)stream->attributes().value("added").toString().toLongLong());
+                              (qint64)attrs.value(QLatin1String("added")).toLongLong());
             mw->mPatternColors.insert(stream->readElementText(), properties);
         }
     }
@@ -168,18 +277,19 @@ File_v2::loadChart(QXmlStreamReader* stream)
 {
     MainWindow* mw = mMainWindow;
     CrochetTab* tab = nullptr;
-    QString tabName = "", defaultSt = "";
+    QString tabName = "";
 
-    while (!(stream->isEndElement() && stream->name() == "chart"))
+    // the name and style always come first, the style is needed to create the tab.
+    while (!tab && !(stream->isEndElement() && stream->name() == QLatin1String("chart")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "name")
+        if (tag == QLatin1String("name"))
         {
             tabName = stream->readElementText();
         }
-        else if (tag == "style")
+        else if (tag == QLatin1String("style"))
         {
             int style = stream->readElementText().toInt();
             tab = mw->createTab((Scene::ChartStyle)style);
@@ -187,71 +297,106 @@ File_v2::loadChart(QXmlStreamReader* stream)
             mParent->mTabWidget->addTab(tab, "");
             mParent->mTabWidget->widget(mParent->mTabWidget->indexOf(tab))->hide();
         }
-        else if (tag == "defaultSt")
+        else if (stream->isStartElement())
         {
-            defaultSt = stream->readElementText();
-            Q_ASSERT(tab != nullptr);
-            tab->scene()->mDefaultStitch = defaultSt;
+            qWarning() << "loadChart tag before the chart style:" << tag;
+            stream->skipCurrentElement();
         }
-        else if (tag == "chartCenter")
+    }
+
+    Q_ASSERT(tab != nullptr);
+    int index = mParent->mTabWidget->indexOf(tab);
+    mParent->mTabWidget->setTabText(index, tabName);
+
+    // Only the visible chart is loaded now, the others are kept compressed until they're shown
+    // or needed for saving, exporting or printing.
+    if (index != mParent->mTabWidget->currentIndex())
+    {
+        PendingChart_v2* pending = new PendingChart_v2(mMainWindow, mParent);
+        pending->read(stream, this);
+        tab->setPendingChart(pending, pending->stitchCounts(), pending->colorCounts());
+        mParent->mTabWidget->widget(index)->show();
+        return;
+    }
+
+    tab->setLoadingChart(true);
+    loadChartContents(tab, stream);
+    tab->setLoadingChart(false);
+
+    tab->addPatternCounts(mStitchCounts, mColorCounts);
+    mStitchCounts.clear();
+    mColorCounts.clear();
+
+    mParent->mTabWidget->widget(index)->show();
+    finishChart(tab);
+}
+
+void
+File_v2::loadChartContents(CrochetTab* tab, QXmlStreamReader* stream)
+{
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("chart")))
+    {
+        stream->readNext();
+        QStringRef tag = stream->name();
+
+        if (tag == QLatin1String("defaultSt"))
+        {
+            tab->scene()->mDefaultStitch = stream->readElementText();
+        }
+        else if (tag == QLatin1String("chartCenter"))
         {
-            qreal x = stream->attributes().value("x").toString().toDouble();
-            qreal y = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            qreal x = toReal(attrs.value(QLatin1String("x")));
+            qreal y = toReal(attrs.value(QLatin1String("y")));
 
             stream->readElementText();
-            Q_ASSERT(tab != nullptr);
             tab->blockSignals(true);
             tab->setShowChartCenter(true);
             tab->scene()->mCenterSymbol->setPos(x, y);
             tab->blockSignals(false);
         }
-        else if (tag == "grid")
+        else if (tag == QLatin1String("grid"))
         {
-            Q_ASSERT(tab != nullptr);
             loadGrid(stream, tab->scene());
         }
-        else if (tag == "rowSpacing")
+        else if (tag == QLatin1String("rowSpacing"))
         {
-            qreal width = stream->attributes().value("width").toString().toDouble();
-            qreal height = stream->attributes().value("height").toString().toDouble();
-            Q_ASSERT(tab != nullptr);
+            const QXmlStreamAttributes attrs = stream->attributes();
+            qreal width = toReal(attrs.value(QLatin1String("width")));
+            qreal height = toReal(attrs.value(QLatin1String("height")));
             tab->scene()->mDefaultSize.setHeight(height);
             tab->scene()->mDefaultSize.setWidth(width);
 
             stream->readElementText();  // move to the next tag.
         }
-        else if (tag == "cell")
+        else if (tag == QLatin1String("cell"))
         {
-            Q_ASSERT(tab != nullptr);
             loadCell(tab, stream);
         }
-        else if (tag == "indicator")
+        else if (tag == QLatin1String("indicator"))
         {
-            Q_ASSERT(tab != nullptr);
             loadIndicator(tab, stream);
         }
-        else if (tag == "chartimage")
+        else if (tag == QLatin1String("chartimage"))
         {
-            Q_ASSERT(tab != nullptr);
             loadChartImage(tab, stream);
         }
-        else if (tag == "group")
+        else if (tag == QLatin1String("group"))
         {
             stream->readElementText().toInt();
             // create an empty group for future use.
             QList<QGraphicsItem*> items;
-            Q_ASSERT(tab != nullptr);
             tab->scene()->group(items);
         }
-        else if (tag == "guidelines")
+        else if (tag == QLatin1String("guidelines"))
         {
-            QString type = stream->attributes().value("type").toString();
-            int rows = stream->attributes().value("rows").toString().toInt();
-            int columns = stream->attributes().value("columns").toString().toInt();
-            int cellHeight = stream->attributes().value("cellHeight").toString().toInt();
-            int cellWidth = stream->attributes().value("cellWidth").toString().toInt();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            QString type = attrs.value(QLatin1String("type")).toString();
+            int rows = attrs.value(QLatin1String("rows")).toInt();
+            int columns = attrs.value(QLatin1String("columns")).toInt();
+            int cellHeight = attrs.value(QLatin1String("cellHeight")).toInt();
+            int cellWidth = attrs.value(QLatin1String("cellWidth")).toInt();
 
-            Q_ASSERT(tab != nullptr);
             tab->scene()->mGuidelines.setType(type);
             tab->scene()->mGuidelines.setColumns(columns);
             tab->scene()->mGuidelines.setRows(rows);
@@ -262,26 +407,26 @@ File_v2::loadChart(QXmlStreamReader* stream)
             tab->scene()->updateGuidelines();
             emit tab->updateGuidelines(tab->scene()->guidelines());
         }
-        else if (tag == "chartLayer")
+        else if (tag == QLatin1String("chartLayer"))
         {
-            QString name = stream->attributes().value("name").toString();
-            unsigned int uid = stream->attributes().value("uid").toString().toUInt();
-            bool visible = stream->attributes().value("visible").toString().toInt();
-            Q_ASSERT(tab != nullptr);
+            const QXmlStreamAttributes attrs = stream->attributes();
+            QString name = attrs.value(QLatin1String("name")).toString();
+            unsigned int uid = attrs.value(QLatin1String("uid")).toUInt();
+            bool visible = attrs.value(QLatin1String("visible")).toInt();
             tab->scene()->addLayer(name, uid);
             tab->scene()->getLayer(uid)->setVisible(visible);
             tab->scene()->selectLayer(uid);
             stream->readElementText();  // move to the next tag.
         }
-        else if (tag == "size")
+        else if (tag == QLatin1String("size"))
         {
-            qreal x = stream->attributes().value("x").toString().toDouble();
-            qreal y = stream->attributes().value("y").toString().toDouble();
-            qreal width = stream->attributes().value("width").toString().toDouble();
-            qreal height = stream->attributes().value("height").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            qreal x = toReal(attrs.value(QLatin1String("x")));
+            qreal y = toReal(attrs.value(QLatin1String("y")));
+            qreal width = toReal(attrs.value(QLatin1String("width")));
+            qreal height = toReal(attrs.value(QLatin1String("height")));
 
             QRectF size = QRectF(x, y, width, height);
-            Q_ASSERT(tab != nullptr);
             tab->scene()->setSceneRect(size);
 
             stream->readElementText();
@@ -291,15 +436,15 @@ File_v2::loadChart(QXmlStreamReader* stream)
             qWarning() << "loadChart Unknown tag:" << tag;
         }
     }
+}
 
+void
+File_v2::finishChart(CrochetTab* tab)
+{
     // refresh the layers so the visibility and selectability of items is correct
-    Q_ASSERT(tab != nullptr);
     tab->scene()->refreshLayers();
 
     tab->updateRows();
-    int index = mParent->mTabWidget->indexOf(tab);
-    mParent->mTabWidget->setTabText(index, tabName);
-    mParent->mTabWidget->widget(mParent->mTabWidget->indexOf(tab))->show();
     tab->scene()->updateSceneRect();
     if (tab->scene()->hasChartCenter())
     {
@@ -311,15 +456,114 @@ File_v2::loadChart(QXmlStreamReader* stream)
     }
 }
 
+PendingChart_v2::PendingChart_v2(MainWindow* mw, FileFactory* parent)
+    : mMainWindow(mw)
+    , mParent(parent)
+{
+}
+
+void
+PendingChart_v2::read(QXmlStreamReader* stream, File_v2* file)
+{
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    writer.writeStartElement("chart");
+
+    // track the cell properties that end up in the pattern stitch and colour counts.
+    enum Field
+    {
+        NoField,
+        StitchField,
+        ColorField,
+        BgColorField
+    };
+    Field field = NoField;
+    bool inCell = false;
+    QString stitch, color, bgColor;
+
+    while (!stream->atEnd() && !stream->hasError())
+    {
+        stream->readNext();
+        if (stream->isEndElement() && stream->name() == QLatin1String("chart"))
+            break;
+
+        writer.writeCurrentToken(*stream);
+
+        if (stream->isStartElement())
+        {
+            QStringRef tag = stream->name();
+            if (tag == QLatin1String("cell"))
+            {
+                inCell = true;
+                stitch.clear();
+                color.clear();
+                bgColor.clear();
+            }
+            else if (inCell && tag == QLatin1String("stitch"))
+                field = StitchField;
+            else if (inCell && tag == QLatin1String("color"))
+                field = ColorField;
+            else if (inCell && tag == QLatin1String("bgColor"))
+                field = BgColorField;
+        }
+        else if (stream->isCharacters())
+        {
+            if (field == StitchField)
+                stitch += stream->text();
+            else if (field == ColorField)
+                color += stream->text();
+            else if (field == BgColorField)
+                bgColor += stream->text();
+        }
+        else if (stream->isEndElement())
+        {
+            field = NoField;
+            if (stream->name() == QLatin1String("cell"))
+            {
+                inCell = false;
+                File_v2::countCell(stitch, file->internColor(color), file->internColor(bgColor),
+                                   &mStitchCounts, &mColorCounts);
+            }
+        }
+    }
+
+    writer.writeEndElement();  // chart
+    mData = qCompress(xml);
+}
+
+void
+PendingChart_v2::load(CrochetTab* tab)
+{
+    QByteArray xml = qUncompress(mData);
+    QXmlStreamReader stream(xml);
+
+    File_v2 file(mMainWindow, mParent);
+
+    while (!stream.atEnd() && !stream.hasError())
+    {
+        stream.readNext();
+        if (stream.isStartElement() && stream.name() == QLatin1String("chart"))
+        {
+            file.loadChartContents(tab, &stream);
+            break;
+        }
+    }
+
+    if (stream.hasError())
+        qWarning() << "Error loading chart: " << stream.errorString();
+
+    file.finishChart(tab);
+}
+
 void
 File_v2::loadGrid(QXmlStreamReader* stream, Scene* scene)
 {
-    while (!(stream->isEndElement() && stream->name() == "grid"))
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("grid")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "row")
+        if (tag == QLatin1String("row"))
         {
             int cols = stream->readElementText().toInt();
             QList<Cell*> row;
@@ -327,7 +571,7 @@ File_v2::loadGrid(QXmlStreamReader* stream, Scene* scene)
             {
                 row.append(0);
             }
-            scene->grid.append(row);
+            scene->gridAddRow(row);
         }
     }
 }
@@ -349,20 +593,20 @@ File_v2::loadIndicator(CrochetTab* tab, QXmlStreamReader* stream)
     qreal rotation = 0, scaleX = 1, scaleY = 1;
     int group = -1;
     unsigned int layer = 0;
-    while (!(stream->isEndElement() && stream->name() == "indicator"))
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("indicator")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "x")
+        if (tag == QLatin1String("x"))
         {
             x = stream->readElementText().toDouble();
         }
-        else if (tag == "y")
+        else if (tag == QLatin1String("y"))
         {
             y = stream->readElementText().toDouble();
         }
-        else if (tag == "text")
+        else if (tag == QLatin1String("text"))
         {
             text = stream->readElementText();
             // the text might be html formatted in old saves, so we need to strip it. A regex could
@@ -372,62 +616,65 @@ File_v2::loadIndicator(CrochetTab* tab, QXmlStreamReader* stream)
             doc.setHtml(text);
             text = doc.toPlainText();
         }
-        else if (tag == "textColor")
+        else if (tag == QLatin1String("textColor"))
         {
             textColor = stream->readElementText();
         }
-        else if (tag == "bgColor")
+        else if (tag == QLatin1String("bgColor"))
         {
             bgColor = stream->readElementText();
         }
-        else if (tag == "style")
+        else if (tag == QLatin1String("style"))
         {
             style = stream->readElementText();
         }
-        else if (tag == "group")
+        else if (tag == QLatin1String("group"))
         {
             group = stream->readElementText().toInt();
         }
-        else if (tag == "fontname")
+        else if (tag == QLatin1String("fontname"))
         {
             fontname = stream->readElementText();
             fontused = true;
         }
-        else if (tag == "fontsize")
+        else if (tag == QLatin1String("fontsize"))
         {
             fontsize = stream->readElementText().toInt();
             fontused = true;
         }
-        else if (tag == "layer")
+        else if (tag == QLatin1String("layer"))
         {
             layer = stream->readElementText().toUInt();
         }
-        else if (tag == "newscale")
+        else if (tag == QLatin1String("newscale"))
         {
-            scaleX = stream->attributes().value("scaleX").toString().toDouble();
-            scaleY = stream->attributes().value("scaleY").toString().toDouble();
-            pivotScale.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotScale.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            scaleX = toReal(attrs.value(QLatin1String("scaleX")));
+            scaleY = toReal(attrs.value(QLatin1String("scaleY")));
+            pivotScale.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotScale.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "rotation")
+        else if (tag == QLatin1String("rotation"))
         {
-            rotation = stream->attributes().value("rotation").toString().toDouble();
-            pivotRotation.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotRotation.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            rotation = toReal(attrs.value(QLatin1String("rotation")));
+            pivotRotation.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotRotation.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "transformation")
-        {
-            m11 = stream->attributes().value("m11").toString().toDouble();
-            m12 = stream->attributes().value("m12").toString().toDouble();
-            m13 = stream->attributes().value("m13").toString().toDouble();
-            m21 = stream->attributes().value("m21").toString().toDouble();
-            m22 = stream->attributes().value("m22").toString().toDouble();
-            m23 = stream->attributes().value("m23").toString().toDouble();
-            m31 = stream->attributes().value("m31").toString().toDouble();
-            m32 = stream->attributes().value("m32").toString().toDouble();
-            m33 = stream->attributes().value("m33").toString().toDouble();
+        else if (tag == QLatin1String("transformation"))
+        {
+            const QXmlStreamAttributes attrs = stream->attributes();
+            m11 = toReal(attrs.value(QLatin1String("m11")));
+            m12 = toReal(attrs.value(QLatin1String("m12")));
+            m13 = toReal(attrs.value(QLatin1String("m13")));
+            m21 = toReal(attrs.value(QLatin1String("m21")));
+            m22 = toReal(attrs.value(QLatin1String("m22")));
+            m23 = toReal(attrs.value(QLatin1String("m23")));
+            m31 = toReal(attrs.value(QLatin1String("m31")));
+            m32 = toReal(attrs.value(QLatin1String("m32")));
+            m33 = toReal(attrs.value(QLatin1String("m33")));
             stream->readElementText();
         }
     }
@@ -444,8 +691,8 @@ File_v2::loadIndicator(CrochetTab* tab, QXmlStreamReader* stream)
     i->setPos(x, y);
     i->setText(text);
     qDebug() << "loading text " << text;
-    i->setTextColor(textColor);
-    i->setBgColor(bgColor);
+    i->setTextColor(internColor(textColor));
+    i->setBgColor(internColor(bgColor));
     i->setLayer(layer);
     if (fontused)
         i->setFont(QFont(fontname, fontsize));
@@ -480,71 +727,77 @@ File_v2::loadChartImage(CrochetTab* tab, QXmlStreamReader* stream)
     qreal m11 = 1, m12 = 0, m13 = 0, m21 = 0, m22 = 1, m23 = 0, m31 = 0, m32 = 0, m33 = 1;
     QString filename;
 
-    while (!(stream->isEndElement() && stream->name() == "chartimage"))
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("chartimage")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "position")
+        if (tag == QLatin1String("position"))
         {
-            position.rx() = stream->attributes().value("x").toString().toDouble();
-            position.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            position.rx() = toReal(attrs.value(QLatin1String("x")));
+            position.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "angle")
+        else if (tag == QLatin1String("angle"))
         {
             angle = stream->readElementText().toDouble();
         }
-        else if (tag == "scale")
+        else if (tag == QLatin1String("scale"))
         {
-            scale.rx() = stream->attributes().value("x").toString().toDouble();
-            scale.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            scale.rx() = toReal(attrs.value(QLatin1String("x")));
+            scale.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "newscale")
+        else if (tag == QLatin1String("newscale"))
         {
-            scaleX = stream->attributes().value("scaleX").toString().toDouble();
-            scaleY = stream->attributes().value("scaleY").toString().toDouble();
-            pivotScale.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotScale.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            scaleX = toReal(attrs.value(QLatin1String("scaleX")));
+            scaleY = toReal(attrs.value(QLatin1String("scaleY")));
+            pivotScale.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotScale.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "rotation")
+        else if (tag == QLatin1String("rotation"))
         {
-            rotation = stream->attributes().value("rotation").toString().toDouble();
-            pivotRotation.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotRotation.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            rotation = toReal(attrs.value(QLatin1String("rotation")));
+            pivotRotation.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotRotation.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "pivotPoint")
+        else if (tag == QLatin1String("pivotPoint"))
         {
-            pivotPoint.rx() = stream->attributes().value("x").toString().toDouble();
-            pivotPoint.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            pivotPoint.rx() = toReal(attrs.value(QLatin1String("x")));
+            pivotPoint.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "group")
+        else if (tag == QLatin1String("group"))
         {
             group = stream->readElementText().toInt();
         }
-        else if (tag == "layer")
+        else if (tag == QLatin1String("layer"))
         {
             layer = stream->readElementText().toUInt();
         }
-        else if (tag == "filename")
+        else if (tag == QLatin1String("filename"))
         {
             filename = stream->readElementText();
         }
-        else if (tag == "transformation")
-        {
-            m11 = stream->attributes().value("m11").toString().toDouble();
-            m12 = stream->attributes().value("m12").toString().toDouble();
-            m13 = stream->attributes().value("m13").toString().toDouble();
-            m21 = stream->attributes().value("m21").toString().toDouble();
-            m22 = stream->attributes().value("m22").toString().toDouble();
-            m23 = stream->attributes().value("m23").toString().toDouble();
-            m31 = stream->attributes().value("m31").toString().toDouble();
-            m32 = stream->attributes().value("m32").toString().toDouble();
-            m33 = stream->attributes().value("m33").toString().toDouble();
+        else if (tag == QLatin1String("transformation"))
+        {
+            const QXmlStreamAttributes attrs = stream->attributes();
+            m11 = toReal(attrs.value(QLatin1String("m11")));
+            m12 = toReal(attrs.value(QLatin1String("m12")));
+            m13 = toReal(attrs.value(QLatin1String("m13")));
+            m21 = toReal(attrs.value(QLatin1String("m21")));
+            m22 = toReal(attrs.value(QLatin1String("m22")));
+            m23 = toReal(attrs.value(QLatin1String("m23")));
+            m31 = toReal(attrs.value(QLatin1String("m31")));
+            m32 = toReal(attrs.value(QLatin1String("m32")));
+            m33 = toReal(attrs.value(QLatin1String("m33")));
             stream->readElementText();
         }
     }
@@ -591,90 +844,92 @@ File_v2::loadCell(CrochetTab* tab, QXmlStreamReader* stream)
     QTransform transform;
     qreal m11 = 1, m12 = 0, m13 = 0, m21 = 0, m22 = 1, m23 = 0, m31 = 0, m32 = 0, m33 = 1;
 
-    while (!(stream->isEndElement() && stream->name() == "cell"))
+    while (!(stream->isEndElement() && stream->name() == QLatin1String("cell")))
     {
         stream->readNext();
-        QString tag = stream->name().toString();
+        QStringRef tag = stream->name();
 
-        if (tag == "stitch")
+        if (tag == QLatin1String("stitch"))
         {
-            QString st = stream->readElementText();
-            s = StitchLibrary::inst()->findStitch(st, true);
+            s = findStitch(stream->readElementText());
         }
-        else if (tag == "grid")
+        else if (tag == QLatin1String("grid"))
         {
-            row = stream->attributes().value("row").toString().toDouble();
-            column = stream->attributes().value("column").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            row = attrs.value(QLatin1String("row")).toInt();
+            column = attrs.value(QLatin1String("column")).toInt();
             stream->readElementText();
         }
-        else if (tag == "color")
+        else if (tag == QLatin1String("color"))
         {
             color = stream->readElementText();
         }
-        else if (tag == "bgColor")
+        else if (tag == QLatin1String("bgColor"))
         {
             bgColor = stream->readElementText();
         }
-        else if (tag == "position")
+        else if (tag == QLatin1String("position"))
         {
-            position.rx() = stream->attributes().value("x").toString().toDouble();
-            position.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            position.rx() = toReal(attrs.value(QLatin1String("x")));
+            position.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "angle")
+        else if (tag == QLatin1String("angle"))
         {
             angle = stream->readElementText().toDouble();
         }
-        else if (tag == "scale")
+        else if (tag == QLatin1String("scale"))
         {
-            scale.rx() = stream->attributes().value("x").toString().toDouble();
-            scale.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            scale.rx() = toReal(attrs.value(QLatin1String("x")));
+            scale.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "pivotPoint")
+        else if (tag == QLatin1String("pivotPoint"))
         {
-            pivotPoint.rx() = stream->attributes().value("x").toString().toDouble();
-            pivotPoint.ry() = stream->attributes().value("y").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            pivotPoint.rx() = toReal(attrs.value(QLatin1String("x")));
+            pivotPoint.ry() = toReal(attrs.value(QLatin1String("y")));
             stream->readElementText();
         }
-        else if (tag == "group")
+        else if (tag == QLatin1String("group"))
         {
             group = stream->readElementText().toInt();
         }
-        else if (tag == "layer")
+        else if (tag == QLatin1String("layer"))
         {
             layer = stream->readElementText().toUInt();
         }
-        else if (tag == "group")
+        else if (tag == QLatin1String("newscale"))
         {
-            group = stream->readElementText().toInt();
-        }
-        else if (tag == "newscale")
-        {
-            scaleX = stream->attributes().value("scaleX").toString().toDouble();
-            scaleY = stream->attributes().value("scaleY").toString().toDouble();
-            pivotScale.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotScale.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            scaleX = toReal(attrs.value(QLatin1String("scaleX")));
+            scaleY = toReal(attrs.value(QLatin1String("scaleY")));
+            pivotScale.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotScale.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "rotation")
+        else if (tag == QLatin1String("rotation"))
         {
-            rotation = stream->attributes().value("rotation").toString().toDouble();
-            pivotRotation.rx() = stream->attributes().value("pivotX").toString().toDouble();
-            pivotRotation.ry() = stream->attributes().value("pivotY").toString().toDouble();
+            const QXmlStreamAttributes attrs = stream->attributes();
+            rotation = toReal(attrs.value(QLatin1String("rotation")));
+            pivotRotation.rx() = toReal(attrs.value(QLatin1String("pivotX")));
+            pivotRotation.ry() = toReal(attrs.value(QLatin1String("pivotY")));
             stream->readElementText();
         }
-        else if (tag == "transformation")
-        {
-            m11 = stream->attributes().value("m11").toString().toDouble();
-            m12 = stream->attributes().value("m12").toString().toDouble();
-            m13 = stream->attributes().value("m13").toString().toDouble();
-            m21 = stream->attributes().value("m21").toString().toDouble();
-            m22 = stream->attributes().value("m22").toString().toDouble();
-            m23 = stream->attributes().value("m23").toString().toDouble();
-            m31 = stream->attributes().value("m31").toString().toDouble();
-            m32 = stream->attributes().value("m32").toString().toDouble();
-            m33 = stream->attributes().value("m33").toString().toDouble();
+        else if (tag == QLatin1String("transformation"))
+        {
+            const QXmlStreamAttributes attrs = stream->attributes();
+            m11 = toReal(attrs.value(QLatin1String("m11")));
+            m12 = toReal(attrs.value(QLatin1String("m12")));
+            m13 = toReal(attrs.value(QLatin1String("m13")));
+            m21 = toReal(attrs.value(QLatin1String("m21")));
+            m22 = toReal(attrs.value(QLatin1String("m22")));
+            m23 = toReal(attrs.value(QLatin1String("m23")));
+            m31 = toReal(attrs.value(QLatin1String("m31")));
+            m32 = toReal(attrs.value(QLatin1String("m32")));
+            m33 = toReal(attrs.value(QLatin1String("m33")));
             stream->readElementText();
         }
     }
@@ -699,9 +954,10 @@ File_v2::loadCell(CrochetTab* tab, QXmlStreamReader* stream)
     c->setTransform(transform);
     c->setRotation(angle);
     c->setPos(position);
-    c->setBgColor(QColor(bgColor));
-    c->setColor(QColor(color));
+    c->setBgColor(internColor(bgColor));
+    c->setColor(internColor(color));
     c->setTransformOriginPoint(pivotPoint);
+    countCell(c->name(), c->color(), c->bgColor(), &mStitchCounts, &mColorCounts);
 
     ChartItemTools::setRotation(c, rotation);
     ChartItemTools::setScaleX(c, scaleX);
@@ -716,6 +972,63 @@ File_v2::loadCell(CrochetTab* tab, QXmlStreamReader* stream)
     }
 }
 
+void
+File_v2::saveMetadata(QDataStream* stream)
+{
+    PatternMetadata metadata;
+
+    for (int i = 0; i < mTabWidget->count(); ++i)
+    {
+        CrochetTab* tab = qobject_cast<CrochetTab*>(mTabWidget->widget(i));
+        if (!tab)
+            continue;
+
+        PatternMetadata::Chart chart;
+        chart.name = mTabWidget->tabText(i);
+        chart.style = tab->mChartStyle;
+        chart.size = tab->scene()->itemsBoundingRect().size();
+        metadata.charts.append(chart);
+    }
+
+    metadata.stitches = mMainWindow->patternStitches();
+
+    QMapIterator<QString, QMap<QString, qint64> > i(mMainWindow->patternColors());
+    while (i.hasNext())
+    {
+        i.next();
+        metadata.colors.insert(i.key(), i.value().value("count"));
+    }
+
+    // preview the chart the user is looking at, it's the one that's already loaded.
+    CrochetTab* tab = qobject_cast<CrochetTab*>(mTabWidget->currentWidget());
+    if (tab)
+    {
+        QRectF rect = tab->scene()->itemsBoundingRect();
+        if (!rect.isEmpty())
+        {
+            QSize size = rect.size().toSize();
+            size.scale(FileFactory::previewSize, FileFactory::previewSize, Qt::KeepAspectRatio);
+
+            metadata.preview = QImage(size.expandedTo(QSize(1, 1)), QImage::Format_ARGB32);
+            metadata.preview.fill(Qt::white);
+
+            QPainter p(&metadata.preview);
+            p.setRenderHint(QPainter::Antialiasing);
+            p.setRenderHint(QPainter::SmoothPixmapTransform);
+            tab->scene()->renderItems(&p, tab->scene()->items(Qt::AscendingOrder),
+                                      QRectF(metadata.preview.rect()), rect);
+            p.end();
+        }
+    }
+
+    QByteArray chunk;
+    QDataStream chunkStream(&chunk, QIODevice::WriteOnly);
+    chunkStream.setVersion(QDataStream::Qt_4_7);
+    chunkStream << metadata;
+
+    *stream << chunk;
+}
+
 void
 File_v2::saveCustomStitches(QXmlStreamWriter* stream)
 {
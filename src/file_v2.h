@@ -22,13 +22,16 @@
 #define FINE_V2_H
 
 #include "file.h"
+#include "crochettab.h"
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QColor>
+#include <QHash>
 
 class QDataStream;
-class CrochetTab;
 class Scene;
+class Stitch;
 
 class File_v2 : public File
 {
@@ -38,20 +41,94 @@ public:
     FileFactory::FileError load(QDataStream* stream);
     FileFactory::FileError save(QDataStream* stream);
 
+    /**
+     * locale-free number parser for the attribute values written by QString::number().
+     * Falls back to QStringRef::toDouble() for anything that isn't a plain decimal.
+     */
+    static qreal toReal(const QStringRef& str);
+
 protected:
     void cleanUp();
 
 private:
     void loadColors(QXmlStreamReader* stream);
     void loadChart(QXmlStreamReader* stream);
+    void loadChartContents(CrochetTab* tab, QXmlStreamReader* stream);
+    void finishChart(CrochetTab* tab);
 
     void loadCell(CrochetTab* tab, QXmlStreamReader* stream);
     void loadGrid(QXmlStreamReader* stream, Scene* scene);
     void loadIndicator(CrochetTab* tab, QXmlStreamReader* stream);
     void loadChartImage(CrochetTab* tab, QXmlStreamReader* stream);
 
+    /**
+     * per-load caches so that each colour string is parsed, and each stitch looked up, once.
+     */
+    QColor internColor(const QString& name);
+    Stitch* findStitch(const QString& name);
+
+    /**
+     * add what a cell read from a file adds to the pattern's stitch and colour counts. Both the
+     * charts that are loaded and the ones that are left pending are counted with this.
+     */
+    static void countCell(const QString& stitch,
+                          const QColor& color,
+                          const QColor& bgColor,
+                          QMap<QString, int>* stitches,
+                          QMap<QString, int>* colors);
+
+    /**
+     * write the chunk read by FileFactory::readMetadata().
+     */
+    void saveMetadata(QDataStream* stream);
     void saveCustomStitches(QXmlStreamWriter* stream);
     void saveColors(QXmlStreamWriter* stream);
     bool saveCharts(QXmlStreamWriter* stream);
+
+    QHash<QString, QColor> mColorCache;
+    QHash<QString, Stitch*> mStitchCache;
+
+    // the counts of the chart being loaded, added to its tab once it's loaded.
+    QMap<QString, int> mStitchCounts;
+    QMap<QString, int> mColorCounts;
+
+    friend class PendingChart_v2;
+};
+
+/**
+ * A chart from a v2 file that hasn't been loaded into its scene yet. The chart xml is kept
+ * compressed along with the stitch and colour counts its cells will add to the pattern.
+ */
+class PendingChart_v2 : public PendingChart
+{
+public:
+    PendingChart_v2(MainWindow* mw, FileFactory* parent);
+
+    /**
+     * copy the rest of the current chart element from stream, file is the file it's read by.
+     */
+    void read(QXmlStreamReader* stream, File_v2* file);
+
+    void load(CrochetTab* tab);
+
+    const QMap<QString, int>&
+    stitchCounts() const
+    {
+        return mStitchCounts;
+    }
+    const QMap<QString, int>&
+    colorCounts() const
+    {
+        return mColorCounts;
+    }
+
+private:
+    MainWindow* mMainWindow;
+    FileFactory* mParent;
+
+    QByteArray mData;
+
+    QMap<QString, int> mStitchCounts;
+    QMap<QString, int> mColorCounts;
 };
 #endif  // FINE_V2_H
@@ -30,6 +30,7 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDataStream>
+#include <QBuffer>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -47,7 +48,8 @@
 FileFactory::FileFactory(QWidget* parent)
     : isSaved(false)
     , fileName("")
-    , mFileVersion(FileFactory::Version_1_2)
+    , mCurrentFileVersion(FileFactory::Version_1_3)
+    , mFileVersion(FileFactory::Version_1_3)
     , mParent(parent)
 {
     mMainWindow = static_cast<MainWindow*>(mParent);
@@ -98,12 +100,21 @@ FileFactory::load()
 
     if (version == FileFactory::Version_1_0)
     {
+        // v1.0 files are saved in the current format.
         in.setVersion(QDataStream::Qt_4_7);
         fileLoad = new File_v1(mMainWindow, this);
     }
-    else if (version == FileFactory::Version_1_2)
+    else if (version == FileFactory::Version_1_2 || version == FileFactory::Version_1_3)
     {
+        // save in the format the file was read in, only Save As changes it.
+        mCurrentFileVersion = version;
         in.setVersion(QDataStream::Qt_4_7);
+        // the metadata chunk is only used by readMetadata().
+        if (version == FileFactory::Version_1_3)
+        {
+            QByteArray metadata;
+            in >> metadata;
+        }
         fileLoad = new File_v2(mMainWindow, this);
     }
 
@@ -144,6 +155,7 @@ FileFactory::save(FileVersion version)
     switch (version)
     {
     default:
+    case FileFactory::Version_1_3:
     case FileFactory::Version_1_2:
         saveFile = new File_v2(mMainWindow, this);
         break;
@@ -181,3 +193,84 @@ void
 FileFactory::cleanUp()
 {
 }
+
+PatternMetadata
+FileFactory::readMetadata(const QString& path)
+{
+    PatternMetadata metadata;
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return metadata;
+
+    QDataStream in(&file);
+
+    quint32 magicNumber;
+    qint32 version;
+    in >> magicNumber >> version;
+
+    if (magicNumber != AppInfo::inst()->magicNumber || version < FileFactory::Version_1_3)
+        return metadata;
+
+    in.setVersion(QDataStream::Qt_4_7);
+
+    QByteArray chunk;
+    in >> chunk;
+
+    QDataStream chunkStream(chunk);
+    chunkStream.setVersion(QDataStream::Qt_4_7);
+    chunkStream >> metadata;
+
+    if (chunkStream.status() != QDataStream::Ok)
+        return PatternMetadata();
+
+    return metadata;
+}
+
+QDataStream&
+operator<<(QDataStream& out, const PatternMetadata& metadata)
+{
+    out << (qint32)metadata.charts.count();
+    foreach (const PatternMetadata::Chart& chart, metadata.charts)
+    {
+        out << chart.name << (qint32)chart.style << chart.size;
+    }
+
+    out << metadata.stitches << metadata.colors;
+
+    QByteArray png;
+    if (!metadata.preview.isNull())
+    {
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        metadata.preview.save(&buffer, "PNG");
+    }
+    out << png;
+
+    return out;
+}
+
+QDataStream&
+operator>>(QDataStream& in, PatternMetadata& metadata)
+{
+    qint32 count;
+    in >> count;
+
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        PatternMetadata::Chart chart;
+        qint32 style;
+        in >> chart.name >> style >> chart.size;
+        chart.style = style;
+        metadata.charts.append(chart);
+    }
+
+    in >> metadata.stitches >> metadata.colors;
+
+    QByteArray png;
+    in >> png;
+    if (!png.isEmpty())
+        metadata.preview.loadFromData(png, "PNG");
+
+    return in;
+}
@@ -31,8 +31,40 @@ class QXmlStreamReader;
 class QXmlStreamWriter;
 #endif  // Q_WS_MAC
 
+#include <QImage>
+#include <QMap>
+#include <QSizeF>
 #include <QTableWidget>
 class MainWindow;
+class QDataStream;
+
+/**
+ * Summary of a pattern file. It is stored in a small chunk right after the file version so it
+ * can be read without loading the icons or the charts.
+ */
+struct PatternMetadata
+{
+    struct Chart
+    {
+        QString name;
+        int style;
+        QSizeF size;
+    };
+
+    QList<Chart> charts;
+    QMap<QString, int> stitches;
+    QMap<QString, qint64> colors;
+    QImage preview;
+
+    bool
+    isValid() const
+    {
+        return !charts.isEmpty();
+    }
+};
+
+QDataStream& operator<<(QDataStream& out, const PatternMetadata& metadata);
+QDataStream& operator>>(QDataStream& in, PatternMetadata& metadata);
 
 class FileFactory
 {
@@ -44,6 +76,7 @@ public:
     {
         Version_1_0 = 100,
         Version_1_2 = 102,
+        Version_1_3 = 103,  // Version_1_2 with a metadata chunk.
         Version_Auto = 255
     };
     enum FileError
@@ -89,6 +122,18 @@ public:
 
     void cleanUp();
 
+    /**
+     * @brief readMetadata - read the metadata chunk of a pattern file without loading the
+     * rest of the file.
+     * @return invalid metadata if the file can't be read or was saved without a metadata chunk.
+     */
+    static PatternMetadata readMetadata(const QString& path);
+
+    /**
+     * the longest side of the preview image stored in the metadata chunk.
+     */
+    static const int previewSize = 128;
+
     bool isSaved;
     QString fileName;
 
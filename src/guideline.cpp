@@ -20,29 +20,46 @@
  \****************************************************************************/
 #include "guideline.h"
 
-#include <QDebug>
-#include <QGraphicsSceneMouseEvent>
+#include <QStyleOptionGraphicsItem>
 
-Guideline::Guideline(const QRectF& rect, QGraphicsItem* parent, QGraphicsScene* /*scene*/)
-    : QGraphicsEllipseItem(rect, parent)
+#include "scene.h"
+
+Guideline::Guideline(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
 {
     setAcceptedMouseButtons(Qt::MouseButtons{});
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
-void
-Guideline::mousePressEvent(QGraphicsSceneMouseEvent* event)
+QRectF
+Guideline::boundingRect() const
 {
-    event->ignore();
+    // room for the width of the pen.
+    return mRect.adjusted(-1, -1, 1, 1);
+}
+
+QPainterPath
+Guideline::shape() const
+{
+    return QPainterPath();
 }
 
 void
-Guideline::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
+Guideline::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-    event->ignore();
+    Q_UNUSED(widget);
+
+    Scene* s = qobject_cast<Scene*>(scene());
+    if (s)
+        s->drawGuidelines(painter, option->exposedRect);
 }
 
 void
-Guideline::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
+Guideline::setRect(const QRectF& rect)
 {
-    event->ignore();
+    if (rect == mRect)
+        return;
+
+    prepareGeometryChange();
+    mRect = rect;
 }
@@ -21,12 +21,18 @@
 #ifndef GUIDELINE_H
 #define GUIDELINE_H
 
-#include <QGraphicsEllipseItem>
-
-class Guideline : public QGraphicsEllipseItem
+#include <QGraphicsItem>
+
+/**
+ * All the guidelines of a scene as one item, drawn by Scene::drawGuidelines.
+ *
+ * Only the lines that cross the exposed part of the item are drawn. The item has no shape so
+ * clicks and rubber band selections go to the items under it.
+ */
+class Guideline : public QGraphicsItem
 {
 public:
-    explicit Guideline(const QRectF& rect, QGraphicsItem* parent = nullptr, QGraphicsScene* scene = nullptr);
+    explicit Guideline(QGraphicsItem* parent = nullptr);
 
     enum
     {
@@ -39,10 +45,17 @@ public:
         return Guideline::Type;
     }
 
-protected:
-    void mousePressEvent(QGraphicsSceneMouseEvent* event);
-    void mouseMoveEvent(QGraphicsSceneMouseEvent* event);
-    void mouseReleaseEvent(QGraphicsSceneMouseEvent* event);
+    QRectF boundingRect() const;
+    QPainterPath shape() const;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+
+    /**
+     * the area covered by the guidelines, in scene coordinates.
+     */
+    void setRect(const QRectF& rect);
+
+private:
+    QRectF mRect;
 };
 
 #endif  // GUIDELINE_H
@@ -25,6 +25,7 @@
 #include <QPainter>
 #include "settings.h"
 #include <QStyleOption>
+#include <QStyleOptionGraphicsItem>
 #include <QKeyEvent>
 #include <QGraphicsSceneEvent>
 #include <QTextCursor>
@@ -36,20 +37,39 @@
 #include "crochetchartcommands.h"
 #include "ChartItemTools.h"
 
+#include <QtMath>
+
+// indicators that would be bigger than this on screen, in pixels, aren't cached.
+#define INDICATOR_CACHE_MAX_SIZE 2048
+
 Indicator::Indicator(QGraphicsItem* parent, QGraphicsScene* /*scene*/)
     : QGraphicsTextItem(parent)
     , highlight(false)
+    , mCacheScale(0)
 {
     setFlag(QGraphicsItem::ItemIsMovable);
     setFlag(QGraphicsItem::ItemIsSelectable);
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges);
     setFlag(QGraphicsItem::ItemIsFocusable);
     setZValue(150);
 
     mStyle = Settings::inst()->value("chartRowIndicator").toString();
+
+    document()->setDocumentMargin(10);
+    connect(document(), SIGNAL(contentsChanged()), SLOT(invalidateCache()));
 }
 
 Indicator::~Indicator()
 {
+    // deleting the item takes it out of its scene.
+    Scene::trackSelection(this, ItemSceneChange, QVariant());
+}
+
+QVariant
+Indicator::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    Scene::trackSelection(this, change, value);
+    return QGraphicsTextItem::itemChange(change, value);
 }
 
 QRectF
@@ -78,19 +98,82 @@ Indicator::setText(QString t)
     setPlainText(t);
 }
 
+void
+Indicator::setFont(const QFont& font)
+{
+    QGraphicsTextItem::setFont(font);
+    invalidateCache();
+}
+
+void
+Indicator::invalidateCache()
+{
+    mCache = QPixmap();
+}
+
 void
 Indicator::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
     QString color = Settings::inst()->value("chartIndicatorColor").toString();
 
+    // the indicator that's being edited or is selected changes as it's painted.
+    if (option->state & (QStyle::State_HasFocus | QStyle::State_Selected))
+    {
+        paintIndicator(painter, option, widget, color);
+        return;
+    }
+
+    QRectF rect = boundingRect();
+    qreal scale = qSqrt(qAbs(painter->worldTransform().determinant()))
+                  * painter->device()->devicePixelRatioF();
+    QSize size = (rect.size() * scale).toSize();
+
+    // printers and pictures keep the text as text.
+    int device = painter->device()->devType();
+    if (device == QInternal::Picture || device == QInternal::Printer || size.isEmpty()
+        || size.width() > INDICATOR_CACHE_MAX_SIZE || size.height() > INDICATOR_CACHE_MAX_SIZE)
+    {
+        paintIndicator(painter, option, widget, color);
+        return;
+    }
+
+    if (mCache.isNull() || mCacheScale != scale || mCacheColor != color)
+    {
+        mCache = QPixmap(size);
+        mCache.fill(Qt::transparent);
+
+        QStyleOptionGraphicsItem opt(*option);
+        opt.exposedRect = rect;
+        opt.rect = rect.toAlignedRect();
+
+        QPainter p(&mCache);
+        p.scale(size.width() / rect.width(), size.height() / rect.height());
+        p.translate(-rect.topLeft());
+        paintIndicator(&p, &opt, widget, color);
+        p.end();
+
+        mCacheScale = scale;
+        mCacheColor = color;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(rect, mCache, QRectF(mCache.rect()));
+    painter->restore();
+}
+
+void
+Indicator::paintIndicator(QPainter* painter,
+                          const QStyleOptionGraphicsItem* option,
+                          QWidget* widget,
+                          const QString& color)
+{
     if (option->state & QStyle::State_HasFocus)
     {
         QGraphicsTextItem::paint(painter, option, widget);
     }
     else
     {
-        document()->setDocumentMargin(10);
-
         if (mStyle == "Dots" || mStyle == "Dots and Text")
         {
             painter->setRenderHint(QPainter::Antialiasing);
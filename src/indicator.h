@@ -24,6 +24,7 @@
 #include <QGraphicsTextItem>
 
 #include <QLineEdit>
+#include <QPixmap>
 
 class QFocusEvent;
 class QGraphicsItem;
@@ -88,9 +89,12 @@ public:
     setStyle(QString style)
     {
         mStyle = style;
+        invalidateCache();
         update();
     }
 
+    void setFont(const QFont& font);
+
     QPainterPath shape() const;
 
     bool highlight;
@@ -110,13 +114,25 @@ signals:
     void lostFocus(Indicator* item);
     void gotFocus(Indicator* item);
 
+private slots:
+    void invalidateCache();
+
 protected:
     void focusInEvent(QFocusEvent* event);
     void focusOutEvent(QFocusEvent* event);
     void keyReleaseEvent(QKeyEvent* event);
     void mouseReleaseEvent(QGraphicsSceneMouseEvent* event);
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value);
 
 private:
+    /**
+     * draw the dot and the text straight from the document.
+     */
+    void paintIndicator(QPainter* painter,
+                        const QStyleOptionGraphicsItem* option,
+                        QWidget* widget,
+                        const QString& color);
+
     // the layer of the indicator
     unsigned int mLayer;
 
@@ -125,5 +141,10 @@ private:
 
     QString mStyle;
     QString oldText;
+
+    // the indicator as it was last painted, at mCacheScale device pixels per unit.
+    QPixmap mCache;
+    qreal mCacheScale;
+    QString mCacheColor;
 };
 #endif  // INDICATOR_H
@@ -22,6 +22,7 @@
 #include <QPainter>
 #include <QGraphicsSceneEvent>
 #include "ChartItemTools.h"
+#include "scene.h"
 #include "debug.h"
 
 ItemGroup::ItemGroup(QGraphicsItem* parent, QGraphicsScene* /*scene*/)
@@ -35,11 +36,21 @@ ItemGroup::ItemGroup(QGraphicsItem* parent, QGraphicsScene* /*scene*/)
 
     setFlag(QGraphicsItem::ItemIsMovable);
     setFlag(QGraphicsItem::ItemIsSelectable);
+    setFlag(QGraphicsItem::ItemSendsGeometryChanges);
     setHandlesChildEvents(true);
 }
 
 ItemGroup::~ItemGroup()
 {
+    // deleting the item takes it out of its scene.
+    Scene::trackSelection(this, ItemSceneChange, QVariant());
+}
+
+QVariant
+ItemGroup::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    Scene::trackSelection(this, change, value);
+    return QGraphicsItemGroup::itemChange(change, value);
 }
 
 QRectF
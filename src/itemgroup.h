@@ -57,6 +57,9 @@ public:
         mLayer = layer;
     }
 
+protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant& value);
+
 private:
     // the layer of the group
     unsigned int mLayer;
@@ -36,11 +36,16 @@
 
 #include "stitchreplacerui.h"
 #include "colorreplacer.h"
+#include "chartexportjob.h"
+#include "charttiler.h"
+#include "chartsnapshot.h"
 
 #include "debug.h"
 #include <QDialog>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QGridLayout>
+#include <QLabel>
 #include <QInputDialog>
 #include <QColorDialog>
 #include <QStandardItemModel>
@@ -49,6 +54,9 @@
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QPrintPreviewDialog>
+#include <QProgressDialog>
+#include <QEventLoop>
+#include <QPainter>
 
 #include <QActionGroup>
 #include <QCloseEvent>
@@ -68,6 +76,8 @@ MainWindow::MainWindow(QStringList fileNames, QWidget* parent)
     , mRowsDock(0)
     , mMirrorDock(0)
     , mPropertiesDock(0)
+    , mPrintPreview(false)
+    , mPreviewPages(64 * 1024)
     , mEditMode(10)
     , mStitch("ch")
     , mFgColor(QColor(Qt::black))
@@ -413,7 +423,12 @@ MainWindow::setupStitchPalette()
     connect(ui->allStitches, SIGNAL(clicked(QModelIndex)), SLOT(selectStitch(QModelIndex)));
     connect(ui->patternStitches, SIGNAL(clicked(QModelIndex)), SLOT(selectStitch(QModelIndex)));
 
+    connect(ui->patternStitches, SIGNAL(doubleClicked(QModelIndex)),
+            SLOT(selectStitchCells(QModelIndex)));
+
     connect(ui->patternColors, SIGNAL(clicked(QModelIndex)), SLOT(selectColor(QModelIndex)));
+    connect(ui->patternColors, SIGNAL(doubleClicked(QModelIndex)),
+            SLOT(selectColorCells(QModelIndex)));
     connect(ui->fgColor, SIGNAL(colorChanged(QColor)), SLOT(addColor(QColor)));
     connect(ui->bgColor, SIGNAL(colorChanged(QColor)), SLOT(addColor(QColor)));
     connect(ui->patternColors, SIGNAL(bgColorSelected(QModelIndex)),
@@ -717,6 +732,10 @@ MainWindow::setupRecentFiles()
 
         a->setText(text);
         a->setData(files[i]);
+
+        PatternMetadata metadata = FileFactory::readMetadata(files[i]);
+        if (!metadata.preview.isNull())
+            a->setIcon(QIcon(QPixmap::fromImage(metadata.preview)));
         if (i < maxRecentFiles)
             a->setVisible(true);
         else
@@ -758,37 +777,149 @@ MainWindow::filePrint()
 void
 MainWindow::print(QPrinter* printer)
 {
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+    if (Settings::inst()->value("printTiled").toBool())
+    {
+        printTiled(printer);
+        return;
+    }
 
-    int tabCount = ui->tabWidget->count();
-    QPainter* p = new QPainter();
+    ChartExportJob job;
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+        job.addPage(printSnapshot(i));
 
-    p->begin(printer);
+    QProgressDialog progress(tr("Preparing the pages..."), tr("Cancel"), 0, job.pageCount(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+    connect(&job, SIGNAL(progress(int, int)), &progress, SLOT(setValue(int)));
+    connect(&progress, SIGNAL(canceled()), &job, SLOT(cancel()));
 
-    bool firstPass = true;
-    for (int i = 0; i < tabCount; ++i)
+    // the pages are rendered on the thread pool, the printer is only used from this thread.
+    QEventLoop loop;
+    connect(&job, SIGNAL(finished(bool)), &loop, SLOT(quit()));
+    job.renderPictures(QRect(QPoint(0, 0), printer->pageRect().size()));
+    loop.exec();
+
+    if (job.isCanceled())
+        return;
+
+    QPainter p;
+    if (!p.begin(printer))
+        return;
+
+    for (int i = 0; i < job.pageCount(); ++i)
     {
-        if (!firstPass)
+        if (i > 0)
             printer->newPage();
+        p.drawPicture(0, 0, job.picture(i));
+    }
+    p.end();
+}
 
-        CrochetTab* tab = qobject_cast<CrochetTab*>(ui->tabWidget->widget(i));
-        tab->renderChart(p);
-        firstPass = false;
+void
+MainWindow::printTiled(QPrinter* printer)
+{
+    int resolution = printer->resolution();
+    QRect pageRect(QPoint(0, 0), printer->pageRect().size());
+    qreal scale = ChartTiler::scaleFor(resolution,
+                                       Settings::inst()->value("printStitchSize").toInt(),
+                                       Settings::inst()->value("cellWidth").toInt());
+    int overlap = qRound(Settings::inst()->value("printOverlap").toInt() / 25.4 * resolution);
+
+    QList<ChartTiler> tilers;
+    int pageCount = 0;
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+    {
+        tilers.append(ChartTiler(printSnapshot(i), ui->tabWidget->tabText(i), pageRect,
+                                 resolution, scale, overlap));
+        pageCount += tilers.last().pageCount();
     }
-    p->end();
 
-    QApplication::restoreOverrideCursor();
+    QProgressDialog progress(tr("Printing..."), tr("Cancel"), 0, pageCount, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    QPainter p;
+    if (!p.begin(printer))
+        return;
+
+    // pages are painted straight into the printer one at a time, only the preview keeps them.
+    int done = 0;
+    for (int i = 0; i < tilers.count(); ++i)
+    {
+        const ChartTiler& tiler = tilers.at(i);
+        for (int page = 0; page < tiler.pageCount(); ++page)
+        {
+            if (progress.wasCanceled())
+            {
+                printer->abort();
+                return;
+            }
+
+            if (done > 0)
+                printer->newPage();
+
+            if (mPrintPreview)
+            {
+                QString key = QString("%1/%2/%3x%4/%5/%6/%7")
+                                  .arg(i)
+                                  .arg(page)
+                                  .arg(pageRect.width())
+                                  .arg(pageRect.height())
+                                  .arg(resolution)
+                                  .arg(scale)
+                                  .arg(overlap);
+
+                QPicture* picture = mPreviewPages.object(key);
+                if (picture)
+                {
+                    p.drawPicture(0, 0, *picture);
+                }
+                else
+                {
+                    // the cache deletes a page that's too big to keep, draw it before it's added.
+                    picture = new QPicture(tiler.picture(page));
+                    p.drawPicture(0, 0, *picture);
+                    mPreviewPages.insert(key, picture, qMax(1, int(picture->size() / 1024)));
+                }
+            }
+            else
+            {
+                tiler.paintPage(&p, page);
+            }
+
+            progress.setValue(++done);
+        }
+    }
+    p.end();
+}
+
+QSharedPointer<ChartSnapshot>
+MainWindow::printSnapshot(int tab)
+{
+    if (mPrintPreview && mPreviewCharts.contains(tab))
+        return mPreviewCharts.value(tab);
+
+    CrochetTab* t = qobject_cast<CrochetTab*>(ui->tabWidget->widget(tab));
+    QSharedPointer<ChartSnapshot> snapshot = t->snapshot();
+
+    if (mPrintPreview)
+        mPreviewCharts.insert(tab, snapshot);
+    return snapshot;
 }
 
 void
 MainWindow::filePrintPreview()
 {
-    // FIXME: this isn't working
-    QPrinter* printer = new QPrinter(QPrinter::HighResolution);
-    QPrintPreviewDialog* dialog = new QPrintPreviewDialog(printer, this);
-    connect(dialog, SIGNAL(paintRequested(QPrinter*)), this, SLOT(print(QPrinter*)));
+    QPrinter printer(QPrinter::HighResolution);
+    QPrintPreviewDialog dialog(&printer, this);
+    connect(&dialog, SIGNAL(paintRequested(QPrinter*)), this, SLOT(print(QPrinter*)));
+
+    mPrintPreview = true;
+    dialog.exec();
 
-    dialog->exec();
+    mPrintPreview = false;
+    mPreviewPages.clear();
+    mPreviewCharts.clear();
 }
 
 void
@@ -879,6 +1010,26 @@ MainWindow::selectColor(QModelIndex index)
     }
 }
 
+void
+MainWindow::selectStitchCells(QModelIndex index)
+{
+    QString stitch = index.data(Qt::DisplayRole).toString();
+    if (stitch.isEmpty() || !curCrochetTab())
+        return;
+
+    curCrochetTab()->selectStitch(stitch);
+}
+
+void
+MainWindow::selectColorCells(QModelIndex index)
+{
+    QString color = index.data(Qt::ToolTipRole).toString();
+    if (color.isEmpty() || !curCrochetTab())
+        return;
+
+    curCrochetTab()->selectColor(QColor(color));
+}
+
 void
 MainWindow::filterStitchList(QString newText)
 {
@@ -1179,9 +1330,78 @@ MainWindow::fileOpen()
     fd->setViewMode(QFileDialog::List);
     fd->setFileMode(QFileDialog::ExistingFile);
     fd->setAcceptMode(QFileDialog::AcceptOpen);
+
+    // show the preview stored in the file's metadata next to the file list, the native
+    // dialogs can't be extended so Qt's own dialog is used for it.
+    QGridLayout* layout = nullptr;
+    if (Settings::inst()->value("showFilePreview").toBool())
+    {
+        fd->setOption(QFileDialog::DontUseNativeDialog);
+        layout = qobject_cast<QGridLayout*>(fd->layout());
+    }
+    if (layout)
+    {
+        QLabel* preview = new QLabel(fd);
+        preview->setObjectName("filepreview");
+        preview->setAlignment(Qt::AlignCenter);
+        preview->setWordWrap(true);
+        preview->setMinimumSize(FileFactory::previewSize, FileFactory::previewSize);
+        layout->addWidget(preview, 0, layout->columnCount(), layout->rowCount(), 1);
+        connect(fd, SIGNAL(currentChanged(QString)), SLOT(updateFilePreview(QString)));
+    }
+
     fd->open(this, SLOT(loadFile(QString)));
 }
 
+void
+MainWindow::updateFilePreview(QString fileName)
+{
+    QFileDialog* fd = qobject_cast<QFileDialog*>(sender());
+    if (!fd)
+        return;
+
+    QLabel* preview = fd->findChild<QLabel*>("filepreview");
+    if (!preview)
+        return;
+
+    preview->clear();
+    preview->setToolTip("");
+
+    PatternMetadata metadata = FileFactory::readMetadata(fileName);
+    if (!metadata.isValid())
+        return;
+
+    QStringList charts;
+    foreach (const PatternMetadata::Chart& chart, metadata.charts)
+    {
+        charts.append(tr("%1 (%2 x %3)")
+                          .arg(chart.name)
+                          .arg(qRound(chart.size.width()))
+                          .arg(qRound(chart.size.height())));
+    }
+
+    int stitchCount = 0;
+    foreach (int count, metadata.stitches)
+    {
+        stitchCount += count;
+    }
+
+    QString summary = tr("%1\n%2 stitches, %3 colors")
+                          .arg(charts.join("\n"))
+                          .arg(stitchCount)
+                          .arg(metadata.colors.count());
+
+    if (metadata.preview.isNull())
+    {
+        preview->setText(summary);
+    }
+    else
+    {
+        preview->setPixmap(QPixmap::fromImage(metadata.preview));
+        preview->setToolTip(summary);
+    }
+}
+
 void
 MainWindow::loadFile(QString fileName)
 {
@@ -1269,9 +1489,9 @@ MainWindow::fileSaveAs()
 {
     QString fileLoc = Settings::inst()->value("fileLocation").toString();
 
-    QFileDialog* fd
-        = new QFileDialog(this, tr("Save Pattern File"), fileLoc,
-                          tr("Pattern v1.2 (*.pattern);;Pattern v1.0/v1.1 (*.pattern)"));
+    QFileDialog* fd = new QFileDialog(this, tr("Save Pattern File"), fileLoc,
+                                      tr("Pattern v1.3 (*.pattern);;Pattern v1.2 (*.pattern);;"
+                                         "Pattern v1.0/v1.1 (*.pattern)"));
     fd->setWindowFlags(Qt::Sheet);
     fd->setObjectName("filesavedialog");
     fd->setViewMode(QFileDialog::List);
@@ -1295,8 +1515,10 @@ MainWindow::saveFileAs(QString fileName)
 
     QFileDialog* fd = qobject_cast<QFileDialog*>(sender());
 
-    FileFactory::FileVersion fver = FileFactory::Version_1_2;
-    if (fd->selectedNameFilter() == "Pattern v1.0/v1.1 (*.pattern)")
+    FileFactory::FileVersion fver = FileFactory::Version_1_3;
+    if (fd->selectedNameFilter() == "Pattern v1.2 (*.pattern)")
+        fver = FileFactory::Version_1_2;
+    else if (fd->selectedNameFilter() == "Pattern v1.0/v1.1 (*.pattern)")
         fver = FileFactory::Version_1_0;
 
     if (!fileName.endsWith(".pattern", Qt::CaseInsensitive))
@@ -1572,7 +1794,7 @@ MainWindow::createTab(Scene::ChartStyle style)
     tab->setPatternColors(&mPatternColors);
 
     connect(tab, SIGNAL(chartStitchChanged()), SLOT(updatePatternStitches()));
-    connect(tab, SIGNAL(chartColorChanged()), SLOT(updatePatternColors()));
+    connect(tab, SIGNAL(patternColorsChanged()), SLOT(updatePatternColors()));
     connect(tab, SIGNAL(chartColorChanged()), mPropertiesDock, SLOT(propertyUpdated()));
     connect(tab, SIGNAL(tabModified(bool)), SLOT(documentIsModified(bool)));
     connect(tab, SIGNAL(guidelinesUpdated(Guidelines)), SLOT(updateGuidelines(Guidelines)));
@@ -1910,6 +2132,9 @@ MainWindow::tabChanged(int newTab)
     if (!tab)
         return;
 
+    // charts that weren't visible when the file was opened are loaded when first shown.
+    tab->loadPendingChart();
+
     mUndoGroup.setActiveStack(tab->undoStack());
 }
 
@@ -2057,10 +2282,7 @@ MainWindow::updatePatternStitches()
         if (items.count() == 0)
         {
             Stitch* s = StitchLibrary::inst()->findStitch(i.key(), true);
-            QPixmap pix = QPixmap(QSize(32, 32));
-
-            pix.load(s->file());
-            QIcon icon = QIcon(pix);
+            QIcon icon = s->icon();
             QListWidgetItem* item = new QListWidgetItem(icon, i.key(), ui->patternStitches);
             ui->patternStitches->addItem(item);
         }
@@ -37,10 +37,14 @@
 #include <QSortFilterProxyModel>
 
 #include <QModelIndex>
+#include <QCache>
+#include <QPicture>
+#include <QSharedPointer>
 
 #include "scene.h"
 
 class CrochetTab;
+class ChartSnapshot;
 class QPrinter;
 class QPainter;
 class QActionGroup;
@@ -57,6 +61,8 @@ class MainWindow : public QMainWindow
     friend class File;
     friend class File_v1;
     friend class File_v2;
+    friend class TestFile_v2;
+    friend class BenchChart;
 
 public:
     explicit MainWindow(QStringList fileNames = QStringList(), QWidget* parent = nullptr);
@@ -99,6 +105,7 @@ private slots:
     void menuRecentFilesAboutToShow();
     void fileNew();
     void fileOpen();
+    void updateFilePreview(QString fileName);
     void fileSave();
     void fileSaveAs();
     void fileExport();
@@ -180,6 +187,12 @@ private slots:
     void selectStitch(QModelIndex index);
     void selectColor(QModelIndex index);
 
+    /**
+     * select the cells in the current chart with the stitch or colour that was double clicked.
+     */
+    void selectStitchCells(QModelIndex index);
+    void selectColorCells(QModelIndex index);
+
     void filterStitchList(QString newText);
     void clearStitchFilter();
 
@@ -222,6 +235,15 @@ private:
 
     void setApplicationTitle();
 
+    /**
+     * print the charts across as many pages as they need at the stitch size from the settings.
+     */
+    void printTiled(QPrinter* printer);
+    /**
+     * a snapshot of the chart in tab, reused for as long as the print preview is open.
+     */
+    QSharedPointer<ChartSnapshot> printSnapshot(int tab);
+
     CrochetTab* curCrochetTab();
 
     Ui::MainWindow* ui;
@@ -286,6 +308,11 @@ private:
 
     PropertiesDock* mPropertiesDock;
 
+    // the print preview asks for every page again whenever its settings change.
+    bool mPrintPreview;
+    QCache<QString, QPicture> mPreviewPages;
+    QMap<int, QSharedPointer<ChartSnapshot> > mPreviewCharts;
+
     int mEditMode;
     QString mStitch;
     QColor mFgColor;
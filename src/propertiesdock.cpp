@@ -62,6 +62,11 @@ PropertiesDock::PropertiesDock(QTabWidget* tabWidget, QWidget* parent)
     clearUi();
     connect(mTabWidget, SIGNAL(currentChanged(int)), SLOT(tabChanged(int)));
 
+    // a rubber band selection changes many times a frame, only the last one is shown.
+    mUpdateTimer.setSingleShot(true);
+    mUpdateTimer.setInterval(16);
+    connect(&mUpdateTimer, SIGNAL(timeout()), SLOT(updateDialogUi()));
+
     connect(ui->gen_angle, SIGNAL(valueChanged(double)), SLOT(cellUpdateAngle(double)));
     connect(ui->ig_scale, SIGNAL(valueChanged(double)), SLOT(itemGroupUpdateScale(double)));
     connect(ui->gen_scaleX, SIGNAL(valueChanged(double)), SLOT(cellUpdateScaleX(double)));
@@ -143,14 +148,20 @@ PropertiesDock::loadProperties(Guidelines guidelines)
 void
 PropertiesDock::tabChanged(int tabNumber)
 {
+    mUpdateTimer.stop();
+    if (mScene)
+        disconnect(mScene, SIGNAL(selectionChanged()), this, SLOT(scheduleUpdate()));
+
     if (tabNumber == -1)
     {
+        // the last tab is gone, and its scene with it.
+        mScene = nullptr;
         clearUi();
         return;
     }
 
     mScene = qobject_cast<CrochetTab*>(mTabWidget->widget(tabNumber))->scene();
-    connect(mScene, SIGNAL(selectionChanged()), SLOT(updateDialogUi()));
+    connect(mScene, SIGNAL(selectionChanged()), SLOT(scheduleUpdate()), Qt::UniqueConnection);
     updateDialogUi();
 }
 
@@ -168,7 +179,7 @@ PropertiesDock::setupStitchCombo()
     foreach (QString stitch, StitchLibrary::inst()->stitchList())
     {
         Stitch* s = StitchLibrary::inst()->findStitch(stitch);
-        ui->st_stitch->addItem(QIcon(s->file()), stitch);
+        ui->st_stitch->addItem(s->icon(), stitch);
     }
 }
 
@@ -213,125 +224,30 @@ PropertiesDock::updateGuidelines()
 PropertiesData
 PropertiesDock::selectionProperties()
 {
-    PropertiesData props;
-    bool firstPass = true;
-
-    bool angleMixed = false, xScaleMixed = false, yScaleMixed = false, xPositionMixed = false,
-         yPositionMixed = false, stitchMixed = false, colorMixed = false, bgColorMixed = false;
-
-    foreach (QGraphicsItem* i, mScene->selectedItems())
-    {
-        Cell* c = nullptr;
-        ItemGroup* g = nullptr;
-        Indicator* ind = nullptr;
-        QGraphicsEllipseItem* cc = nullptr;  // ChartCenter
-        ChartImage* ci = nullptr;
-        if (i->type() == Cell::Type)
-        {
-            c = qgraphicsitem_cast<Cell*>(i);
-        }
-        else if (i->type() == ItemGroup::Type)
-        {
-            g = qgraphicsitem_cast<ItemGroup*>(i);
-        }
-        else if (i->type() == Indicator::Type)
-        {
-            ind = qgraphicsitem_cast<Indicator*>(i);
-        }
-        else if (i->type() == QGraphicsEllipseItem::Type)
-        {
-            cc = qgraphicsitem_cast<QGraphicsEllipseItem*>(i);
-        }
-        else if (i->type() == ChartImage::Type)
-        {
-            ci = qgraphicsitem_cast<ChartImage*>(i);
-        }
-
-        if (firstPass)
-        {
-            props.angle = ChartItemTools::getRotation(i);
-            props.scale = ChartItemTools::getScale(i);
-            props.position.setX(i->pos().x());
-            props.position.setY(i->pos().y());
-
-            if (c)
-            {
-                props.stitch = c->name();
-                props.color = c->color();
-                props.bgColor = c->bgColor();
-            }
-
-            firstPass = false;
-        }
-
-        if (!c)
-            continue;
-
-        if (props.angle != ChartItemTools::getRotation(c))
-            angleMixed = true;
-        if (props.scale.x() != ChartItemTools::getScaleX(i))
-            xScaleMixed = true;
-        if (props.scale.y() != ChartItemTools::getScaleY(i))
-            yScaleMixed = true;
-        if (props.position.x() != c->pos().x())
-            xPositionMixed = true;
-        if (props.position.y() != c->pos().y())
-            yPositionMixed = true;
-        if (props.stitch != c->name())
-            stitchMixed = true;
-        if (props.color != c->color())
-            colorMixed = true;
-        if (props.bgColor != c->bgColor())
-            bgColorMixed = true;
-    }
-
-    if (angleMixed)
-        props.angle = 0.0;
-    if (xScaleMixed)
-        props.scale.setX(1.0);
-    if (yScaleMixed)
-        props.scale.setY(1.0);
-    if (xPositionMixed)
-        props.position.setX(0.0);
-    if (yPositionMixed)
-        props.position.setY(0.0);
-    if (stitchMixed)
-        props.stitch = "";
-    if (colorMixed)
-        props.color = QColor();
-    if (bgColorMixed)
-        props.bgColor = QColor();
-
-    return props;
+    return mScene->selectionProperties().properties();
 }
 
 void
 PropertiesDock::updateDialogUi()
 {
     clearUi();
-    setEnabled(mScene != nullptr);
+    setEnabled(!mScene.isNull());
 
     if (closing || !mScene)
         return;
 
-    const auto count = mScene->selectedItems().count();
+    const auto count = mScene->selectionCount();
     if (count == 0)
     {
         showUi(PropertiesDock::SceneUi);
     }
     else if (count >= 1)
     {
-        bool theSame = true;
-        QList<QGraphicsItem*> selection = mScene->selectedItems();
-        int firstType = selection.first()->type();
-        for (int i = 1; i < count; ++i)
-        {
-            if (firstType != selection.at(i)->type())
-            {
-                theSame = false;
-                break;
-            }
-        }
+        // the chart center isn't a chart item, it's not counted in the selection properties.
+        int firstType = mScene->selectionProperties().type();
+        if (mScene->chartCenter() && mScene->chartCenter()->isSelected())
+            firstType = count == 1 ? int(QGraphicsEllipseItem::Type) : 0;
+        bool theSame = firstType != 0;
 
         if (!theSame)
         {
@@ -453,7 +369,7 @@ PropertiesDock::showSingleChartImage()
     ui->gen_scaleY->setValue(p.scale.y());
     ui->gen_scaleY->blockSignals(false);
 
-    ChartImage* i = qgraphicsitem_cast<ChartImage*>(mScene->selectedItems().first());
+    ChartImage* i = qgraphicsitem_cast<ChartImage*>(mScene->selectionProperties().item());
 
     ui->ci_path->blockSignals(true);
     ui->ci_path->setText(i->filename());
@@ -544,7 +460,7 @@ PropertiesDock::showSingleIndicator()
     ui->gen_scaleY->setValue(p.scale.y());
     ui->gen_scaleY->blockSignals(false);
 
-    Indicator* i = qgraphicsitem_cast<Indicator*>(mScene->selectedItems().first());
+    Indicator* i = qgraphicsitem_cast<Indicator*>(mScene->selectionProperties().item());
     // ui->ind_indicatorTextEdit->setText(i->text());
     ui->ind_indicatorStyle->blockSignals(true);
     ui->ind_indicatorStyle->setCurrentIndex(ui->ind_indicatorStyle->findText(i->style()));
@@ -713,7 +629,14 @@ PropertiesDock::chartUpdateGuidelines()
 void
 PropertiesDock::propertyUpdated()
 {
-    updateDialogUi();
+    scheduleUpdate();
+}
+
+void
+PropertiesDock::scheduleUpdate()
+{
+    if (!mUpdateTimer.isActive())
+        mUpdateTimer.start();
 }
 
 /**
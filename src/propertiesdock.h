@@ -22,7 +22,9 @@
 #define PROPERTIESDOCK_H
 
 #include <QDockWidget>
+#include <QPointer>
 #include <QTabWidget>
+#include <QTimer>
 #include "scene.h"
 
 #include "debug.h"
@@ -60,6 +62,11 @@ public:
 public slots:
     void propertyUpdated();
 
+    /**
+     * update the dock at the next frame, any other requests before then are merged into it.
+     */
+    void scheduleUpdate();
+
 signals:
     void propertiesUpdated(QString property, QVariant newValue);
     void setGridType(QString type);
@@ -124,8 +131,11 @@ private:
     Ui::PropertiesDock* ui = nullptr;
 
     QTabWidget* mTabWidget = nullptr;
-    Scene* mScene = nullptr;
+    // the scene goes with its tab, which can be deleted before the tab change is seen.
+    QPointer<Scene> mScene;
     Guidelines mGuidelines;
+
+    QTimer mUpdateTimer;
 };
 
 #endif  // PROPERTIESDOCK_H
@@ -0,0 +1,308 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "repeatfinder.h"
+
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+/**
+ * A suffix array over a sequence with a sparse table of its lcp array for range minimum
+ * queries.
+ */
+class RepeatFinder::Index
+{
+public:
+    explicit Index(const QVector<int>& s)
+        : mLength(s.count())
+    {
+        int n = mLength;
+        if (n == 0)
+            return;
+
+        // sort the suffixes by doubling the length of the prefix compared each pass.
+        QVector<int> sa(n), rank(n), tmp(n);
+        for (int i = 0; i < n; ++i)
+        {
+            sa[i] = i;
+            rank[i] = s[i];
+        }
+
+        for (int k = 1;; k <<= 1)
+        {
+            auto key = [&rank, n, k](int i) {
+                return qMakePair(rank[i], i + k < n ? rank[i + k] : -1);
+            };
+            std::sort(sa.begin(), sa.end(), [&key](int a, int b) { return key(a) < key(b); });
+
+            tmp[sa[0]] = 0;
+            for (int i = 1; i < n; ++i)
+                tmp[sa[i]] = tmp[sa[i - 1]] + (key(sa[i - 1]) < key(sa[i]) ? 1 : 0);
+            rank = tmp;
+
+            if (rank[sa[n - 1]] == n - 1)
+                break;
+        }
+        mRank = rank;
+
+        // Kasai's algorithm, lcp[r] is the common prefix of the suffixes ranked r - 1 and r.
+        QVector<int> lcp(n, 0);
+        int h = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (rank[i] == 0)
+            {
+                h = 0;
+                continue;
+            }
+
+            int j = sa[rank[i] - 1];
+            while (i + h < n && j + h < n && s[i + h] == s[j + h])
+                ++h;
+            lcp[rank[i]] = h;
+            if (h > 0)
+                --h;
+        }
+
+        mLog = QVector<int>(n + 1, 0);
+        for (int i = 2; i <= n; ++i)
+            mLog[i] = mLog[i / 2] + 1;
+
+        mTable.append(lcp);
+        for (int k = 1; (1 << k) <= n; ++k)
+        {
+            const QVector<int>& prev = mTable.last();
+            QVector<int> level(n - (1 << k) + 1);
+            for (int i = 0; i < level.count(); ++i)
+                level[i] = qMin(prev[i], prev[i + (1 << (k - 1))]);
+            mTable.append(level);
+        }
+    }
+
+    int
+    lce(int i, int j) const
+    {
+        if (i < 0 || j < 0 || i >= mLength || j >= mLength)
+            return 0;
+        if (i == j)
+            return mLength - i;
+
+        int a = qMin(mRank[i], mRank[j]) + 1;
+        int b = qMax(mRank[i], mRank[j]);
+        int k = mLog[b - a + 1];
+        return qMin(mTable[k][a], mTable[k][b - (1 << k) + 1]);
+    }
+
+private:
+    int mLength;
+    QVector<int> mRank;
+    QVector<int> mLog;
+    QVector<QVector<int> > mTable;
+};
+
+RepeatFinder::RepeatFinder(const QVector<int>& sequence)
+    : mSequence(sequence)
+    , mForward(new Index(sequence))
+{
+    QVector<int> reversed(sequence.count());
+    std::reverse_copy(sequence.begin(), sequence.end(), reversed.begin());
+    mReverse = QSharedPointer<Index>(new Index(reversed));
+}
+
+QVector<int>
+RepeatFinder::encode(const QStringList& list, QHash<QString, int>* codes)
+{
+    QHash<QString, int> local;
+    if (!codes)
+        codes = &local;
+
+    QVector<int> sequence;
+    sequence.reserve(list.count());
+    foreach (const QString& s, list)
+    {
+        QHash<QString, int>::const_iterator it = codes->constFind(s);
+        if (it == codes->constEnd())
+            it = codes->insert(s, codes->count());
+        sequence.append(it.value());
+    }
+    return sequence;
+}
+
+int
+RepeatFinder::commonExtension(int i, int j) const
+{
+    return mForward->lce(i, j);
+}
+
+QList<RepeatFinder::Run>
+RepeatFinder::runs(int minPeriod) const
+{
+    QList<Run> result;
+    int n = mSequence.count();
+    int maxPeriod = n / 2;
+
+    // the smallest prime factor of every possible period, so each period is factored in
+    // O(log p) instead of by trial division.
+    QVector<int> smallestFactor(maxPeriod + 1, 0);
+    for (int i = 2; i <= maxPeriod; ++i)
+    {
+        if (smallestFactor[i] != 0)
+            continue;
+        for (int m = i; m <= maxPeriod; m += i)
+        {
+            if (smallestFactor[m] == 0)
+                smallestFactor[m] = i;
+        }
+    }
+
+    QVarLengthArray<int, 16> factors;
+    for (int p = qMax(1, minPeriod); p <= maxPeriod; ++p)
+    {
+        // the prime factors of p, a unit that repeats itself has a period of p / factor.
+        factors.clear();
+        for (int rest = p; rest > 1;)
+        {
+            int f = smallestFactor[rest];
+            factors.append(f);
+            while (rest % f == 0)
+                rest /= f;
+        }
+
+        // every run of period p covers at least two positions that are a multiple of p apart.
+        for (int q = 0; q + p < n; q += p)
+        {
+            int forward = mForward->lce(q, q + p);
+            int backward = q > 0 ? mReverse->lce(n - q, n - q - p) : 0;
+
+            // the run reaches back to the previous multiple of p, it was found from there.
+            if (backward >= p)
+                continue;
+
+            int length = backward + p + forward;
+            if (length < p * 2)
+                continue;
+
+            Run run;
+            run.start = q - backward;
+            run.period = p;
+            run.count = length / p;
+
+            bool primitive = true;
+            for (int i = 0; i < factors.count(); ++i)
+            {
+                int d = p / factors.at(i);
+                if (mForward->lce(run.start, run.start + d) >= p - d)
+                {
+                    primitive = false;
+                    break;
+                }
+            }
+
+            if (primitive)
+                result.append(run);
+        }
+    }
+
+    return result;
+}
+
+QList<RepeatFinder::Run>
+RepeatFinder::selectRuns(QList<Run> runs)
+{
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.end() < b.end() || (a.end() == b.end() && a.start < b.start);
+    });
+
+    // weighted interval scheduling, best[i] is the best saving using the first i runs.
+    int count = runs.count();
+    QVector<int> ends(count);
+    for (int i = 0; i < count; ++i)
+        ends[i] = runs[i].end();
+
+    QVector<int> previous(count);
+    QVector<int> best(count + 1, 0);
+    for (int i = 0; i < count; ++i)
+    {
+        previous[i] = std::upper_bound(ends.begin(), ends.begin() + i, runs[i].start)
+                      - ends.begin();
+        best[i + 1] = qMax(best[i], best[previous[i]] + runs[i].saving());
+    }
+
+    QList<Run> selected;
+    for (int i = count; i > 0;)
+    {
+        if (best[i] == best[i - 1])
+        {
+            --i;
+            continue;
+        }
+        selected.prepend(runs[i - 1]);
+        i = previous[i - 1];
+    }
+
+    return selected;
+}
+
+static void
+appendItem(QList<RepeatFinder::Item>& items, int value)
+{
+    if (!items.isEmpty() && items.last().value == value && value != -1)
+    {
+        items.last().count++;
+        return;
+    }
+
+    RepeatFinder::Item item;
+    item.value = value;
+    item.count = 1;
+    items.append(item);
+}
+
+QList<RepeatFinder::Item>
+RepeatFinder::group(const QVector<int>& sequence)
+{
+    QList<Item> items;
+    QList<Run> selected;
+
+    // a repeat of more than one stitch needs at least four stitches.
+    if (sequence.count() >= 4)
+        selected = selectRuns(RepeatFinder(sequence).runs(2));
+
+    int pos = 0;
+    foreach (const Run& run, selected)
+    {
+        for (; pos < run.start; ++pos)
+            appendItem(items, sequence[pos]);
+
+        Item item;
+        item.value = -1;
+        item.count = run.count;
+        item.items = group(sequence.mid(run.start, run.period));
+        items.append(item);
+
+        pos = run.end();
+    }
+
+    for (; pos < sequence.count(); ++pos)
+        appendItem(items, sequence[pos]);
+
+    return items;
+}
@@ -0,0 +1,110 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef REPEATFINDER_H
+#define REPEATFINDER_H
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Finds repeated runs in a sequence of stitches or rows.
+ *
+ * The sequence is encoded as integers and indexed with a suffix array and its lcp array, so
+ * the longest common extension of any two positions can be looked up in constant time. The
+ * runs are then found by checking every period p at every p'th position, which is O(n log n)
+ * instead of comparing every position with every other one. Building the suffix array by
+ * prefix doubling is O(n log^2 n) and dominates.
+ */
+class RepeatFinder
+{
+public:
+    /**
+     * count copies of the sequence from start to start + period follow each other.
+     */
+    struct Run
+    {
+        int start;
+        int period;
+        int count;
+
+        int
+        end() const
+        {
+            return start + period * count;
+        }
+        int
+        saving() const
+        {
+            return period * (count - 1);
+        }
+    };
+
+    /**
+     * A stitch repeated count times, or if the stitch is -1, a group of items repeated
+     * count times.
+     */
+    struct Item
+    {
+        int value;
+        int count;
+        QList<Item> items;
+    };
+
+    explicit RepeatFinder(const QVector<int>& sequence);
+
+    /**
+     * encode strings as integers, equal strings get the same number.
+     */
+    static QVector<int> encode(const QStringList& list, QHash<QString, int>* codes = nullptr);
+
+    /**
+     * the number of items that are the same starting at positions i and j.
+     */
+    int commonExtension(int i, int j) const;
+
+    /**
+     * every maximal run with at least two copies of a unit of minPeriod items or more.
+     * The unit of a run doesn't repeat itself, "a a a a" is a run of "a" but not of "a a".
+     */
+    QList<Run> runs(int minPeriod = 1) const;
+
+    /**
+     * pick the runs that don't overlap and save the most items.
+     */
+    static QList<Run> selectRuns(QList<Run> runs);
+
+    /**
+     * group sequence into items, with runs of more than one stitch as nested groups.
+     */
+    static QList<Item> group(const QVector<int>& sequence);
+
+private:
+    class Index;
+
+    QVector<int> mSequence;
+    QSharedPointer<Index> mForward;
+    QSharedPointer<Index> mReverse;
+};
+
+#endif  // REPEATFINDER_H
@@ -22,6 +22,7 @@
 #include "ui_roweditdialog.h"
 
 #include "stitchlibrary.h"
+#include "rowsmodel.h"
 
 #include "debug.h"
 #include <QMessageBox>
@@ -40,9 +41,9 @@ RowEditDialog::RowEditDialog(Scene* scene, TextView* textView, QWidget* parent)
     connect(ui->moveUp, SIGNAL(clicked(bool)), SLOT(moveUp()));
     connect(ui->moveDown, SIGNAL(clicked(bool)), SLOT(moveDown()));
 
-    connect(ui->rowList, SIGNAL(currentRowChanged(int)), SLOT(listItemChanged(int)));
-    connect(ui->rowList, SIGNAL(itemClicked(QListWidgetItem*)),
-            SLOT(listItemClicked(QListWidgetItem*)));
+    ui->rowList->setModel(mScene->rowsModel());
+    connect(ui->rowList->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
+            SLOT(listItemClicked(QModelIndex)));
 
     connect(ui->updateRow, SIGNAL(clicked(bool)), SLOT(updateRow()));
 }
@@ -59,10 +60,17 @@ RowEditDialog::show()
     updateRowList();
 }
 
+int
+RowEditDialog::currentRow() const
+{
+    QModelIndex index = ui->rowList->currentIndex();
+    return index.isValid() ? index.row() : -1;
+}
+
 void
 RowEditDialog::addRow()
 {
-    if (mScene->selectedItems().count() <= 0)
+    if (mScene->selectionCount() <= 0)
     {
         QMessageBox msgbox;
         msgbox.setText(tr("Please select the stitches you would like to create a row from."));
@@ -73,71 +81,51 @@ RowEditDialog::addRow()
     }
 
     mScene->createRow();
-
-    updateRowList();
 }
 
 void
 RowEditDialog::removeRow()
 {
-    int curRow = ui->rowList->currentRow();
+    int curRow = currentRow();
     if (curRow < 0)
         return;
 
-    ui->rowList->reset();
-    ui->rowList->takeItem(curRow);
-
     mScene->removeRow(curRow);
-    updateRowList();
 
     // select the next item in the list.
-    QListWidgetItem* item;
-    if (ui->rowList->count() > curRow)
-        item = ui->rowList->item(curRow);
-    else
-    {
-        curRow = ui->rowList->count() - 1;
-        if (curRow < 0)
-            return;
-        item = ui->rowList->item(curRow);
-    }
-    if (item)
-        ui->rowList->setCurrentItem(item);
+    int count = mScene->rowsModel()->rowCount();
+    if (count == 0)
+        return;
+    ui->rowList->setCurrentIndex(mScene->rowsModel()->index(qMin(curRow, count - 1)));
 }
 
 void
 RowEditDialog::moveUp()
 {
-    int curRow = ui->rowList->currentRow();
-    if (curRow <= 0 || curRow >= ui->rowList->count())
+    int curRow = currentRow();
+    if (curRow <= 0)
         return;
 
     mScene->moveRowUp(curRow);
-    updateRowList();
 }
 
 void
 RowEditDialog::moveDown()
 {
-    int curRow = ui->rowList->currentRow();
-
-    if (curRow + 1 >= ui->rowList->count() || curRow < 0)
+    int curRow = currentRow();
+    if (curRow < 0)
         return;
 
     mScene->moveRowDown(curRow);
-    updateRowList();
 }
 
 void
-RowEditDialog::listItemChanged(int listRow)
+RowEditDialog::listItemClicked(const QModelIndex& index)
 {
-    listItemClicked(ui->rowList->item(listRow));
-}
+    if (!index.isValid())
+        return;
 
-void
-RowEditDialog::listItemClicked(QListWidgetItem* item)
-{
-    int r = item->text().toInt() - 1;
+    int r = index.row();
     mScene->highlightRow(r);
 
     QString rowText = mTextView->generateTextRow(r, true, true);
@@ -149,58 +137,20 @@ RowEditDialog::listItemClicked(QListWidgetItem* item)
 void
 RowEditDialog::updateRowList()
 {
-    ui->rowList->reset();
-    ui->rowList->clear();
-
-    removeEmptyRows();
-
-    int rows = mScene->grid.count();
-
-    for (int i = 0; i < rows; ++i)
-    {
-        // using this slightly more complicated addItem() allows the sorting to work correctly for
-        // numbers.
-        QListWidgetItem* item = new QListWidgetItem();
-        item->setData(Qt::DisplayRole, i + 1);
-        ui->rowList->addItem(item);
-    }
-}
-
-void
-RowEditDialog::removeEmptyRows()
-{
-    int rows = mScene->grid.count();
-
-    for (int i = rows - 1; i >= 0; i--)
-    {
-        int cols = mScene->grid.at(i).count();
-        for (int j = cols - 1; j >= 0; j--)
-        {
-            if (mScene->grid[i][j] == 0)
-                mScene->grid[i].removeAt(j);
-        }
-        if (mScene->grid[i].count() == 0)
-            mScene->grid.removeAt(i);
-    }
+    mScene->removeEmptyRows();
 }
 
 void
 RowEditDialog::updateRow()
 {
     // if there aren't items selected on scene don't continue
-    if (mScene->selectedItems().count() <= 0)
+    if (mScene->selectionCount() <= 0)
         return;
 
     // if there isn't a selected row to update don't continue
-    if (ui->rowList->selectedItems().count() <= 0)
-        return;
-
-    // adjust the value of the selected row to match the zero-index
-    // of the row in the scene/grid.
-    int r = ui->rowList->currentItem()->text().toInt();
-    if (r <= 0)
+    int r = currentRow();
+    if (r < 0)
         return;
-    r--;
 
     mScene->updateRow(r);
 
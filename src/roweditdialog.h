@@ -31,7 +31,7 @@ namespace Ui
 class RowEditDialog;
 }
 
-class QListWidgetItem;
+class QModelIndex;
 
 class RowEditDialog : public QWidget
 {
@@ -40,6 +40,9 @@ public:
     RowEditDialog(Scene* scene, TextView* textView, QWidget* parent = nullptr);
     ~RowEditDialog();
 
+    /**
+     * clean up the rows, the list follows the rows in the scene on its own.
+     */
     void updateRowList();
 
     void show();
@@ -58,15 +61,14 @@ private slots:
     void moveDown();
 
     /**
-     * row is the row in the rowList widget.
+     * the row of index is the grid row.
      */
-    void listItemChanged(int listRow);
-    void listItemClicked(QListWidgetItem* item);
+    void listItemClicked(const QModelIndex& index);
 
     void updateRow();
 
 private:
-    void removeEmptyRows();
+    int currentRow() const;
 
     Scene* mScene;
     TextView* mTextView;
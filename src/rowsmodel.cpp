@@ -0,0 +1,52 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "rowsmodel.h"
+
+#include "scene.h"
+
+RowsModel::RowsModel(Scene* scene)
+    : QAbstractListModel(scene)
+    , mScene(scene)
+{
+}
+
+int
+RowsModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return mScene->grid.count();
+}
+
+QVariant
+RowsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= mScene->grid.count())
+        return QVariant();
+
+    if (role == Qt::DisplayRole)
+        return index.row() + 1;
+    else if (role == Qt::ToolTipRole)
+        return tr("%1 stitches").arg(mScene->grid[index.row()].count());
+
+    return QVariant();
+}
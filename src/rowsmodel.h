@@ -0,0 +1,49 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef ROWSMODEL_H
+#define ROWSMODEL_H
+
+#include <QAbstractListModel>
+
+class Scene;
+
+/**
+ * A list of the rows in Scene::grid, numbered from 1.
+ *
+ * The scene tells the model about every row it adds, removes or moves so a view only updates
+ * the rows that changed instead of being rebuilt.
+ */
+class RowsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    friend class Scene;
+
+public:
+    explicit RowsModel(Scene* scene);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+
+private:
+    Scene* mScene;
+};
+
+#endif  // ROWSMODEL_H
@@ -19,16 +19,22 @@
 
  \****************************************************************************/
 #include "scene.h"
+#include "rowsmodel.h"
 
 #include "cell.h"
 
 #include <QFontMetrics>
+#include <QStyleOptionGraphicsItem>
 #include <QGraphicsSimpleTextItem>
 #include <QGraphicsSceneEvent>
 #include <QApplication>
 #include <QClipboard>
+#include <QSet>
+#include <QVarLengthArray>
 
 #include <math.h>
+#include <QtMath>
+#include <algorithm>
 
 #include "debug.h"
 
@@ -49,6 +55,8 @@
 #include <QVector2D>
 
 #include "ChartItemTools.h"
+#include "chartmimedata.h"
+#include "selectionproxy.h"
 
 #include "guideline.h"
 
@@ -145,6 +153,7 @@ Scene::Scene(QObject* parent)
     , mOldTransform()
     , mOldSize(1, 1)
     , mOrigin(0, 0)
+    , mRowsModel(new RowsModel(this))
     , mDefaultSize(32.0, 96.0)
     , mDefaultStitch("ch")
 {
@@ -242,11 +251,8 @@ Scene::addItem(QGraphicsItem* item)
     {
     case Cell::Type:
     {
+        // the cell is connected to the scene when it's indexed.
         QGraphicsScene::addItem(item);
-        Cell* c = qgraphicsitem_cast<Cell*>(item);
-        connect(c, SIGNAL(stitchChanged(QString, QString)),
-                SIGNAL(stitchChanged(QString, QString)));
-        connect(c, SIGNAL(colorChanged(QString, QString)), SIGNAL(colorChanged(QString, QString)));
         break;
     }
     case Indicator::Type:
@@ -335,7 +341,17 @@ Scene::removeFromRows(Cell* c)
         {
             grid[y].removeOne(c);
             if (grid[y].count() == 0)
+            {
+                mRowsModel->beginRemoveRows(QModelIndex(), y, y);
                 grid.removeAt(y);
+                mRowsModel->endRemoveRows();
+                updateRowRenderers(y);
+            }
+            else
+            {
+                QModelIndex index = mRowsModel->index(y);
+                emit mRowsModel->dataChanged(index, index);
+            }
             c->setZValue(10);
             break;
         }
@@ -404,7 +420,7 @@ Scene::keyPressEvent(QKeyEvent* keyEvent)
     if (keyEvent->isAccepted())
         return;
 
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     switch (mMode)
@@ -560,14 +576,11 @@ Scene::scaleModeKeyRelease(QKeyEvent* keyEvent)
 void
 Scene::mousePressEvent(QGraphicsSceneMouseEvent* e)
 {
-    if (selectedItems().count() > 0)
+    if (selectionCount() > 0)
         mHasSelection = true;
 
-    if (mHasSelection && e->modifiers() == Qt::ControlModifier)
-        mSelectionPath = selectionArea();
-    //
     if (e->buttons() & Qt::LeftButton
-        && (e->modifiers() != Qt::ShiftModifier || selectedItems().count() >= 1))
+        && (e->modifiers() != Qt::ShiftModifier || selectionCount() >= 1))
         QGraphicsScene::mousePressEvent(e);
 
     // FIXME: there has to be a better way to keep the current selection.
@@ -677,7 +690,7 @@ Scene::mousePressEvent(QGraphicsSceneMouseEvent* e)
     if (e->buttons() != Qt::LeftButton)
         return;
 
-    if (selectedItems().count() <= 0 || e->modifiers() == Qt::ControlModifier)
+    if (selectionCount() <= 0 || e->modifiers() == Qt::ControlModifier)
     {
         ChartView* view = qobject_cast<ChartView*>(parent());
 
@@ -708,10 +721,15 @@ Scene::mousePressEvent(QGraphicsSceneMouseEvent* e)
     else
     {
         // Track object movement on scene.
-        foreach (QGraphicsItem* item, selectedItems())
+        QList<QGraphicsItem*> selection = selectedItems();
+        foreach (QGraphicsItem* item, selection)
         {
             mOldPositions.insert(item, item->pos());
         }
+
+        // the guidelines follow the center while it moves so it has to move for real.
+        mUseMoveProxy = selection.count() >= SCENE_PROXY_MOVE_COUNT
+                        && !(mCenterSymbol && mCenterSymbol->isSelected());
     }
 }
 
@@ -760,10 +778,24 @@ Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* e)
         }
         else if (mMoving)
         {
-            QGraphicsScene::mouseMoveEvent(e);
-            if (selectedItems().contains(mCenterSymbol))
+            if (mUseMoveProxy && !mMoveProxy)
             {
-                updateGuidelines();
+                qreal scale = views().isEmpty() ? 1.0 : views().first()->transform().m11();
+                mMoveProxy = new SelectionProxy(selectedItems(), scale);
+                QGraphicsScene::addItem(mMoveProxy);
+            }
+
+            if (mMoveProxy)
+            {
+                mMoveProxy->setOffset(e->scenePos() - e->buttonDownScenePos(Qt::LeftButton));
+            }
+            else
+            {
+                QGraphicsScene::mouseMoveEvent(e);
+                if (mCenterSymbol && mCenterSymbol->isSelected())
+                {
+                    updateGuidelines();
+                }
             }
         }
     }
@@ -806,25 +838,30 @@ Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* e)
         path.addPath(view->mapToScene(mSelectionBand->path()));
 
         // if user is holding down ctrl add items to existing selection.
-        if (mHasSelection && e->modifiers() == Qt::ControlModifier)
-        {
-            path.addPath(mSelectionPath);
-        }
-        blockSignals(true);
-        setSelectionArea(path);
-        blockSignals(false);
-        emit selectionChanged();
+        bool add = mHasSelection && e->modifiers() == Qt::ControlModifier;
+        setSelection(items(path, Qt::IntersectsItemShape), add);
         mSelectionBand->hide();
     }
 
-    if ((selectedItems().count() > 0 && mOldPositions.count() > 0) && mMoving)
+    if (mMoveProxy)
     {
-        undoStack()->beginMacro("move items");
-        // first, snap the items to the grid if we need to
+        // move the items to where the picture of them was dropped.
+        QPointF offset = mMoveProxy->offset();
+        delete mMoveProxy;
+        mMoveProxy = nullptr;
+
         foreach (QGraphicsItem* item, selectedItems())
         {
-            snapGraphicsItemToGrid(*item);
+            item->moveBy(offset.x(), offset.y());
         }
+    }
+    mUseMoveProxy = false;
+
+    if ((selectionCount() > 0 && mOldPositions.count() > 0) && mMoving)
+    {
+        undoStack()->beginMacro("move items");
+        // first, snap the items to the grid if we need to
+        snapItemsToGrid(selectedItems());
 
         foreach (QGraphicsItem* item, selectedItems())
         {
@@ -869,158 +906,63 @@ Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* e)
 void
 Scene::snapGraphicsItemToGrid(QGraphicsItem& item)
 {
-    QPointF centerPos = item.sceneBoundingRect().center();
-    item.setPos(snapPositionToGrid(centerPos) - centerPos + item.pos());
-
-    // if we need to snap the angle and we are in rounds mode
-    if (mSnapAngle && mGuidelines.type() == "Rounds")
-    {
-        // get the angle between the item and the center
-        QPointF center(0, 0);
-        if (mCenterSymbol)
-            center = mCenterSymbol->pos();
-
-        QPointF newCenterPos = item.sceneBoundingRect().center();
-        qreal angle = std::atan2(newCenterPos.y() - center.y(), newCenterPos.x() - center.x());
-
-        // rotate the object so it looks at the center
-        ChartItemTools::setRotationPivot(&item, item.boundingRect().center());
-        ChartItemTools::setRotation(&item, (angle * 180 / M_PI) + 90);
-    }
-}
-
-QPointF
-Scene::snapPositionToGrid(const QPointF& pos) const
-{
-    if (mGuidelines.type() == "None")
-        return pos;
-    else if (mGuidelines.type() == "Rows")
-        return snapPositionToRows(pos);
-    else if (mGuidelines.type() == "Rounds")
-        return snapPositionToRounds(pos);
-    else if (mGuidelines.type() == "Triangles")
-        return snapPositionToTriangles(pos);
-    else
-    {
-        return pos;
-        WARN("Unknown guideline type.");
-        WARN(mGuidelines.type());
-    }
+    snapItemsToGrid(QList<QGraphicsItem*>() << &item);
 }
 
-QPointF
-Scene::snapPositionToTriangles(const QPointF& pos) const
+void
+Scene::snapItemsToGrid(const QList<QGraphicsItem*>& items)
 {
-    // get the needed variables
-    QPointF center(0, 0);
-    if (mCenterSymbol)
-        center = mCenterSymbol->pos();
-
-    int triangles = mGuidelines.rows();
-
-    int spacingW = mGuidelines.cellWidth();
-    int spacingH = mGuidelines.cellHeight();
-
-    // get the relative position to the triangles
-    QPointF relPos = pos - center;
-
-    // get the row of the current position
-    int relRow = relPos.y() / spacingH + 0.5;
-
-    // clamp the row
-    relRow = std::max(0, std::min(triangles, relRow));
+    const SnapLattice& lattice = snapLattice();
+    if (lattice.kind() == SnapLattice::None || items.isEmpty())
+        return;
 
-    // get the max offsetX of that row
-    qreal offsetX = (relRow)*spacingW / 2;
+    QVector<QPointF> centers;
+    centers.reserve(items.count());
+    foreach (QGraphicsItem* item, items)
+        centers.append(item->sceneBoundingRect().center());
 
-    // get the distance from that offset
-    qreal offsetDist = relPos.x() - offsetX;
+    QVector<QPointF> snapped = centers;
+    lattice.snap(snapped);
 
-    // snap that distance to the grid
-    int relDistColumn = offsetDist / spacingW - 0.5;
+    // if we need to snap the angle and we are in rounds mode
+    bool rotate = mSnapAngle && lattice.kind() == SnapLattice::Rounds;
 
-    // clamp the column
-    relDistColumn = std::max(-relRow, std::min(0, relDistColumn));
+    for (int i = 0; i < items.count(); ++i)
+    {
+        QGraphicsItem* item = items.at(i);
+        item->setPos(snapped.at(i) - centers.at(i) + item->pos());
 
-    // get the new relative pos
-    QPointF newPos(relDistColumn * spacingW + offsetX, relRow * spacingH);
+        if (rotate)
+        {
+            // the item's center is now on the snapped point, rotate it so it looks at the center.
+            QPointF relPos = snapped.at(i) - lattice.center();
+            qreal angle = std::atan2(relPos.y(), relPos.x());
 
-    return newPos + center;
+            ChartItemTools::setRotationPivot(item, item->boundingRect().center());
+            ChartItemTools::setRotation(item, (angle * 180 / M_PI) + 90);
+        }
+    }
 }
 
 QPointF
-Scene::snapPositionToRows(const QPointF& pos) const
+Scene::snapPositionToGrid(const QPointF& pos) const
 {
-    // get the needed variables
-    QPointF center(0, 0);
-    if (mCenterSymbol)
-        center = mCenterSymbol->pos();
-
-    int columns = mGuidelines.columns();
-    int rows = mGuidelines.rows();
-
-    int spacingW = mGuidelines.cellWidth();
-    int spacingH = mGuidelines.cellHeight();
-
-    // get the relative position to the grid
-    QPointF relPos = pos - center;
-
-    // get the grid pos of the point
-    int relPosGridX = (relPos.x() + spacingW / 2) / spacingW;
-    int relPosGridY = (relPos.y() + spacingH / 2) / spacingH;
-
-    // clamp these the the grid size
-    relPosGridX = std::max(0, std::min(columns, relPosGridX));
-    relPosGridY = std::max(0, std::min(rows, relPosGridY));
-
-    // get the new relative position
-    QPointF snappedRelPos(relPosGridX * spacingW, relPosGridY * spacingH);
-
-    // return it as scene coordinates
-    return snappedRelPos + center;
+    return snapLattice().snap(pos);
 }
 
-QPointF
-Scene::snapPositionToRounds(const QPointF& pos) const
+const SnapLattice&
+Scene::snapLattice() const
 {
-    // get the needed variables
-    QPointF center(0, 0);
-    if (mCenterSymbol)
-        center = mCenterSymbol->pos();
-
-    int columns = mGuidelines.columns();
-    int rounds = mGuidelines.rows();
-
-    int spacingH = mGuidelines.cellHeight();
-
-    // get the relative position to the circle
-    QPointF relPos = pos - center;
-
-    // get the ring of the position
-    qreal distanceToCenter = sqrt(relPos.x() * relPos.x() + relPos.y() * relPos.y()) + spacingH / 2;
-    int relPosRing = distanceToCenter / spacingH;
-    relPosRing = std::max(0, std::min(rounds + 1, relPosRing));
-    qreal relPosSnappedDistance = relPosRing * spacingH;
-
-    // get the quadrant of the position
-    qreal PIPI = M_PI * 2;
-    qreal quadrantAngleSize = PIPI / columns;
-    qreal relPosAngle = atan2(relPos.y(), relPos.x());
-
-    relPosAngle -= M_PI_2;
-
-    // we normalize the angle
-    relPosAngle = fmod(relPosAngle, PIPI);
-    if (relPosAngle < 0)
-        relPosAngle += PIPI;
-
-    int relPosQuadrant = (relPosAngle) / quadrantAngleSize + 0.5;
-    qreal relPosSnappedAngle = relPosQuadrant * quadrantAngleSize + M_PI_2;
-
-    // convert it to a point on the circle and as scene coordinates
-    return QPointF(cos(relPosSnappedAngle) * relPosSnappedDistance,
-                   sin(relPosSnappedAngle) * relPosSnappedDistance)
-           + center;
+    // the lattice only changes with the guidelines or the chart center.
+    QPointF center = guidelinesCenter();
+    if (mSnapGuidelines != mGuidelines || mSnapLattice.center() != center)
+    {
+        mSnapGuidelines = mGuidelines;
+        mSnapLattice = SnapLattice(SnapLattice::kind(mGuidelines.type()), mGuidelines.rows(),
+                                   mGuidelines.columns(), mGuidelines.cellWidth(),
+                                   mGuidelines.cellHeight(), center);
+    }
+    return mSnapLattice;
 }
 
 void
@@ -1150,7 +1092,7 @@ Scene::angleModeMousePress(QGraphicsSceneMouseEvent* e)
     if (mCurItem->parentItem())
         mCurItem = mCurItem->parentItem();
 
-    if (selectedItems().count() > 1)
+    if (selectionCount() > 1)
     {
         undoStack()->beginMacro("Rotate multiple items.");
         GroupItems* g = new GroupItems(this, selectedItems());
@@ -1183,7 +1125,7 @@ Scene::angleModeMouseMove(QGraphicsSceneMouseEvent* e)
         return;
 
     // FIXME: don't 'move' stitches if multple are selected. rotate them.
-    if (selectedItems().count() > 1)
+    if (selectionCount() > 1)
     {
         mMoving = true;
         return;
@@ -1258,7 +1200,7 @@ Scene::scaleModeMousePress(QGraphicsSceneMouseEvent* e)
         mCurItem = mCurItem->parentItem();
     }
 
-    if (selectedItems().count() > 1)
+    if (selectionCount() > 1)
     {
         undoStack()->beginMacro("Rotate multiple items.");
         GroupItems* g = new GroupItems(this, selectedItems());
@@ -1292,7 +1234,7 @@ Scene::scaleModeMouseMove(QGraphicsSceneMouseEvent* e)
     if (!mCurItem)
         return;
 
-    if (selectedItems().count() > 1)
+    if (selectionCount() > 1)
     {
         mMoving = true;
         return;
@@ -1434,7 +1376,7 @@ Scene::rowEditMouseRelease(QGraphicsSceneMouseEvent* e)
 {
     Q_UNUSED(e);
 
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         hideRowLines();
     else
     {
@@ -1527,7 +1469,7 @@ Scene::stitchModeMouseRelease(QGraphicsSceneMouseEvent* e)
 void
 Scene::createRow()
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     QList<Cell*> r;
@@ -1539,13 +1481,16 @@ Scene::createRow()
         c->useAlternateRenderer((grid.count() % 2));
         r.append(c);
     }
+
+    mRowsModel->beginInsertRows(QModelIndex(), grid.count(), grid.count());
     grid.append(r);
+    mRowsModel->endInsertRows();
 }
 
 void
 Scene::updateRow(int row)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     QList<Cell*> r;
@@ -1554,12 +1499,17 @@ Scene::updateRow(int row)
     {
         Cell* c = qgraphicsitem_cast<Cell*>(i);
         removeFromRows(c);
-        c->useAlternateRenderer((row % 2));
         c->setZValue(100);
         r.append(c);
     }
 
+    row = qBound(0, row, grid.count());
+    mRowsModel->beginInsertRows(QModelIndex(), row, row);
     grid.insert(row, r);
+    mRowsModel->endInsertRows();
+
+    // the rows after it moved down one.
+    updateRowRenderers(row);
 }
 
 QPoint
@@ -1582,49 +1532,92 @@ Scene::highlightRow(int row)
     if (row >= grid.count())
         return;
 
-    clearSelection();
     mRowSelection.clear();
 
     for (int i = 0; i < grid[row].count(); ++i)
     {
         Cell* c = grid[row][i];
         if (c)
-        {
-            c->setSelected(true);
             mRowSelection.append(c);
-        }
     }
 
-    emit selectionChanged();
+    setSelection(mRowSelection);
 }
 
 void
 Scene::moveRowDown(int row)
 {
-    QList<Cell*> r = grid.takeAt(row);
-    grid.insert(row + 1, r);
-    updateStitchRenderer();
+    if (row < 0 || row + 1 >= grid.count())
+        return;
+
+    mRowsModel->beginMoveRows(QModelIndex(), row, row, QModelIndex(), row + 2);
+    grid.swap(row, row + 1);
+    mRowsModel->endMoveRows();
+
+    // only the two rows that traded places changed color.
+    foreach (Cell* c, grid[row])
+    {
+        if (c)
+            c->useAlternateRenderer(row % 2);
+    }
+    foreach (Cell* c, grid[row + 1])
+    {
+        if (c)
+            c->useAlternateRenderer((row + 1) % 2);
+    }
 }
 
 void
 Scene::moveRowUp(int row)
 {
-    QList<Cell*> r = grid.takeAt(row);
-    grid.insert(row - 1, r);
-    updateStitchRenderer();
+    moveRowDown(row - 1);
 }
 
 void
 Scene::removeRow(int row)
 {
+    if (row < 0 || row >= grid.count())
+        return;
+
+    mRowsModel->beginRemoveRows(QModelIndex(), row, row);
     QList<Cell*> r = grid.takeAt(row);
+    mRowsModel->endRemoveRows();
 
     foreach (Cell* c, r)
     {
-        c->useAlternateRenderer(false);
+        if (c)
+            c->useAlternateRenderer(false);
+    }
+
+    updateRowRenderers(row);
+}
+
+void
+Scene::removeEmptyRows()
+{
+    for (int i = grid.count() - 1; i >= 0; i--)
+    {
+        grid[i].removeAll(0);
+        if (grid[i].count() == 0)
+        {
+            mRowsModel->beginRemoveRows(QModelIndex(), i, i);
+            grid.removeAt(i);
+            mRowsModel->endRemoveRows();
+        }
     }
+}
 
-    updateStitchRenderer();
+void
+Scene::updateRowRenderers(int first)
+{
+    for (int i = qMax(0, first); i < grid.count(); ++i)
+    {
+        foreach (Cell* c, grid[i])
+        {
+            if (c)
+                c->useAlternateRenderer((i % 2));
+        }
+    }
 }
 
 void
@@ -1662,6 +1655,156 @@ Scene::render(QPainter* painter,
     setBackground(true);
 }
 
+/**
+ * the item and its ancestors, top level item first.
+ */
+static void
+ancestorChain(QGraphicsItem* item, QVarLengthArray<QGraphicsItem*, 8>& chain)
+{
+    chain.clear();
+    for (; item; item = item->parentItem())
+        chain.append(item);
+    std::reverse(chain.begin(), chain.end());
+}
+
+/**
+ * stacking order for items of the same scene, the way QGraphicsScene paints them: siblings by
+ * z value, children above their parent unless they stack behind it, and everything inside an
+ * item between it and its next sibling. Items that compare equal keep the order they were
+ * given in.
+ */
+static bool
+stacksBelow(QGraphicsItem* a, QGraphicsItem* b)
+{
+    if (a == b)
+        return false;
+
+    QVarLengthArray<QGraphicsItem*, 8> chainA;
+    QVarLengthArray<QGraphicsItem*, 8> chainB;
+    ancestorChain(a, chainA);
+    ancestorChain(b, chainB);
+
+    int i = 0;
+    while (i < chainA.count() && i < chainB.count() && chainA.at(i) == chainB.at(i))
+        ++i;
+
+    // one is inside the other.
+    if (i == chainA.count())
+        return !(chainB.at(i)->flags() & QGraphicsItem::ItemStacksBehindParent);
+    if (i == chainB.count())
+        return chainA.at(i)->flags() & QGraphicsItem::ItemStacksBehindParent;
+
+    // the two siblings that hold a and b decide.
+    QGraphicsItem* siblingA = chainA.at(i);
+    QGraphicsItem* siblingB = chainB.at(i);
+    if (i > 0)
+    {
+        bool behindA = siblingA->flags() & QGraphicsItem::ItemStacksBehindParent;
+        bool behindB = siblingB->flags() & QGraphicsItem::ItemStacksBehindParent;
+        if (behindA != behindB)
+            return behindA;
+    }
+
+    return siblingA->zValue() < siblingB->zValue();
+}
+
+QTransform
+Scene::renderTransform(const QRectF& source,
+                       const QRectF& target,
+                       Qt::AspectRatioMode aspectRatioMode)
+{
+    // the same mapping QGraphicsScene::render uses.
+    qreal xratio = target.width() / source.width();
+    qreal yratio = target.height() / source.height();
+
+    switch (aspectRatioMode)
+    {
+    case Qt::KeepAspectRatio:
+        xratio = yratio = qMin(xratio, yratio);
+        break;
+    case Qt::KeepAspectRatioByExpanding:
+        xratio = yratio = qMax(xratio, yratio);
+        break;
+    case Qt::IgnoreAspectRatio:
+        break;
+    }
+
+    return QTransform()
+        .translate(target.left(), target.top())
+        .scale(xratio, yratio)
+        .translate(-source.left(), -source.top());
+}
+
+void
+Scene::sortByStackingOrder(QList<QGraphicsItem*>& items)
+{
+    std::stable_sort(items.begin(), items.end(), stacksBelow);
+}
+
+void
+Scene::renderItems(QPainter* painter,
+                   const QList<QGraphicsItem*>& items,
+                   const QRectF& target,
+                   const QRectF& source,
+                   Qt::AspectRatioMode aspectRatioMode)
+{
+    QRectF sourceRect = source;
+    if (sourceRect.isNull())
+        sourceRect = selectedItemsBoundingRect(items);
+
+    QRectF targetRect = target;
+    if (targetRect.isNull())
+    {
+        if (painter->device()->devType() == QInternal::Picture)
+            targetRect = sourceRect;
+        else
+            targetRect.setRect(0, 0, painter->device()->width(), painter->device()->height());
+    }
+
+    if (sourceRect.isEmpty() || targetRect.isEmpty())
+        return;
+
+    QList<QGraphicsItem*> sorted;
+    foreach (QGraphicsItem* item, items)
+    {
+        if (item->isVisible() && item->sceneBoundingRect().intersects(sourceRect))
+            sorted.append(item);
+    }
+    sortByStackingOrder(sorted);
+
+    QFont originalFont = painter->font();
+    originalFont.setPixelSize(10);
+    originalFont.setBold(false);
+    originalFont.setItalic(false);
+    originalFont.setUnderline(false);
+
+    painter->save();
+    painter->setFont(originalFont);
+    painter->setClipRect(targetRect, Qt::IntersectClip);
+    painter->setWorldTransform(renderTransform(sourceRect, targetRect, aspectRatioMode), true);
+
+    setBackground(false);
+    drawBackground(painter, sourceRect);
+    setBackground(true);
+
+    QStyleOptionGraphicsItem option;
+    foreach (QGraphicsItem* item, sorted)
+    {
+        QRectF rect = item->boundingRect();
+        option.state = item->isEnabled() ? QStyle::State_Enabled : QStyle::State_None;
+        option.rect = rect.toAlignedRect();
+        option.exposedRect = rect;
+
+        painter->save();
+        painter->setWorldTransform(item->sceneTransform(), true);
+        painter->setOpacity(item->effectiveOpacity());
+        item->paint(painter, &option, 0);
+        painter->restore();
+    }
+
+    painter->restore();
+}
+
 void
 Scene::drawBackground(QPainter* painter, const QRectF& rect)
 {
@@ -1737,11 +1880,24 @@ Scene::hideRowLines()
     }
 }
 
+/**
+ * the scene bounding rect of each item, worked out once for sorting, measuring and moving.
+ */
+static QVector<QRectF>
+sceneRects(const QList<QGraphicsItem*>& items)
+{
+    QVector<QRectF> rects;
+    rects.reserve(items.count());
+    foreach (QGraphicsItem* i, items)
+        rects.append(i->sceneBoundingRect());
+    return rects;
+}
+
 // FIXME: simplify the number of foreach loops?
 void
 Scene::alignSelection(int alignmentStyle)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
@@ -1794,7 +1950,7 @@ Scene::alignSelection(int alignmentStyle)
 void
 Scene::distributeSelection(int distributionStyle)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
@@ -1847,7 +2003,8 @@ Scene::distributeSelection(int distributionStyle)
 void
 Scene::align(int vertical, int horizontal)
 {
-    // TODO: break up function into manageable pieces.
+    QList<QGraphicsItem*> items = selectedItems();
+    QVector<QRectF> rects = sceneRects(items);
 
     // Use the opposite extremes and walk over to the correct placement.
     qreal left = sceneRect().right();
@@ -1855,32 +2012,12 @@ Scene::align(int vertical, int horizontal)
     qreal top = sceneRect().bottom();
     qreal bottom = sceneRect().top();
 
-    foreach (QGraphicsItem* i, selectedItems())
+    foreach (const QRectF& r, rects)
     {
-        qreal tmpLeft, tmpTop;
-
-        tmpLeft = i->sceneBoundingRect().left();
-        tmpTop = i->sceneBoundingRect().top();
-
-        if (tmpLeft < left)
-        {
-            left = tmpLeft;
-        }
-
-        if (i->sceneBoundingRect().right() > right)
-        {
-            right = i->sceneBoundingRect().right();
-        }
-
-        if (tmpTop < top)
-        {
-            top = tmpTop;
-        }
-
-        if (i->sceneBoundingRect().bottom() > bottom)
-        {
-            bottom = i->sceneBoundingRect().bottom();
-        }
+        left = qMin(left, r.left());
+        right = qMax(right, r.right());
+        top = qMin(top, r.top());
+        bottom = qMax(bottom, r.bottom());
     }
 
     qreal diff = right - left;
@@ -1905,500 +2042,399 @@ Scene::align(int vertical, int horizontal)
     else if (vertical == 3)
         baseY = bottom;
 
-    undoStack()->beginMacro("align selection");
-    foreach (QGraphicsItem* i, selectedItems())
+    QVector<QPointF> positions;
+    positions.reserve(items.count());
+    for (int idx = 0; idx < items.count(); ++idx)
     {
-        QPointF oldPos = i->pos();
-        qreal newX = baseX;
-        qreal newY = baseY;
+        QPointF oldPos = items.at(idx)->pos();
+        const QRectF& r = rects.at(idx);
+        qreal newX = oldPos.x();
+        qreal newY = oldPos.y();
 
-        if (horizontal == 0)
-        {
-            newX = oldPos.x();
-        }
-        else if (horizontal == 1)
-        {
-            newX = i->pos().x() + (newX - i->sceneBoundingRect().x());
-        }
+        if (horizontal == 1)
+            newX += baseX - r.x();
         else if (horizontal == 2)
-        {
-            newX = i->pos().x()
-                   + ((newX - i->sceneBoundingRect().x()) - i->sceneBoundingRect().width() / 2);
-        }
+            newX += (baseX - r.x()) - r.width() / 2;
         else if (horizontal == 3)
-        {
-            newX = i->pos().x()
-                   + ((newX - i->sceneBoundingRect().x()) - i->sceneBoundingRect().width());
-        }
+            newX += (baseX - r.x()) - r.width();
 
-        if (vertical == 0)
-        {
-            newY = oldPos.y();
-        }
-        else if (vertical == 1)
-        {
-            newY = i->pos().y() + (newY - i->sceneBoundingRect().y());
-        }
+        if (vertical == 1)
+            newY += baseY - r.y();
         else if (vertical == 2)
-        {
-            newY = i->pos().y()
-                   + ((newY - i->sceneBoundingRect().y()) - i->sceneBoundingRect().height() / 2);
-        }
+            newY += (baseY - r.y()) - r.height() / 2;
         else if (vertical == 3)
-        {
-            newY = i->pos().y()
-                   + ((newY - i->sceneBoundingRect().y()) - i->sceneBoundingRect().height());
-        }
+            newY += (baseY - r.y()) - r.height();
 
-        i->setPos(newX, newY);
-        undoStack()->push(new SetItemCoordinates(i, oldPos));
+        positions.append(QPointF(newX, newY));
     }
-    undoStack()->endMacro();
+
+    SetItemsCoordinates* move = new SetItemsCoordinates(items, positions);
+    move->setText(tr("align selection"));
+    undoStack()->push(move);
 }
 
 void
 Scene::updateGuidelines()
 {
-    int columns = mGuidelines.columns();
-    int rows = mGuidelines.rows();
-
-    int spacingW = mGuidelines.cellWidth();
-    int spacingH = mGuidelines.cellHeight();
-
-    if (mGuidelinesLines.count() > 0)
+    if (mGuidelines.type() == "None")
     {
-        foreach (QGraphicsItem* item, mGuidelinesLines)
+        if (mGuidelinesItem)
         {
-            removeItem(item);
-            mGuidelinesLines.removeOne(item);
-            delete item;
+            removeItem(mGuidelinesItem);
+            delete mGuidelinesItem;
+            mGuidelinesItem = nullptr;
         }
-    }
-
-    if (mGuidelines.type() == "None")
         return;
-
-    // get the center position, or make it 0 if centerpos does not exist yet
-    QPointF center;
-    if (mCenterSymbol)
-        center = mCenterSymbol->pos();
-    else
-        center = QPointF(0, 0);
-
-    // create the graphical representation
-    if (mGuidelines.type() == "Rows")
-    {
-        generateGuidelinesRows(spacingW, spacingH, columns, rows, center);
-    }
-    else if (mGuidelines.type() == "Rounds")
-    {
-        generateGuidelinesRounds(spacingW, spacingH, columns, rows, center);
     }
-    else if (mGuidelines.type() == "Triangles")
+
+    // one item draws all the guidelines, stacked where the items of each line used to be.
+    if (!mGuidelinesItem)
     {
-        generateGuidelinesTriangles(spacingW, spacingH, columns, rows, center);
+        mGuidelinesItem = new Guideline();
+        mGuidelinesItem->setZValue(-1);
+        addItem(mGuidelinesItem);
     }
+    mGuidelinesItem->setRect(guidelinesRect());
+    mGuidelinesItem->update();
 
     updateSceneRect();
 }
 
-void
-Scene::generateGuidelinesRows(int spacingW, int spacingH, int columns, int rows, QPointF center)
+QPointF
+Scene::guidelinesCenter() const
 {
-    QGraphicsItem* i = nullptr;
-
-    // generate columns
-    for (int c = 0; c <= columns; c++)
-    {
-        i = addLine(c * spacingW + center.x(), center.y(), c * spacingW + center.x(),
-                    spacingH * rows + center.y());
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
-    }
-    // generate rows
-    for (int r = 0; r <= rows; r++)
-    {
-        i = addLine(center.x(), center.y() + r * spacingH, center.x() + spacingW * columns,
-                    center.y() + r * spacingH);
-
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
-    }
+    // get the center position, or make it 0 if centerpos does not exist yet
+    if (mCenterSymbol)
+        return mCenterSymbol->pos();
+    return QPointF(0, 0);
 }
 
-void
-Scene::generateGuidelinesRounds(
-    int /*spacingW*/, int spacingH, int columns, int rows, QPointF center)
+QRectF
+Scene::guidelinesRect() const
 {
-    QGraphicsItem* i = nullptr;
+    int columns = mGuidelines.columns();
+    int rows = mGuidelines.rows();
+    int spacingW = mGuidelines.cellWidth();
+    int spacingH = mGuidelines.cellHeight();
+    QPointF center = guidelinesCenter();
 
-    // generate dividing lines
-    for (int c = 0; c <= columns; c++)
+    if (mGuidelines.type() == "Rows")
     {
-        qreal radians = (360.0 / columns * c) * M_PI / 180;
-        qreal outterX = center.x() + (spacingH * (rows + 1)) /*distance*/ * sin(radians);
-        qreal outterY = center.y() + (spacingH * (rows + 1)) /*distance*/ * cos(radians);
-
-        qreal innerX = center.x() + spacingH * sin(radians);
-        qreal innerY = center.y() + spacingH * cos(radians);
-
-        i = addLine(innerX, innerY, outterX, outterY);
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
+        return QRectF(center, QSizeF(spacingW * columns, spacingH * rows));
     }
-
-    // generate circles
-    for (int r = 0; r <= rows; r++)
+    else if (mGuidelines.type() == "Rounds")
     {
-        Guideline* g = new Guideline(
-            QRectF(center.x() + -(r + 1) * spacingH, center.y() + -(r + 1) * spacingH,
-                   2 * (r + 1) * spacingH, 2 * (r + 1) * spacingH),
-            0, this);
-        g->setZValue(-1);
-        mGuidelinesLines.append(g);
+        qreal radius = spacingH * (rows + 1);
+        return QRectF(center.x() - radius, center.y() - radius, radius * 2, radius * 2);
     }
-}
-
-void
-Scene::generateGuidelinesTriangles(
-    int spacingW, int spacingH, int columns, int rows, QPointF center)
-{
-    Q_UNUSED(columns);
-    QGraphicsItem* i = nullptr;
-
-    // generate the horizontal lines
-    for (int r = 0; r < rows; r++)
+    else if (mGuidelines.type() == "Triangles")
     {
-        qreal height = (r + 1) * spacingH;
-        qreal offsetX = (r + 1) * spacingW / 2;
-
-        i = addLine(-offsetX + center.x(), height + center.y(), offsetX + center.x(),
-                    height + center.y());
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
+        qreal maxX = rows * spacingW / 2;
+        return QRectF(center.x() - maxX, center.y(), maxX * 2, rows * spacingH);
     }
 
-    // generate the slanted lines
-    qreal maxX = (rows)*spacingW / 2;
-    qreal maxY = (rows)*spacingH;
-    for (int c = 0; c < rows; c++)
-    {
-        qreal startX = -maxX + (2 * c * (maxX / rows));
-        qreal startY = maxY;
-        qreal endX = maxX - ((rows - c) * (maxX / rows));
-        qreal endY = c * maxY / rows;
+    return QRectF();
+}
 
-        i = addLine(startX + center.x(), startY + center.y(), endX + center.x(), endY + center.y());
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
-        i = addLine(-startX + center.x(), startY + center.y(), -endX + center.x(),
-                    endY + center.y());
-        i->setZValue(-1);
-        mGuidelinesLines.append(i);
-    }
+/**
+ * true if the bounding box of line, grown by the width of the pen, intersects rect.
+ */
+static bool
+lineCrosses(const QLineF& line, const QRectF& rect)
+{
+    return QRectF(line.p1(), line.p2()).normalized().adjusted(-1, -1, 1, 1).intersects(rect);
 }
 
-QList<QGraphicsItem*>
-Scene::sortItemsHorizontally(QList<QGraphicsItem*> unsortedItems, int sortEdge)
+void
+Scene::guidelineLines(const QRectF& rect, QVector<QLineF>* lines) const
 {
-    QList<QGraphicsItem*> sorted;
+    int columns = mGuidelines.columns();
+    int rows = mGuidelines.rows();
+    int spacingW = mGuidelines.cellWidth();
+    int spacingH = mGuidelines.cellHeight();
+    QPointF center = guidelinesCenter();
 
-    foreach (QGraphicsItem* item, unsortedItems)
+    if (spacingW <= 0 || spacingH <= 0 || columns < 0 || rows < 0)
+        return;
+    if (!guidelinesRect().adjusted(-1, -1, 1, 1).intersects(rect))
+        return;
+
+    if (mGuidelines.type() == "Rows")
     {
-        qreal edge = 0;
-        if (sortEdge == 2)
-        {
-            edge = item->sceneBoundingRect().center().x();
-        }
-        else if (sortEdge == 3)
+        qreal bottom = center.y() + spacingH * rows;
+        qreal right = center.x() + spacingW * columns;
+
+        // only the columns and rows inside rect.
+        int first = qMax(0, qFloor((rect.left() - center.x()) / spacingW));
+        int last = qMin(columns, qCeil((rect.right() - center.x()) / spacingW));
+        for (int c = first; c <= last; c++)
         {
-            edge = item->sceneBoundingRect().right();
-        }
-        else
-        {  // sortEdge == 1 or any other un-acceptable value.
-            edge = item->sceneBoundingRect().left();
+            qreal x = c * spacingW + center.x();
+            lines->append(QLineF(x, center.y(), x, bottom));
         }
 
-        // append the first item without question and move on to the second item.
-        if (sorted.count() <= 0)
+        first = qMax(0, qFloor((rect.top() - center.y()) / spacingH));
+        last = qMin(rows, qCeil((rect.bottom() - center.y()) / spacingH));
+        for (int r = first; r <= last; r++)
         {
-            sorted.append(item);
-            continue;
+            qreal y = r * spacingH + center.y();
+            lines->append(QLineF(center.x(), y, right, y));
         }
-
-        int sortedCount = sorted.count();
-        for (int i = 0; i < sortedCount; ++i)
+    }
+    else if (mGuidelines.type() == "Rounds")
+    {
+        // dividing lines
+        for (int c = 0; c <= columns && columns > 0; c++)
         {
-            qreal curSortedEdge = 0;
+            qreal radians = (360.0 / columns * c) * M_PI / 180;
+            qreal outterX = center.x() + (spacingH * (rows + 1)) /*distance*/ * sin(radians);
+            qreal outterY = center.y() + (spacingH * (rows + 1)) /*distance*/ * cos(radians);
 
-            if (sortEdge == 2)
-            {
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().center().x();
-            }
-            else if (sortEdge == 3)
-            {
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().right();
-            }
-            else
-            {  // sortEdge == 1 or any other un-acceptable value.
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().left();
-            }
+            qreal innerX = center.x() + spacingH * sin(radians);
+            qreal innerY = center.y() + spacingH * cos(radians);
 
-            if (edge < curSortedEdge)
-            {
-                sorted.insert(i, item);
-                break;
-            }
-            else if (i + 1 == sortedCount)
-            {
-                sorted.append(item);
-            }
+            QLineF line(innerX, innerY, outterX, outterY);
+            if (lineCrosses(line, rect))
+                lines->append(line);
         }
     }
-
-    return sorted;
-}
-
-QList<QGraphicsItem*>
-Scene::sortItemsVertically(QList<QGraphicsItem*> unsortedItems, int sortEdge)
-{
-    QList<QGraphicsItem*> sorted;
-
-    foreach (QGraphicsItem* item, unsortedItems)
+    else if (mGuidelines.type() == "Triangles")
     {
-        qreal edge = 0;
-        if (sortEdge == 2)
-        {
-            edge = item->sceneBoundingRect().center().y();
-        }
-        else if (sortEdge == 3)
+        // the horizontal lines
+        int first = qMax(0, qFloor((rect.top() - center.y()) / spacingH) - 1);
+        int last = qMin(rows - 1, qCeil((rect.bottom() - center.y()) / spacingH) - 1);
+        for (int r = first; r <= last; r++)
         {
-            edge = item->sceneBoundingRect().bottom();
-        }
-        else
-        {  // sortEdge == 1 or any other un-acceptable value.
-            edge = item->sceneBoundingRect().top();
-        }
+            qreal height = (r + 1) * spacingH;
+            qreal offsetX = (r + 1) * spacingW / 2;
 
-        // append the first item without question and move on to the second item.
-        if (sorted.count() <= 0)
-        {
-            sorted.append(item);
-            continue;
+            lines->append(QLineF(-offsetX + center.x(), height + center.y(),
+                                 offsetX + center.x(), height + center.y()));
         }
 
-        int sortedCount = sorted.count();
-        for (int i = 0; i < sortedCount; ++i)
+        // the slanted lines
+        qreal maxX = (rows)*spacingW / 2;
+        qreal maxY = (rows)*spacingH;
+        for (int c = 0; c < rows; c++)
         {
-            qreal curSortedEdge = 0;
-
-            if (sortEdge == 2)
-            {
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().center().y();
-            }
-            else if (sortEdge == 3)
-            {
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().bottom();
-            }
-            else
-            {  // sortEdge == 1 or any other un-acceptable value.
-                curSortedEdge = sorted.at(i)->sceneBoundingRect().top();
-            }
-
-            if (edge < curSortedEdge)
-            {
-                sorted.insert(i, item);
-                break;
-            }
-            else if (i + 1 == sortedCount)
-            {
-                sorted.append(item);
-            }
+            qreal startX = -maxX + (2 * c * (maxX / rows));
+            qreal startY = maxY;
+            qreal endX = maxX - ((rows - c) * (maxX / rows));
+            qreal endY = c * maxY / rows;
+
+            QLineF left(startX + center.x(), startY + center.y(), endX + center.x(),
+                        endY + center.y());
+            QLineF right(-startX + center.x(), startY + center.y(), -endX + center.x(),
+                         endY + center.y());
+            if (lineCrosses(left, rect))
+                lines->append(left);
+            if (lineCrosses(right, rect))
+                lines->append(right);
         }
     }
+}
 
-    return sorted;
+void
+Scene::drawGuidelines(QPainter* painter, const QRectF& rect) const
+{
+    if (mGuidelines.type() == "None")
+        return;
+
+    QVector<QLineF> lines;
+    guidelineLines(rect, &lines);
+
+    painter->save();
+    painter->setPen(QPen());
+    painter->drawLines(lines);
+    painter->restore();
 }
 
-QRectF
-Scene::selectionBoundingRect(QList<QGraphicsItem*> items, int vertical, int horizontal)
+/**
+ * edge: 1 = left; 2 = center; 3 = right, anything else is left.
+ */
+static qreal
+horizontalEdge(const QRectF& rect, int edge)
 {
-    qreal left = sceneRect().right();
-    qreal right = sceneRect().left();
-    qreal top = sceneRect().bottom();
-    qreal bottom = sceneRect().top();
+    if (edge == 2)
+        return rect.center().x();
+    else if (edge == 3)
+        return rect.right();
+    return rect.left();
+}
 
-    QRectF topLeft(QPointF(left, top), QPointF(right, bottom)),
-        center(QPointF(left, top), QPointF(right, bottom)),
-        bottomRight(QPointF(left, top), QPointF(right, bottom)), final;
+/**
+ * edge: 1 = top; 2 = center; 3 = bottom, anything else is top.
+ */
+static qreal
+verticalEdge(const QRectF& rect, int edge)
+{
+    if (edge == 2)
+        return rect.center().y();
+    else if (edge == 3)
+        return rect.bottom();
+    return rect.top();
+}
 
-    foreach (QGraphicsItem* i, items)
+/**
+ * the indexes of rects sorted by an edge, rects with the same edge keep their order.
+ */
+static QVector<int>
+sortedIndexes(const QVector<QRectF>& rects, bool horizontal, int sortEdge)
+{
+    QVector<qreal> edges(rects.count());
+    QVector<int> order(rects.count());
+    for (int i = 0; i < rects.count(); ++i)
     {
-        // Set the left edges of the 3 possible Rects.
-        if (i->sceneBoundingRect().left() < topLeft.left())
-            topLeft.setLeft(i->sceneBoundingRect().left());
-        if (i->sceneBoundingRect().center().x() < center.left())
-            center.setLeft(i->sceneBoundingRect().center().x());
-        if (i->sceneBoundingRect().right() < bottomRight.left())
-            bottomRight.setLeft(i->sceneBoundingRect().right());
-
-        // Set the right edges of the 3 possible Rects.
-        if (i->sceneBoundingRect().left() > topLeft.right())
-            topLeft.setRight(i->sceneBoundingRect().left());
-        if (i->sceneBoundingRect().center().x() > center.right())
-            center.setRight(i->sceneBoundingRect().center().x());
-        if (i->sceneBoundingRect().right() > bottomRight.right())
-            bottomRight.setRight(i->sceneBoundingRect().right());
-
-        // Set the top edges of the 3 possible Rects.
-        if (i->sceneBoundingRect().top() < topLeft.top())
-            topLeft.setTop(i->sceneBoundingRect().top());
-        if (i->sceneBoundingRect().center().y() < center.top())
-            center.setTop(i->sceneBoundingRect().center().y());
-        if (i->sceneBoundingRect().bottom() < bottomRight.top())
-            bottomRight.setTop(i->sceneBoundingRect().bottom());
-
-        // Set the bottom edges of the 3 possible Rects.
-        if (i->sceneBoundingRect().top() > topLeft.bottom())
-            topLeft.setBottom(i->sceneBoundingRect().top());
-        if (i->sceneBoundingRect().center().y() > center.bottom())
-            center.setBottom(i->sceneBoundingRect().center().y());
-        if (i->sceneBoundingRect().bottom() > bottomRight.bottom())
-            bottomRight.setBottom(i->sceneBoundingRect().bottom());
-    }
-
-    switch (horizontal)
-    {
-    case 0:
-        final.setLeft(topLeft.left());
-        final.setRight(bottomRight.right());
-        break;
+        edges[i] = horizontal ? horizontalEdge(rects.at(i), sortEdge)
+                              : verticalEdge(rects.at(i), sortEdge);
+        order[i] = i;
+    }
 
-    case 1:
-        final.setLeft(topLeft.left());
-        final.setRight(topLeft.right());
-        break;
+    std::stable_sort(order.begin(), order.end(),
+                     [&edges](int a, int b) { return edges.at(a) < edges.at(b); });
+    return order;
+}
 
-    case 2:
-        final.setLeft(center.left());
-        final.setRight(center.right());
-        break;
+static QList<QGraphicsItem*>
+sortedItems(const QList<QGraphicsItem*>& items, bool horizontal, int sortEdge)
+{
+    QList<QGraphicsItem*> sorted;
+    sorted.reserve(items.count());
+    foreach (int i, sortedIndexes(sceneRects(items), horizontal, sortEdge))
+        sorted.append(items.at(i));
+    return sorted;
+}
 
-    case 3:
-        final.setLeft(bottomRight.left());
-        final.setRight(bottomRight.right());
-        break;
-    }
+QList<QGraphicsItem*>
+Scene::sortItemsHorizontally(QList<QGraphicsItem*> unsortedItems, int sortEdge)
+{
+    return sortedItems(unsortedItems, true, sortEdge);
+}
 
-    switch (vertical)
+QList<QGraphicsItem*>
+Scene::sortItemsVertically(QList<QGraphicsItem*> unsortedItems, int sortEdge)
+{
+    return sortedItems(unsortedItems, false, sortEdge);
+}
+
+/**
+ * see Scene::selectionBoundingRect(), the extremes start at the opposite sides of sceneRect.
+ */
+static QRectF
+boundingRectOf(const QVector<QRectF>& rects, const QRectF& sceneRect, int vertical, int horizontal)
+{
+    // the smallest and largest of each edge, [0] = left/top, [1] = center, [2] = right/bottom.
+    qreal minX[3], maxX[3], minY[3], maxY[3];
+    for (int e = 0; e < 3; ++e)
     {
-    case 0:
-        final.setTop(topLeft.top());
-        final.setBottom(bottomRight.bottom());
-        break;
+        minX[e] = sceneRect.right();
+        maxX[e] = sceneRect.left();
+        minY[e] = sceneRect.bottom();
+        maxY[e] = sceneRect.top();
+    }
 
-    case 1:
-        final.setTop(topLeft.top());
-        final.setBottom(topLeft.bottom());
-        break;
+    foreach (const QRectF& r, rects)
+    {
+        for (int e = 0; e < 3; ++e)
+        {
+            qreal x = horizontalEdge(r, e + 1);
+            qreal y = verticalEdge(r, e + 1);
+            minX[e] = qMin(minX[e], x);
+            maxX[e] = qMax(maxX[e], x);
+            minY[e] = qMin(minY[e], y);
+            maxY[e] = qMax(maxY[e], y);
+        }
+    }
 
-    case 2:
-        final.setTop(center.top());
-        final.setBottom(center.bottom());
-        break;
+    QRectF final;
 
-    case 3:
-        final.setTop(bottomRight.top());
-        final.setBottom(bottomRight.bottom());
-        break;
+    if (horizontal == 0)
+    {
+        final.setLeft(minX[0]);
+        final.setRight(maxX[2]);
+    }
+    else if (horizontal >= 1 && horizontal <= 3)
+    {
+        final.setLeft(minX[horizontal - 1]);
+        final.setRight(maxX[horizontal - 1]);
     }
 
-    // For Debugging:
-    // addRect(topLeft, QPen(QColor(Qt::red)));
-    // addRect(center, QPen(QColor(Qt::green)));
-    // addRect(bottomRight, QPen(QColor(Qt::blue)));
-    // addRect(final, QPen(QColor(Qt::black)));
+    if (vertical == 0)
+    {
+        final.setTop(minY[0]);
+        final.setBottom(maxY[2]);
+    }
+    else if (vertical >= 1 && vertical <= 3)
+    {
+        final.setTop(minY[vertical - 1]);
+        final.setBottom(maxY[vertical - 1]);
+    }
 
     return final;
 }
 
+QRectF
+Scene::selectionBoundingRect(QList<QGraphicsItem*> items, int vertical, int horizontal)
+{
+    return boundingRectOf(sceneRects(items), sceneRect(), vertical, horizontal);
+}
+
 void
 Scene::distribute(int vertical, int horizontal)
 {
-    QList<QGraphicsItem*> unsorted = selectedItems();
-    QList<QGraphicsItem*> sortedH;
-    QList<QGraphicsItem*> sortedV;
+    QList<QGraphicsItem*> items = selectedItems();
+    if (items.count() < 2)
+        return;
 
-    sortedH = sortItemsHorizontally(unsorted, horizontal);
-    sortedV = sortItemsVertically(unsorted, vertical);
-    /*
-        qDebug() << unsorted;
-        qDebug() << "\n\n============================================================\n\n";
-        qDebug() << sortedH;
-        qDebug() << "\n\n============================================================\n\n";
-        qDebug() << sortedV;
-    */
-    QRectF selectionRect = selectionBoundingRect(unsorted, vertical, horizontal);
-    qreal spaceH = selectionRect.width() / (sortedH.count() - 1);
-    qreal spaceV = selectionRect.height() / (sortedV.count() - 1);
+    QVector<QRectF> rects = sceneRects(items);
 
-    undoStack()->beginMacro("distribute selection");
+    // where each item comes in the horizontal and the vertical order.
+    QVector<int> idxX(items.count());
+    QVector<int> idxY(items.count());
+    QVector<int> sortedH = sortedIndexes(rects, true, horizontal);
+    QVector<int> sortedV = sortedIndexes(rects, false, vertical);
+    for (int i = 0; i < items.count(); ++i)
+    {
+        idxX[sortedH.at(i)] = i;
+        idxY[sortedV.at(i)] = i;
+    }
+
+    QRectF selectionRect = boundingRectOf(rects, sceneRect(), vertical, horizontal);
+    qreal spaceH = selectionRect.width() / (items.count() - 1);
+    qreal spaceV = selectionRect.height() / (items.count() - 1);
 
-    // go through all cells and adjust them based on the sorting done above.
-    foreach (QGraphicsItem* i, unsorted)
+    QVector<QPointF> positions;
+    positions.reserve(items.count());
+    for (int idx = 0; idx < items.count(); ++idx)
     {
-        QPointF oldPos = i->pos();
-        qreal newX = 0, newY = 0;
+        QPointF oldPos = items.at(idx)->pos();
+        const QRectF& r = rects.at(idx);
+        qreal newX = oldPos.x();
+        qreal newY = oldPos.y();
         qreal offsetX = 0, offsetY = 0;
 
         if (vertical == 2)
-        {
-            offsetY = i->sceneBoundingRect().height() / 2;
-        }
+            offsetY = r.height() / 2;
         else if (vertical == 3)
-        {
-            offsetY = i->sceneBoundingRect().height();
-        }
+            offsetY = r.height();
 
         if (horizontal == 2)
-        {
-            offsetX = i->sceneBoundingRect().width() / 2;
-        }
+            offsetX = r.width() / 2;
         else if (horizontal == 3)
-        {
-            offsetX = i->sceneBoundingRect().width();
-        }
+            offsetX = r.width();
 
-        int idxX = sortedH.indexOf(i);
-        int idxY = sortedV.indexOf(i);
+        if (horizontal != 0)
+            newX += (selectionRect.left() + (idxX.at(idx) * spaceH)) - offsetX - r.x();
 
-        if (horizontal == 0)
-        {
-            newX = oldPos.x();
-        }
-        else
-        {
-            newX = i->pos().x()
-                   + ((selectionRect.left() + (idxX * spaceH)) - offsetX
-                      - i->sceneBoundingRect().x());
-        }
+        if (vertical != 0)
+            newY += (selectionRect.top() + (idxY.at(idx) * spaceV)) - offsetY - r.y();
 
-        if (vertical == 0)
-        {
-            newY = oldPos.y();
-        }
-        else
-        {
-            newY = i->pos().y()
-                   + ((selectionRect.top() + (idxY * spaceV)) - offsetY
-                      - i->sceneBoundingRect().y());
-        }
-
-        i->setPos(newX, newY);
-
-        undoStack()->push(new SetItemCoordinates(i, oldPos));
+        positions.append(QPointF(newX, newY));
     }
-    undoStack()->endMacro();
+
+    SetItemsCoordinates* move = new SetItemsCoordinates(items, positions);
+    move->setText(tr("distribute selection"));
+    undoStack()->push(move);
 }
 
 void
@@ -2417,6 +2453,18 @@ Scene::resizeScene(QRectF size)
     setSceneRect(size);
 }
 
+/**
+ * the stitch called name, or the default stitch if there isn't one.
+ */
+static Stitch*
+findStitchOrDefault(const QString& name)
+{
+    Stitch* s = StitchLibrary::inst()->findStitch(name);
+    if (!s)
+        s = StitchLibrary::inst()->findStitch(Settings::inst()->value("defaultStitch").toString());
+    return s;
+}
+
 void
 Scene::createRowsChart(int rows, int cols, QString defStitch, QSizeF rowSize)
 {
@@ -2454,24 +2502,36 @@ Scene::arrangeGrid(QSize grd, QSize alignment, QSize spacing, bool useSelection)
         // create new cells.
         // TODO: figure out how to deal with spacing.
 
-        for (int x = grd.width(); x > 0; --x)
+        // FIXME: use the user selected stitch
+        Stitch* s = findStitchOrDefault(mDefaultStitch);
+        if (!s)
+            return;
+
+        unsigned int layer = getCurrentLayer()->uid();
+        qreal columnWidth = s->width() + spacing.width();
+
+        // the top row is the last row of the grid.
+        QList<QList<Cell*> > rows;
+        for (int x = 1; x <= grd.width(); ++x)
         {
+            bool alternate = (grd.width() - x) % 2;
+            qreal top = spacing.height() * x;
+
             QList<Cell*> r;
+            r.reserve(grd.height());
             for (int y = grd.height(); y > 0; --y)
             {
                 Cell* c = new Cell();
-                // FIXME: use the user selected stitch
-                c->setStitch(mDefaultStitch);
-                c->setLayer(getCurrentLayer()->uid());
-                addItem(c);
+                c->setStitch(s);
+                c->setLayer(layer);
+                c->useAlternateRenderer(alternate);
+                c->setPos(columnWidth * y, top);
                 r.append(c);
-
-                c->useAlternateRenderer(((grd.width() - x) % 2));
-                c->setPos((c->stitch()->width() + spacing.width()) * y, spacing.height() * x);
             }
-
-            grid.insert(0, r);
+            rows.append(r);
         }
+
+        addRows(0, rows);
     }
 }
 
@@ -2480,12 +2540,18 @@ Scene::gridAddRow(QList<Cell*> row, bool append, int before)
 {
     if (append)
     {
+        mRowsModel->beginInsertRows(QModelIndex(), grid.count(), grid.count());
         grid.append(row);
+        mRowsModel->endInsertRows();
     }
     else
     {
         if (grid.length() >= before)
+        {
+            mRowsModel->beginInsertRows(QModelIndex(), before, before);
             grid.insert(before, row);
+            mRowsModel->endInsertRows();
+        }
     }
 }
 
@@ -2512,7 +2578,7 @@ Scene::propertiesUpdate(QString property, QVariant newValue)
     else
     {  // all options that require operations on a per stitch level.
 
-        if (selectedItems().count() <= 0)
+        if (selectionCount() <= 0)
             return;
 
         IndicatorProperties ip;
@@ -2617,12 +2683,8 @@ Scene::propertiesUpdate(QString property, QVariant newValue)
 void
 Scene::updateDefaultStitchColor(QColor originalColor, QColor newColor)
 {
-    foreach (QGraphicsItem* item, items())
+    foreach (Cell* c, cellsWithColor(originalColor))
     {
-        if (item->type() != Cell::Type)
-            continue;
-
-        Cell* c = qgraphicsitem_cast<Cell*>(item);
         if (c->color() == originalColor)
             c->setColor(newColor);
     }
@@ -2714,18 +2776,17 @@ Scene::showProperties()
 void
 Scene::copy(int direction)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
     QRectF rect = selectedItemsBoundingRect(selectedItems());
     QList<QGraphicsItem*> list = selectedItems();
+    QList<QGraphicsItem*> copies;
 
     blockSignals(true);
 
-    clearSelection();
-    // TODO setSelected is extremely slow, optimize that
     undoStack()->beginMacro("copy selection");
     if (direction == 1)
     {  // left
@@ -2733,7 +2794,7 @@ Scene::copy(int direction)
         {
             QGraphicsItem* ret = copy_rec(item, QPointF(-rect.width(), 0));
             if (ret)
-                ret->setSelected(true);
+                copies.append(ret);
         }
     }
     else if (direction == 2)
@@ -2742,7 +2803,7 @@ Scene::copy(int direction)
         {
             QGraphicsItem* ret = copy_rec(item, QPointF(rect.width(), 0));
             if (ret)
-                ret->setSelected(true);
+                copies.append(ret);
         }
     }
     else if (direction == 3)
@@ -2751,7 +2812,7 @@ Scene::copy(int direction)
         {
             QGraphicsItem* ret = copy_rec(item, QPointF(0, -rect.height()));
             if (ret)
-                ret->setSelected(true);
+                copies.append(ret);
         }
     }
     else if (direction == 4)
@@ -2760,13 +2821,13 @@ Scene::copy(int direction)
         {
             QGraphicsItem* ret = copy_rec(item, QPointF(0, rect.height()));
             if (ret)
-                ret->setSelected(true);
+                copies.append(ret);
         }
     }
 
     blockSignals(false);
 
-    emit selectionChanged();
+    setSelection(copies);
 
     updateSceneRect();
     undoStack()->endMacro();
@@ -2815,17 +2876,16 @@ Scene::mirror_rec(
 void
 Scene::mirror(int direction)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
 
     QRectF rect = selectedItemsBoundingRect(selectedItems());
     QList<QGraphicsItem*> list = selectedItems();
+    QList<QGraphicsItem*> copies;
 
     blockSignals(true);
 
-    clearSelection();
-
     undoStack()->beginMacro("mirror selection");
     if (direction == 1)
     {  // left
@@ -2834,7 +2894,7 @@ Scene::mirror(int direction)
         {
             QGraphicsItem* mir = mirror_rec(item, QPointF(-rect.width(), 0), rect, true, false);
             if (mir)
-                mir->setSelected(true);
+                copies.append(mir);
         }
     }
     else if (direction == 2)
@@ -2844,7 +2904,7 @@ Scene::mirror(int direction)
         {
             QGraphicsItem* mir = mirror_rec(item, QPointF(rect.width(), 0), rect, true, false);
             if (mir)
-                mir->setSelected(true);
+                copies.append(mir);
         }
     }
     else if (direction == 3)
@@ -2854,7 +2914,7 @@ Scene::mirror(int direction)
         {
             QGraphicsItem* mir = mirror_rec(item, QPointF(0, -rect.height()), rect, false, true);
             if (mir)
-                mir->setSelected(true);
+                copies.append(mir);
         }
     }
     else if (direction == 4)
@@ -2864,14 +2924,14 @@ Scene::mirror(int direction)
         {
             QGraphicsItem* mir = mirror_rec(item, QPointF(0, rect.height()), rect, false, true);
             if (mir)
-                mir->setSelected(true);
+                copies.append(mir);
         }
     }
     updateSceneRect();
 
     blockSignals(false);
 
-    emit selectionChanged();
+    setSelection(copies);
 
     updateSceneRect();
     undoStack()->endMacro();
@@ -2881,7 +2941,7 @@ Scene::mirror(int direction)
 void
 Scene::rotate(qreal degrees)
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     undoStack()->push(new SetSelectionRotation(this, selectedItems(), degrees));
@@ -2890,117 +2950,80 @@ Scene::rotate(qreal degrees)
 void
 Scene::copy()
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
-    QByteArray copyData;
-    QDataStream stream(&copyData, QIODevice::WriteOnly);
-    QMimeData* mimeData = new QMimeData;
-
-    stream << selectedItems().count();
-    copyRecursively(stream, selectedItems());
-
-    mimeData->setData("application/crochet-cells", copyData);
+    // the clipboard data is only encoded when something asks for it.
+    ChartMimeData* mimeData = new ChartMimeData;
+    mimeData->addItems(selectedItems());
     QApplication::clipboard()->setMimeData(mimeData);
 }
 
-void
-Scene::copyRecursively(QDataStream& stream, QList<QGraphicsItem*> items)
-{
-    foreach (QGraphicsItem* item, items)
-    {
-        stream << item->type();
-
-        switch (item->type())
-        {
-        case Cell::Type:
-        {
-            Cell* c = qgraphicsitem_cast<Cell*>(item);
-            stream << c->name() << c->color() << c->bgColor() << ChartItemTools::getRotation(c)
-                   << ChartItemTools::getRotationPivot(c) << ChartItemTools::getScaleX(c)
-                   << ChartItemTools::getScaleY(c) << ChartItemTools::getScalePivot(c)
-                   << c->transformOriginPoint() << c->pos();
-            break;
-        }
-        case Indicator::Type:
-        {
-            Indicator* i = qgraphicsitem_cast<Indicator*>(item);
-            stream << i->scenePos() << i->text() << ChartItemTools::getRotation(i)
-                   << ChartItemTools::getRotationPivot(i) << ChartItemTools::getScaleX(i)
-                   << ChartItemTools::getScaleY(i) << ChartItemTools::getScalePivot(i);
-            break;
-        }
-        case ItemGroup::Type:
-        {
-            ItemGroup* group = qgraphicsitem_cast<ItemGroup*>(item);
-            ChartItemTools::recalculateTransformations(group);
-            stream << group->pos() << group->childItems().count()
-                   << ChartItemTools::getRotation(group) << ChartItemTools::getRotationPivot(group)
-                   << ChartItemTools::getScaleX(group) << ChartItemTools::getScaleY(group)
-                   << ChartItemTools::getScalePivot(group);
-
-            QList<QGraphicsItem*> childs = group->childItems();
-
-            foreach (QGraphicsItem* child, childs)
-            {
-                group->removeFromGroup(child);
-                ChartItemTools::recalculateTransformations(child);
-            }
-
-            copyRecursively(stream, childs);
-
-            foreach (QGraphicsItem* child, childs)
-            {
-                group->addToGroup(child);
-            }
-            break;
-        }
-        case ChartImage::Type:
-        {
-            ChartImage* image = qgraphicsitem_cast<ChartImage*>(item);
-
-            stream << image->filename() << image->pos() << ChartItemTools::getRotation(image)
-                   << ChartItemTools::getRotationPivot(image) << ChartItemTools::getScaleX(image)
-                   << ChartItemTools::getScaleY(image) << ChartItemTools::getScalePivot(image);
-            break;
-        }
-        case Guideline::Type:
-            qDebug() << "guideline";
-        default:
-            WARN("Unknown data type: " + QString::number(item->type()));
-            break;
-        }
-    }
-}
-
 void
 Scene::paste()
 {
     const QMimeData* mimeData = QApplication::clipboard()->mimeData();
+    if (!mimeData || !mimeData->hasFormat(ChartMimeData::format))
+        return;
 
-    QByteArray pasteData = mimeData->data("application/crochet-cells");
-    QDataStream stream(&pasteData, QIODevice::ReadOnly);
+    QPointF offSet;
+    QString pasteOS = Settings::inst()->value("pasteOffset").toString();
+    if (pasteOS == tr("Up and Left"))
+        offSet = QPointF(-10, -10);
+    else if (pasteOS == tr("Up and Right"))
+        offSet = QPointF(10, -10);
+    else if (pasteOS == tr("Down and Left"))
+        offSet = QPointF(-10, 10);
+    else if (pasteOS == tr("Down and Right"))
+        offSet = QPointF(10, 10);
+    else
+        offSet = QPointF(0, 0);
 
-    clearSelection();
+    // data copied in this application is read as it is, from another one it's decoded first.
+    const ChartMimeData* chartData = qobject_cast<const ChartMimeData*>(mimeData);
+    ChartMimeData decoded;
+    QByteArray pasteData;
+    if (!chartData)
+    {
+        pasteData = mimeData->data(ChartMimeData::format);
+        if (decoded.decode(pasteData))
+            chartData = &decoded;
+        else if (ChartMimeData::isEncoded(pasteData))
+            return;  // a damaged copy, the old format can't make sense of it either.
+    }
 
     undoStack()->beginMacro("paste items");
-    int count = 0;
-    stream >> count;
 
     // disable signals for performance
     blockSignals(true);
 
     QList<QGraphicsItem*> items;
-    for (int i = 0; i < count; ++i)
+    if (chartData)
     {
-        pasteRecursively(stream, &items);
+        int index = 0;
+        int cursor = 0;
+        int count = chartData->records().count();
+        for (int i = 0; i < chartData->topLevelCount() && index < count; ++i)
+        {
+            pasteRecord(*chartData, &index, &cursor, &items, offSet);
+        }
     }
+    else
+    {
+        QDataStream stream(&pasteData, QIODevice::ReadOnly);
+        int count = 0;
+        stream >> count;
 
-    foreach (QGraphicsItem* item, items)
-        item->setSelected(true);
+        for (int i = 0; i < count; ++i)
+        {
+            if (stream.status() != QDataStream::Ok || stream.atEnd())
+                break;
+            pasteRecursively(stream, &items, offSet);
+        }
+    }
 
     // if we need to center around the mouse
-    if (Settings::inst()->value("pasteOffset").toString().compare(tr("On mouse cursor")) == 0)
+    if (pasteOS.compare(tr("On mouse cursor")) == 0)
     {
         if (items.count() > 0)
         {
@@ -3027,14 +3050,11 @@ Scene::paste()
     }
 
     // finally, snap each pasted object on the grid
-    foreach (QGraphicsItem* item, items)
-    {
-        snapGraphicsItemToGrid(*item);
-    }
+    snapItemsToGrid(items);
 
     blockSignals(false);
 
-    emit selectionChanged();
+    setSelection(items);
 
     undoStack()->endMacro();
 }
@@ -3082,32 +3102,135 @@ Scene::deleteSelection()
             break;
         }
     }
-    blockSignals(false);
+    blockSignals(false);
+
+    // signals were blocked so we manually emit them
+    emit selectionChanged();
+
+    undoStack()->endMacro();
+}
+
+/**
+ * set the transform stored for an item in the clipboard.
+ */
+static void
+applyTransform(QGraphicsItem* item, const ChartMimeData::Transform& t)
+{
+    item->setTransformOriginPoint(t.origin);
+    ChartItemTools::setRotation(item, t.rotation);
+    ChartItemTools::setScaleX(item, t.scaleX);
+    ChartItemTools::setScaleY(item, t.scaleY);
+    ChartItemTools::setScalePivot(item, t.scalePivot, false);
+    ChartItemTools::setRotationPivot(item, t.rotationPivot, false);
+}
+
+void
+Scene::pasteRecord(const ChartMimeData& data,
+                   int* index,
+                   int* cursor,
+                   QList<QGraphicsItem*>* group,
+                   const QPointF& offSet)
+{
+    const ChartMimeData::Record& r = data.records().at((*index)++);
+    ChartMimeData::Transform t = data.transform(r, cursor);
+
+    switch (r.type)
+    {
+    case ChartMimeData::CellItem:
+    {
+        Cell* c = new Cell();
+        undoStack()->push(new AddItem(this, c));
+        c->setPos(r.pos + offSet);
+        c->setStitch(data.string(r.key));
+        c->setColor(data.color(r.color));
+        c->setBgColor(data.color(r.bgColor));
+        c->setLayer(getCurrentLayer()->uid());
+        applyTransform(c, t);
+
+        c->setSelected(false);
+        group->append(c);
+        break;
+    }
+    case ChartMimeData::IndicatorItem:
+    {
+        Indicator* i = new Indicator();
+        // FIXME: add this indicator to the undo stack.
+        i->setText(data.string(r.key));
+        addItem(i);
+        i->setPos(r.pos + offSet);
+        i->setLayer(getCurrentLayer()->uid());
+
+        i->setSelected(false);
+        // only cells have their transform origin copied.
+        t.origin = i->transformOriginPoint();
+        applyTransform(i, t);
+
+        group->append(i);
+        break;
+    }
+    case ChartMimeData::GroupItem:
+    {
+        QList<QGraphicsItem*> items;
+        int count = data.records().count();
+        for (quint32 i = 0; i < r.key && *index < count; ++i)
+        {
+            pasteRecord(data, index, cursor, &items, offSet);
+        }
+
+        GroupItems* grpItems = new GroupItems(this, items);
+        undoStack()->push(grpItems);
+        ItemGroup* g = grpItems->group();
+        g->setSelected(false);
+
+        group->append(g);
+
+        foreach (QGraphicsItem* child, items)
+        {
+            g->removeFromGroup(child);
+        }
+
+        g->setPos(r.pos);
+        t.origin = g->transformOriginPoint();
+        applyTransform(g, t);
+
+        foreach (QGraphicsItem* child, items)
+        {
+            g->addToGroup(child);
+        }
+
+        g->setLayer(getCurrentLayer()->uid());
+        break;
+    }
+    case ChartMimeData::ImageItem:
+    {
+        ChartImage* image = new ChartImage(data.string(r.key));
 
-    // signals were blocked so we manually emit them
-    emit selectionChanged();
+        undoStack()->push(new AddItem(this, image));
+        image->setPos(r.pos);
+        image->setLayer(getCurrentLayer()->uid());
+        t.origin = image->transformOriginPoint();
+        applyTransform(image, t);
 
-    undoStack()->endMacro();
+        group->append(image);
+        image->setSelected(false);
+        break;
+    }
+    default:
+    {
+        WARN("Unknown data type: " + QString::number(r.type));
+        break;
+    }
+    }
 }
 
 void
-Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
+Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group, const QPointF& offSet)
 {
-    QPointF offSet;
-    QString pasteOS = Settings::inst()->value("pasteOffset").toString();
-    if (pasteOS == tr("Up and Left"))
-        offSet = QPointF(-10, -10);
-    else if (pasteOS == tr("Up and Right"))
-        offSet = QPointF(10, -10);
-    else if (pasteOS == tr("Down and Left"))
-        offSet = QPointF(-10, 10);
-    else if (pasteOS == tr("Down and Right"))
-        offSet = QPointF(10, 10);
-    else
-        offSet = QPointF(0, 0);
-
-    int type;
+    int type = 0;
     stream >> type;
+    if (stream.status() != QDataStream::Ok)
+        return;
+
     switch (type)
     {
     case Cell::Type:
@@ -3119,6 +3242,8 @@ Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
 
         stream >> name >> color >> bgColor >> rotation >> pivotRotation;
         stream >> scaleX >> scaleY >> pivotScale >> transPoint >> pos;
+        if (stream.status() != QDataStream::Ok)
+            break;
 
         pos += offSet;
 
@@ -3143,14 +3268,17 @@ Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
     }
     case Indicator::Type:
     {
-        Indicator* i = new Indicator();
-        // FIXME: add this indicator to the undo stack.
         QPointF pos, pivotScale, pivotRotation;
         QString text;
         qreal rotation, scaleX, scaleY;
 
         stream >> pos >> text >> rotation >> pivotRotation >> scaleX;
         stream >> scaleY >> pivotScale;
+        if (stream.status() != QDataStream::Ok)
+            break;
+
+        Indicator* i = new Indicator();
+        // FIXME: add this indicator to the undo stack.
 
         pos += offSet;
         i->setText(text);
@@ -3177,10 +3305,15 @@ Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
 
         stream >> pos >> childCount >> rotation >> pivotRotation >> scaleX;
         stream >> scaleY >> pivotScale;
+        if (stream.status() != QDataStream::Ok)
+            break;
+
         QList<QGraphicsItem*> items;
         for (int i = 0; i < childCount; ++i)
         {
-            pasteRecursively(stream, &items);
+            if (stream.status() != QDataStream::Ok || stream.atEnd())
+                break;
+            pasteRecursively(stream, &items, offSet);
         }
 
         GroupItems* grpItems = new GroupItems(this, items);
@@ -3217,6 +3350,8 @@ Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
         QString filename;
 
         stream >> filename >> pos >> rotation >> pivotRotation >> scaleX >> scaleY >> pivotScale;
+        if (stream.status() != QDataStream::Ok)
+            break;
 
         ChartImage* image = new ChartImage(filename);
 
@@ -3245,7 +3380,7 @@ Scene::pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group)
 void
 Scene::cut()
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     copy();
@@ -3287,6 +3422,26 @@ Scene::cut()
     undoStack()->endMacro();
 }
 
+QList<QGraphicsItem*>
+Scene::selectedItemsInStackingOrder()
+{
+    QList<QGraphicsItem*> selected;
+    foreach (QGraphicsItem* item, items(Qt::AscendingOrder))
+    {
+        // grouped items are selected through their group.
+        for (QGraphicsItem* i = item; i; i = i->parentItem())
+        {
+            if (i->isSelected())
+            {
+                selected.append(item);
+                break;
+            }
+        }
+    }
+
+    return selected;
+}
+
 QRectF
 Scene::selectedItemsBoundingRect(QList<QGraphicsItem*> items)
 {
@@ -3324,12 +3479,150 @@ Scene::selectedItemsBoundingRect(QList<QGraphicsItem*> items)
 void
 Scene::group()
 {
-    if (selectedItems().count() <= 1)
+    if (selectionCount() <= 1)
         return;
 
     undoStack()->push(new GroupItems(this, selectedItems()));
 }
 
+/**
+ * the items that report their selection to trackSelection, the others aren't in mSelection.
+ */
+static bool
+tracksSelection(QGraphicsItem* item)
+{
+    switch (item->type())
+    {
+    case Cell::Type:
+    case Indicator::Type:
+    case ItemGroup::Type:
+    case ChartImage::Type:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void
+Scene::setSelection(const QList<QGraphicsItem*>& items, bool add)
+{
+    QSet<QGraphicsItem*> selection = items.toSet();
+    QList<QGraphicsItem*> deselected;
+    QList<QGraphicsItem*> selected;
+
+    if (!add)
+    {
+        foreach (QGraphicsItem* item, selectedItems())
+        {
+            if (!selection.contains(item))
+                deselected.append(item);
+        }
+    }
+
+    foreach (QGraphicsItem* item, selection)
+    {
+        if (item->isSelected() || item->scene() != this
+            || !(item->flags() & QGraphicsItem::ItemIsSelectable))
+            continue;
+        selected.append(item);
+    }
+
+    if (deselected.isEmpty() && selected.isEmpty())
+        return;
+
+    // the items don't report their changes one at a time, the selection and its properties are
+    // updated once they're all done and the signal is sent once. The signal may already be
+    // blocked by the caller.
+    bool blocked = blockSignals(true);
+    mBatchingSelection = true;
+
+    foreach (QGraphicsItem* item, deselected)
+        item->setSelected(false);
+    foreach (QGraphicsItem* item, selected)
+        item->setSelected(true);
+
+    mBatchingSelection = false;
+    blockSignals(blocked);
+
+    foreach (QGraphicsItem* item, deselected)
+    {
+        if (!item->isSelected() && mSelection.remove(item))
+            mSelectionProperties.remove(item);
+    }
+
+    mSelection.reserve(mSelection.count() + selected.count());
+    foreach (QGraphicsItem* item, selected)
+    {
+        // selecting a child of a group selects the group, hidden and disabled items aren't
+        // selected at all.
+        QGraphicsItem* target = item->group() ? item->group() : item;
+        if (!target->isSelected() || !tracksSelection(target) || mSelection.contains(target))
+            continue;
+        mSelection.insert(target);
+        mSelectionProperties.add(target);
+    }
+
+    emit selectionChanged();
+}
+
+void
+Scene::trackSelection(QGraphicsItem* item,
+                      QGraphicsItem::GraphicsItemChange change,
+                      const QVariant& value)
+{
+    switch (change)
+    {
+    case QGraphicsItem::ItemSelectedHasChanged:
+    {
+        Scene* s = qobject_cast<Scene*>(item->scene());
+        if (!s || s->mBatchingSelection)
+            break;
+        if (value.toBool())
+        {
+            s->mSelection.insert(item);
+            s->mSelectionProperties.add(item);
+        }
+        else
+        {
+            s->mSelection.remove(item);
+            s->mSelectionProperties.remove(item);
+        }
+        break;
+    }
+    case QGraphicsItem::ItemSceneChange:
+    {
+        // items keep their selected state when they leave a scene.
+        Scene* s = qobject_cast<Scene*>(item->scene());
+        if (s)
+        {
+            s->mSelection.remove(item);
+            s->mSelectionProperties.remove(item);
+        }
+        break;
+    }
+    case QGraphicsItem::ItemSceneHasChanged:
+    {
+        Scene* s = qobject_cast<Scene*>(value.value<QGraphicsScene*>());
+        if (s && item->isSelected())
+        {
+            s->mSelection.insert(item);
+            s->mSelectionProperties.add(item);
+        }
+        break;
+    }
+    case QGraphicsItem::ItemPositionHasChanged:
+    case QGraphicsItem::ItemTransformHasChanged:
+    {
+        Scene* s = qobject_cast<Scene*>(item->scene());
+        if (s && item->isSelected())
+            s->mSelectionProperties.update(item);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 ItemGroup*
 Scene::group(QList<QGraphicsItem*> items, ItemGroup* g)
 {
@@ -3364,7 +3657,7 @@ Scene::group(QList<QGraphicsItem*> items, ItemGroup* g)
 void
 Scene::ungroup()
 {
-    if (selectedItems().count() <= 0)
+    if (selectionCount() <= 0)
         return;
 
     foreach (QGraphicsItem* item, selectedItems())
@@ -3882,64 +4175,97 @@ Scene::createRoundsChart(int rows, int cols, QString stitch, QSizeF rowSize, int
 {
     mDefaultSize = rowSize;
 
+    Stitch* s = findStitchOrDefault(stitch);
+    if (!s)
+        return;
+
+    QList<QList<Cell*> > rounds;
     for (int i = 0; i < rows; ++i)
     {
         // FIXME: this padding should be dependant on the height of the sts.
         int pad = i * increaseBy;
 
-        createRow(i, cols + pad, stitch);
+        rounds.append(createRoundCells(i, cols + pad, s));
     }
+    addRows(0, rounds);
 
     setShowChartCenter(Settings::inst()->value("showChartCenter").toBool());
 
     updateSceneRect();
 }
 
-void
-Scene::setCellPosition(int row, int column, Cell* c, int columns)
+QList<Cell*>
+Scene::createRoundCells(int row, int columns, Stitch* stitch)
 {
-    double widthInDegrees = 360.0 / columns;
+    QList<Cell*> cells;
+    if (columns <= 0)
+        return cells;
 
-    double radius = defaultSize().height() * (row + 1) + (32);
+    // every cell has the same stitch, so the same size.
+    Cell* first = new Cell();
+    first->setStitch(stitch);
+    QRectF rect = first->boundingRect();
+    QPointF pivot(rect.width() / 2, rect.height());
+    QPointF offset(rect.width() / 2, rect.height() / 2);
 
-    double degrees = widthInDegrees * column;
+    qreal radius = defaultSize().height() * (row + 1) + (32);
+    qreal widthInDegrees = 360.0 / columns;
 
-    QPointF pivotPt = QPointF(c->boundingRect().width() / 2, c->boundingRect().height());
-    c->setTransformOriginPoint(pivotPt);
-    c->setRotation(degrees + 90);
+    // work out the whole round before creating the rest of the cells, in plain loops over
+    // arrays the compiler can keep in registers.
+    QVector<qreal> degrees(columns);
+    QVector<qreal> x(columns);
+    QVector<qreal> y(columns);
+    for (int i = 0; i < columns; ++i)
+        degrees[i] = widthInDegrees * i;
+    for (int i = 0; i < columns; ++i)
+        x[i] = radius * cos(degrees[i] * M_PI / 180) - offset.x();
+    for (int i = 0; i < columns; ++i)
+        y[i] = radius * sin(degrees[i] * M_PI / 180) - offset.y();
+
+    cells.reserve(columns);
+    for (int i = 0; i < columns; ++i)
+    {
+        Cell* c = i == 0 ? first : new Cell();
+        if (i > 0)
+            c->setStitch(stitch);
 
-    QPointF finish = calcPoint(radius, degrees, QPointF(0, 0));
-    finish.rx() -= c->boundingRect().width() / 2;
-    finish.ry() -= c->boundingRect().height() / 2;
+        c->setTransformOriginPoint(pivot);
+        c->setRotation(degrees[i] + 90);
+        c->setPos(x[i], y[i]);
+        cells.append(c);
+    }
 
-    c->setPos(finish.x(), finish.y());
+    return cells;
 }
 
-QPointF
-Scene::calcPoint(double radius, double angleInDegrees, QPointF origin) const
+void
+Scene::createRow(int row, int columns, QString stitch)
 {
-    // Convert from degrees to radians via multiplication by PI/180
-    qreal x = (radius * cos(angleInDegrees * M_PI / 180)) + origin.x();
-    qreal y = (radius * sin(angleInDegrees * M_PI / 180)) + origin.y();
-    return QPointF(x, y);
+    Stitch* s = findStitchOrDefault(stitch);
+    if (!s)
+        return;
+
+    addRows(row, QList<QList<Cell*> >() << createRoundCells(row, columns, s));
 }
 
 void
-Scene::createRow(int row, int columns, QString stitch)
+Scene::addRows(int before, const QList<QList<Cell*> >& rows)
 {
-    Cell* c = nullptr;
+    if (rows.isEmpty())
+        return;
 
-    QList<Cell*> modelRow;
-    for (int i = 0; i < columns; ++i)
+    // the cells are already positioned, so they're only indexed once, as they're added.
+    foreach (const QList<Cell*>& row, rows)
     {
-        c = new Cell();
-        c->setStitch(stitch);
-        addItem(c);
-
-        modelRow.append(c);
-        setCellPosition(row, i, c, columns);
+        foreach (Cell* c, row)
+            addItem(c);
     }
-    grid.insert(row, modelRow);
+
+    mRowsModel->beginInsertRows(QModelIndex(), before, before + rows.count() - 1);
+    for (int i = 0; i < rows.count(); ++i)
+        grid.insert(before + i, rows.at(i));
+    mRowsModel->endInsertRows();
 }
 
 void
@@ -4000,22 +4326,13 @@ Scene::setGuidelinesType(QString guides)
 void
 Scene::replaceStitches(QString original, QString replacement)
 {
+    // the commands change the index, take the cells out of it first.
+    QList<Cell*> cells = cellsWithStitch(original);
+
     undoStack()->beginMacro(tr("replace stitches"));
-    foreach (QGraphicsItem* i, items())
+    foreach (Cell* c, cells)
     {
-        if (!i)
-            continue;
-        if (i->type() != Cell::Type)
-            continue;
-
-        Cell* c = qgraphicsitem_cast<Cell*>(i);
-        if (!c)
-            continue;
-
-        if (c->stitch()->name() == original)
-        {
-            undoStack()->push(new SetCellStitch(c, replacement));
-        }
+        undoStack()->push(new SetCellStitch(c, replacement));
     }
     undoStack()->endMacro();
 }
@@ -4023,34 +4340,193 @@ Scene::replaceStitches(QString original, QString replacement)
 void
 Scene::replaceColor(QColor original, QColor replacement, int selection)
 {
+    QList<Cell*> cells;
+    QList<Cell*> bgCells;
+    if (selection == 1 || selection == 3)
+        cells = cellsWithColor(original);
+    if (selection == 2 || selection == 3)
+        bgCells = cellsWithBgColor(original);
+
     undoStack()->beginMacro(tr("replace color"));
-    foreach (QGraphicsItem* i, items())
+    foreach (Cell* c, cells)
     {
-        if (!i)
-            continue;
-        if (i->type() != Cell::Type)
-            continue;
+        undoStack()->push(new SetCellColor(c, replacement));
+    }
+    foreach (Cell* c, bgCells)
+    {
+        undoStack()->push(new SetCellBgColor(c, replacement));
+    }
+    undoStack()->endMacro();
+}
 
-        Cell* c = qgraphicsitem_cast<Cell*>(i);
+/**
+ * the key of a colour in the indexes, cells without a colour aren't indexed.
+ */
+static QString
+colorKey(const QColor& color)
+{
+    return color.isValid() ? color.name() : QString();
+}
 
-        if (!c)
-            continue;
+static QList<Cell*>
+indexedCells(const QHash<QString, QSet<Cell*> >& index, const QString& key)
+{
+    QHash<QString, QSet<Cell*> >::const_iterator it = index.constFind(key);
+    if (it == index.constEnd())
+        return QList<Cell*>();
+    return it.value().toList();
+}
 
-        if (selection == 1 || selection == 3)
+/**
+ * move c from one key of index to another, an empty key isn't indexed.
+ */
+static void
+reindex(QHash<QString, QSet<Cell*> >& index, const QString& from, const QString& to, Cell* c)
+{
+    if (!from.isEmpty())
+    {
+        QHash<QString, QSet<Cell*> >::iterator it = index.find(from);
+        if (it != index.end())
         {
-            if (c->color().name() == original.name())
-            {
-                undoStack()->push(new SetCellColor(c, replacement));
-            }
+            it.value().remove(c);
+            if (it.value().isEmpty())
+                index.erase(it);
         }
+    }
 
-        if (selection == 2 || selection == 3)
-        {
-            if (c->bgColor().name() == original.name())
-            {
-                undoStack()->push(new SetCellBgColor(c, replacement));
-            }
-        }
+    if (!to.isEmpty())
+        index[to].insert(c);
+}
+
+QList<Cell*>
+Scene::cellsWithStitch(const QString& stitch) const
+{
+    return indexedCells(mStitchIndex, stitch);
+}
+
+QList<Cell*>
+Scene::cellsWithColor(const QColor& color) const
+{
+    return indexedCells(mColorIndex, colorKey(color));
+}
+
+QList<Cell*>
+Scene::cellsWithBgColor(const QColor& color) const
+{
+    return indexedCells(mBgColorIndex, colorKey(color));
+}
+
+void
+Scene::selectStitch(const QString& stitch, bool add)
+{
+    QList<QGraphicsItem*> items;
+    foreach (Cell* c, cellsWithStitch(stitch))
+        items.append(c);
+    setSelection(items, add);
+}
+
+void
+Scene::selectColor(const QColor& color, bool add)
+{
+    QSet<Cell*> cells = mColorIndex.value(colorKey(color));
+    cells.unite(mBgColorIndex.value(colorKey(color)));
+
+    QList<QGraphicsItem*> items;
+    foreach (Cell* c, cells)
+        items.append(c);
+    setSelection(items, add);
+}
+
+void
+Scene::trackCell(Cell* cell, QGraphicsItem::GraphicsItemChange change, const QVariant& value)
+{
+    switch (change)
+    {
+    case QGraphicsItem::ItemSceneChange:
+    {
+        Scene* s = qobject_cast<Scene*>(cell->scene());
+        if (s)
+            s->unindexCell(cell);
+        break;
     }
-    undoStack()->endMacro();
+    case QGraphicsItem::ItemSceneHasChanged:
+    {
+        Scene* s = qobject_cast<Scene*>(value.value<QGraphicsScene*>());
+        if (s)
+            s->indexCell(cell);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void
+Scene::indexCell(Cell* c)
+{
+    reindex(mStitchIndex, QString(), c->stitch() ? c->stitch()->name() : QString(), c);
+    reindex(mColorIndex, QString(), colorKey(c->color()), c);
+    reindex(mBgColorIndex, QString(), colorKey(c->bgColor()), c);
+
+    connect(c, SIGNAL(stitchChanged(QString, QString)), SIGNAL(stitchChanged(QString, QString)),
+            Qt::UniqueConnection);
+    connect(c, SIGNAL(colorChanged(QString, QString)), SIGNAL(colorChanged(QString, QString)),
+            Qt::UniqueConnection);
+    connect(c, SIGNAL(bgColorChanged(QString, QString)), SIGNAL(colorChanged(QString, QString)),
+            Qt::UniqueConnection);
+
+    connect(c, SIGNAL(stitchChanged(QString, QString)),
+            SLOT(cellStitchChanged(QString, QString)), Qt::UniqueConnection);
+    connect(c, SIGNAL(colorChanged(QString, QString)), SLOT(cellColorChanged(QString, QString)),
+            Qt::UniqueConnection);
+    connect(c, SIGNAL(bgColorChanged(QString, QString)),
+            SLOT(cellBgColorChanged(QString, QString)), Qt::UniqueConnection);
+}
+
+void
+Scene::unindexCell(Cell* c)
+{
+    reindex(mStitchIndex, c->stitch() ? c->stitch()->name() : QString(), QString(), c);
+    reindex(mColorIndex, colorKey(c->color()), QString(), c);
+    reindex(mBgColorIndex, colorKey(c->bgColor()), QString(), c);
+
+    disconnect(c, 0, this, 0);
+}
+
+void
+Scene::cellStitchChanged(QString oldSt, QString newSt)
+{
+    Cell* c = qobject_cast<Cell*>(sender());
+    if (!c)
+        return;
+
+    reindex(mStitchIndex, oldSt, newSt, c);
+    if (c->isSelected())
+        mSelectionProperties.update(c);
+}
+
+void
+Scene::cellColorChanged(QString oldColor, QString newColor)
+{
+    Q_UNUSED(newColor);
+    Cell* c = qobject_cast<Cell*>(sender());
+    if (!c)
+        return;
+
+    reindex(mColorIndex, oldColor, colorKey(c->color()), c);
+    if (c->isSelected())
+        mSelectionProperties.update(c);
+}
+
+void
+Scene::cellBgColorChanged(QString oldColor, QString newColor)
+{
+    Q_UNUSED(newColor);
+    Cell* c = qobject_cast<Cell*>(sender());
+    if (!c)
+        return;
+
+    reindex(mBgColorIndex, oldColor, colorKey(c->bgColor()), c);
+    if (c->isSelected())
+        mSelectionProperties.update(c);
 }
@@ -28,6 +28,7 @@
 #include "ChartImage.h"
 
 #include <QHash>
+#include <QSet>
 #include <QUndoStack>
 #include <QRubberBand>
 #include <functional>
@@ -36,8 +37,12 @@
 #include "indicator.h"
 #include "itemgroup.h"
 #include "selectionband.h"
+#include "selectionproperties.h"
+#include "snaplattice.h"
 
 #define SCENE_CLAMP_BORDER_SIZE 50
+// selections with at least this many items are dragged as a picture.
+#define SCENE_PROXY_MOVE_COUNT 500
 
 class Guidelines
 {
@@ -178,6 +183,10 @@ QDebug operator<<(QDebug d, IndicatorProperties& properties);
 Q_DECLARE_METATYPE(IndicatorProperties)
 
 class QKeyEvent;
+class RowsModel;
+class ChartMimeData;
+class SelectionProxy;
+class Guideline;
 
 class Scene : public QGraphicsScene
 {
@@ -186,6 +195,7 @@ class Scene : public QGraphicsScene
     friend class File_v1;
     friend class File_v2;
     friend class RowEditDialog;
+    friend class RowsModel;
     friend class TextView;
 
 public:
@@ -276,6 +286,20 @@ public:
 
     void removeRow(int row);
 
+    /**
+     * remove missing cells and the rows left empty from the grid.
+     */
+    void removeEmptyRows();
+
+    /**
+     * a list model of the rows in the grid that follows the changes to the rows.
+     */
+    RowsModel*
+    rowsModel() const
+    {
+        return mRowsModel;
+    }
+
     void alignSelection(int alignmentStyle);
     void distributeSelection(int distributionStyle);
     void arrangeGrid(QSize grid, QSize alignment, QSize spacing, bool useSelection);
@@ -328,11 +352,19 @@ public:
      * Snap to grid functions
      */
     QPointF snapPositionToGrid(const QPointF& pos) const;
-    QPointF snapPositionToRows(const QPointF& pos) const;
-    QPointF snapPositionToRounds(const QPointF& pos) const;
-    QPointF snapPositionToTriangles(const QPointF& pos) const;
     void snapGraphicsItemToGrid(QGraphicsItem& item);
 
+    /**
+     * move the centers of items to the guidelines, and turn them to face the center of a
+     * round chart if snapAngle is on.
+     */
+    void snapItemsToGrid(const QList<QGraphicsItem*>& items);
+
+    /**
+     * the points of the current guidelines, rebuilt when the guidelines or the center change.
+     */
+    const SnapLattice& snapLattice() const;
+
 public slots:
     void showProperties();
     void copy();
@@ -342,8 +374,19 @@ public slots:
     void deleteSelection();
 
 protected:
-    void copyRecursively(QDataStream& stream, QList<QGraphicsItem*> items);
-    void pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group);
+    /**
+     * paste the item at index in data and the items in it if it's a group. index and cursor
+     * are moved past what was pasted.
+     */
+    void pasteRecord(const ChartMimeData& data,
+                     int* index,
+                     int* cursor,
+                     QList<QGraphicsItem*>* group,
+                     const QPointF& offSet);
+    /**
+     * paste clipboard data written before the compact format was used.
+     */
+    void pasteRecursively(QDataStream& stream, QList<QGraphicsItem*>* group, const QPointF& offSet);
 
     /**
      * This function removes a cell from the 'grid'. if the row is empty it removes the row too.
@@ -499,6 +542,47 @@ protected:
     QRectF selectionBoundingRect(QList<QGraphicsItem*> items, int vertical, int horizontal);
 
 public:
+    /**
+     * select items and deselect everything else, or add items to the selection if add is true.
+     * Only the items that change are touched and selectionChanged is emitted once.
+     */
+    void setSelection(const QList<QGraphicsItem*>& items, bool add = false);
+
+    /**
+     * the number of selected items, without building the list selectedItems() returns.
+     */
+    int
+    selectionCount() const
+    {
+        // the center symbol keeps its selected state while it's hidden.
+        bool center = mCenterSymbol && mCenterSymbol->scene() == this
+                      && mCenterSymbol->isSelected();
+        return mSelection.count() + (center ? 1 : 0);
+    }
+    bool
+    isSingleSelection() const
+    {
+        return selectionCount() == 1;
+    }
+
+    /**
+     * the values the selected chart items have in common, kept up to date as they change.
+     */
+    const SelectionProperties&
+    selectionProperties() const
+    {
+        return mSelectionProperties;
+    }
+
+    /**
+     * keep the selection count and properties of the scene item is in up to date. The chart
+     * items call this from their itemChange, when they're deleted and when ChartItemTools
+     * changes their transformations.
+     */
+    static void trackSelection(QGraphicsItem* item,
+                               QGraphicsItem::GraphicsItemChange change,
+                               const QVariant& value);
+
     ItemGroup* group(QList<QGraphicsItem*> items, ItemGroup* g = 0);
     void ungroup(ItemGroup* group);
 
@@ -506,6 +590,11 @@ public:
     ItemGroup* getGroup(int groupNumber);
     QRectF selectedItemsBoundingRect(QList<QGraphicsItem*> items);
 
+    /**
+     * the selected items and the items grouped under them, bottom to top.
+     */
+    QList<QGraphicsItem*> selectedItemsInStackingOrder();
+
     /**
      * This function overrides the itemsBoundingRect().
      */
@@ -515,6 +604,29 @@ public:
                 const QRectF& target = QRectF(),
                 const QRectF& source = QRectF(),
                 Qt::AspectRatioMode aspectRatioMode = Qt::KeepAspectRatio);
+
+    /**
+     * the painter transform QGraphicsScene::render uses to map source onto target.
+     */
+    static QTransform renderTransform(const QRectF& source,
+                                      const QRectF& target,
+                                      Qt::AspectRatioMode aspectRatioMode = Qt::KeepAspectRatio);
+
+    /**
+     * sort items of this scene bottom to top, without asking the scene for its item index.
+     */
+    static void sortByStackingOrder(QList<QGraphicsItem*>& items);
+
+    /**
+     * render only the given items, in stacking order, without touching the state of the scene.
+     * Items are painted as if they weren't selected. The source defaults to the bounding rect
+     * of the items.
+     */
+    void renderItems(QPainter* painter,
+                     const QList<QGraphicsItem*>& items,
+                     const QRectF& target = QRectF(),
+                     const QRectF& source = QRectF(),
+                     Qt::AspectRatioMode aspectRatioMode = Qt::KeepAspectRatio);
     void drawBackground(QPainter* painter, const QRectF& rect);
     void setBackground(bool enabled);
 
@@ -548,6 +660,10 @@ protected:
     }
 
     void updateStitchRenderer();
+    /**
+     * update the alternate row colors of the rows from first to the end of the grid.
+     */
+    void updateRowRenderers(int first);
 
     void hideRowLines();
 
@@ -559,8 +675,6 @@ private:
     QPointF mCellStartPos;
     QPointF mLeftButtonDownPos;
 
-    QPainterPath mSelectionPath;
-
     Indicator* mCurIndicator = nullptr;
 
     /**
@@ -578,6 +692,9 @@ private:
 
     // Is the user moving an object.
     bool mMoving = false;
+    // drag a picture of the selection instead of the items.
+    bool mUseMoveProxy = false;
+    SelectionProxy* mMoveProxy = nullptr;
     bool mIsRubberband = false;
     bool mHasSelection = false;
     bool mSnapTo = false;
@@ -600,6 +717,7 @@ private:
 
     // rows keeps track of the st order for individual rows;
     QList<QList<Cell*> > grid;
+    RowsModel* mRowsModel;
 
     qreal scenePosToAngle(QPointF pt);
 
@@ -657,6 +775,11 @@ public:
     void createRoundsChart(int rows, int cols, QString stitch, QSizeF rowSize, int increaseBy);
     void createRow(int row, int columns, QString stitch);
 
+    /**
+     * add rows of new cells to the scene and insert them into the grid before row before.
+     */
+    void addRows(int before, const QList<QList<Cell*> >& rows);
+
     /**
      * Does the chart have a symbol at all?
      */
@@ -683,13 +806,22 @@ public:
         return mSnapAngle;
     };
 
-protected:
-    void setCellPosition(int row, int column, Cell* c, int columns);
-
 private:
-    QPointF calcPoint(double radius, double angleInDegrees, QPointF origin) const;
+    /**
+     * the cells of round row, positioned and rotated around the center but not in the scene.
+     */
+    QList<Cell*> createRoundCells(int row, int columns, Stitch* stitch);
 
     QGraphicsItem* mCenterSymbol = nullptr;
+
+    // the selected chart items, the center symbol isn't a chart item and is checked separately.
+    QSet<QGraphicsItem*> mSelection;
+    SelectionProperties mSelectionProperties;
+    // setSelection updates mSelection itself once all the items are changed.
+    bool mBatchingSelection = false;
+
+    mutable Guidelines mSnapGuidelines;
+    mutable SnapLattice mSnapLattice;
     bool mShowChartCenter = false;
     bool mSnapAngle = false;
 
@@ -711,23 +843,67 @@ public:
      */
     void replaceColor(QColor original, QColor replacement, int selection);
 
+    /**
+     * the cells with a stitch, colour or background colour. They come from indexes that are
+     * kept up to date as cells change, so they don't look at any other items.
+     */
+    QList<Cell*> cellsWithStitch(const QString& stitch) const;
+    QList<Cell*> cellsWithColor(const QColor& color) const;
+    QList<Cell*> cellsWithBgColor(const QColor& color) const;
+
+    /**
+     * select every cell with stitch, or with color as its colour or background colour.
+     */
+    void selectStitch(const QString& stitch, bool add = false);
+    void selectColor(const QColor& color, bool add = false);
+
+    /**
+     * keep the indexes of the scene cell is in up to date. Cells call this from their
+     * itemChange and when they're deleted.
+     */
+    static void trackCell(Cell* cell,
+                          QGraphicsItem::GraphicsItemChange change,
+                          const QVariant& value);
+
+private slots:
+    void cellStitchChanged(QString oldSt, QString newSt);
+    void cellColorChanged(QString oldColor, QString newColor);
+    void cellBgColorChanged(QString oldColor, QString newColor);
+
+private:
+    void indexCell(Cell* c);
+    void unindexCell(Cell* c);
+
+    // stitch name or colour name -> the cells using it.
+    QHash<QString, QSet<Cell*> > mStitchIndex;
+    QHash<QString, QSet<Cell*> > mColorIndex;
+    QHash<QString, QSet<Cell*> > mBgColorIndex;
+
 protected slots:
     /**
      * @brief updateGuidelines - draw the guidelines
      */
     void updateGuidelines();
 
-private:
-    void generateGuidelinesRows(int spacingW, int spacingH, int columns, int rows, QPointF center);
-    void generateGuidelinesRounds(
-        int spacingW, int spacingH, int columns, int rows, QPointF center);
-    void generateGuidelinesTriangles(
-        int spacingW, int spacingH, int columns, int rows, QPointF center);
+public:
+    /**
+     * the area covered by the guidelines, a null rect if there aren't any.
+     */
+    QRectF guidelinesRect() const;
 
     /**
-     * @brief mGuidelinesLines - Hold all the lines that make up the grid
+     * draw the guidelines that cross rect.
      */
-    QList<QGraphicsItem*> mGuidelinesLines;
+    void drawGuidelines(QPainter* painter, const QRectF& rect) const;
+
+private:
+    /**
+     * the lines of the guidelines that cross rect.
+     */
+    void guidelineLines(const QRectF& rect, QVector<QLineF>* lines) const;
+    QPointF guidelinesCenter() const;
+
+    Guideline* mGuidelinesItem = nullptr;
 
     /**
      * @brief mGuidelines - Hold the settings that are used to generate a grid background
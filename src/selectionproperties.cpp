@@ -0,0 +1,235 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "selectionproperties.h"
+
+#include <QGraphicsItem>
+#include <QGraphicsRotation>
+#include <QGraphicsScale>
+
+#include "cell.h"
+
+template <typename K>
+static void
+countValue(QMap<K, int>& map, const K& key, int delta)
+{
+    typename QMap<K, int>::iterator it = map.find(key);
+    if (it == map.end())
+        it = map.insert(key, 0);
+    it.value() += delta;
+    if (it.value() <= 0)
+        map.erase(it);
+}
+
+template <typename K>
+static void
+countValue(QHash<K, int>& hash, const K& key, int delta)
+{
+    typename QHash<K, int>::iterator it = hash.find(key);
+    if (it == hash.end())
+        it = hash.insert(key, 0);
+    it.value() += delta;
+    if (it.value() <= 0)
+        hash.erase(it);
+}
+
+static QString
+colorKey(const QColor& color)
+{
+    return color.isValid() ? color.name(QColor::HexArgb) : QString();
+}
+
+SelectionProperties::Values
+SelectionProperties::values(QGraphicsItem* item)
+{
+    Values v;
+    v.type = item->type();
+    v.pos = item->pos();
+    v.angle = 0;
+    v.scaleX = 1;
+    v.scaleY = 1;
+
+    // ChartItemTools would add the transformations to items that don't have any yet.
+    bool hasRotation = false;
+    bool hasScale = false;
+    foreach (QGraphicsTransform* t, item->transformations())
+    {
+        QGraphicsRotation* rotation = qobject_cast<QGraphicsRotation*>(t);
+        QGraphicsScale* scale = qobject_cast<QGraphicsScale*>(t);
+        if (rotation && !hasRotation)
+        {
+            v.angle = rotation->angle();
+            hasRotation = true;
+        }
+        else if (scale && !hasScale)
+        {
+            v.scaleX = scale->xScale();
+            v.scaleY = scale->yScale();
+            hasScale = true;
+        }
+    }
+
+    if (v.type == Cell::Type)
+    {
+        Cell* c = qgraphicsitem_cast<Cell*>(item);
+        v.stitch = c->name();
+        v.color = colorKey(c->color());
+        v.bgColor = colorKey(c->bgColor());
+    }
+
+    return v;
+}
+
+void
+SelectionProperties::count(const Values& v, int delta)
+{
+    countValue(mTypes, v.type, delta);
+    countValue(mAngles, v.angle, delta);
+    countValue(mScaleX, v.scaleX, delta);
+    countValue(mScaleY, v.scaleY, delta);
+    countValue(mPositionX, v.pos.x(), delta);
+    countValue(mPositionY, v.pos.y(), delta);
+
+    if (v.type == Cell::Type)
+    {
+        countValue(mStitches, v.stitch, delta);
+        countValue(mColors, v.color, delta);
+        countValue(mBgColors, v.bgColor, delta);
+    }
+}
+
+void
+SelectionProperties::add(QGraphicsItem* item)
+{
+    if (mItems.contains(item))
+        return;
+
+    Values v = values(item);
+    mItems.insert(item, v);
+    count(v, 1);
+}
+
+void
+SelectionProperties::remove(QGraphicsItem* item)
+{
+    QHash<QGraphicsItem*, Values>::iterator it = mItems.find(item);
+    if (it == mItems.end())
+        return;
+
+    count(it.value(), -1);
+    mItems.erase(it);
+}
+
+void
+SelectionProperties::update(QGraphicsItem* item)
+{
+    QHash<QGraphicsItem*, Values>::iterator it = mItems.find(item);
+    if (it == mItems.end())
+        return;
+
+    count(it.value(), -1);
+    it.value() = values(item);
+    count(it.value(), 1);
+}
+
+int
+SelectionProperties::type() const
+{
+    return mTypes.count() == 1 ? mTypes.constBegin().key() : 0;
+}
+
+QGraphicsItem*
+SelectionProperties::item() const
+{
+    return mItems.isEmpty() ? nullptr : mItems.constBegin().key();
+}
+
+bool
+SelectionProperties::isMixed(Property property) const
+{
+    switch (property)
+    {
+    case Angle:
+        return mAngles.count() > 1;
+    case ScaleX:
+        return mScaleX.count() > 1;
+    case ScaleY:
+        return mScaleY.count() > 1;
+    case PositionX:
+        return mPositionX.count() > 1;
+    case PositionY:
+        return mPositionY.count() > 1;
+    case Stitch:
+        return mStitches.count() > 1;
+    case Color:
+        return mColors.count() > 1;
+    case BgColor:
+        return mBgColors.count() > 1;
+    }
+    return false;
+}
+
+PropertiesData
+SelectionProperties::properties() const
+{
+    PropertiesData props;
+    props.angle = mAngles.count() == 1 ? mAngles.firstKey() : 0.0;
+    props.scale = QPointF(mScaleX.count() == 1 ? mScaleX.firstKey() : 1.0,
+                          mScaleY.count() == 1 ? mScaleY.firstKey() : 1.0);
+    props.position = QPointF(mPositionX.count() == 1 ? mPositionX.firstKey() : 0.0,
+                             mPositionY.count() == 1 ? mPositionY.firstKey() : 0.0);
+
+    if (mStitches.count() == 1)
+        props.stitch = mStitches.constBegin().key();
+    if (mColors.count() == 1)
+        props.color = QColor(mColors.constBegin().key());
+    if (mBgColors.count() == 1)
+        props.bgColor = QColor(mBgColors.constBegin().key());
+
+    return props;
+}
+
+qreal
+SelectionProperties::minAngle() const
+{
+    return mAngles.isEmpty() ? 0.0 : mAngles.firstKey();
+}
+
+qreal
+SelectionProperties::maxAngle() const
+{
+    return mAngles.isEmpty() ? 0.0 : mAngles.lastKey();
+}
+
+QPointF
+SelectionProperties::minScale() const
+{
+    if (mItems.isEmpty())
+        return QPointF(1.0, 1.0);
+    return QPointF(mScaleX.firstKey(), mScaleY.firstKey());
+}
+
+QPointF
+SelectionProperties::maxScale() const
+{
+    if (mItems.isEmpty())
+        return QPointF(1.0, 1.0);
+    return QPointF(mScaleX.lastKey(), mScaleY.lastKey());
+}
@@ -0,0 +1,128 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef SELECTIONPROPERTIES_H
+#define SELECTIONPROPERTIES_H
+
+#include <QHash>
+#include <QMap>
+#include <QPointF>
+#include <QString>
+
+#include "propertiesdata.h"
+
+class QGraphicsItem;
+
+/**
+ * The properties shared by the selected items of a scene.
+ *
+ * The values of every selected item are counted as it's selected, changed and deselected, so
+ * the common values, the ranges and whether a property is mixed can be read without looking
+ * at the items again. The angle, scale and position come from every item, the stitch and
+ * colours only from cells.
+ */
+class SelectionProperties
+{
+public:
+    enum Property
+    {
+        Angle,
+        ScaleX,
+        ScaleY,
+        PositionX,
+        PositionY,
+        Stitch,
+        Color,
+        BgColor
+    };
+
+    void add(QGraphicsItem* item);
+    void remove(QGraphicsItem* item);
+
+    /**
+     * count item again with its current values.
+     */
+    void update(QGraphicsItem* item);
+
+    int
+    count() const
+    {
+        return mItems.count();
+    }
+    int
+    count(int type) const
+    {
+        return mTypes.value(type);
+    }
+
+    /**
+     * the type of the items if they're all the same type, otherwise 0.
+     */
+    int type() const;
+
+    /**
+     * one of the items, or 0 if there aren't any.
+     */
+    QGraphicsItem* item() const;
+
+    bool isMixed(Property property) const;
+
+    /**
+     * the values the items have in common, a mixed value is left at its default.
+     */
+    PropertiesData properties() const;
+
+    qreal minAngle() const;
+    qreal maxAngle() const;
+    QPointF minScale() const;
+    QPointF maxScale() const;
+
+private:
+    struct Values
+    {
+        int type;
+        qreal angle;
+        qreal scaleX;
+        qreal scaleY;
+        QPointF pos;
+        // only set for cells.
+        QString stitch;
+        QString color;
+        QString bgColor;
+    };
+
+    static Values values(QGraphicsItem* item);
+    void count(const Values& v, int delta);
+
+    QHash<QGraphicsItem*, Values> mItems;
+    QHash<int, int> mTypes;
+
+    // value -> the number of items with it.
+    QMap<qreal, int> mAngles;
+    QMap<qreal, int> mScaleX;
+    QMap<qreal, int> mScaleY;
+    QMap<qreal, int> mPositionX;
+    QMap<qreal, int> mPositionY;
+    QHash<QString, int> mStitches;
+    QHash<QString, int> mColors;
+    QHash<QString, int> mBgColors;
+};
+
+#endif  // SELECTIONPROPERTIES_H
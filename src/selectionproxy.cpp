@@ -0,0 +1,116 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "selectionproxy.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include "itemgroup.h"
+#include "scene.h"
+
+/**
+ * the items that draw something, the children of groups instead of the groups.
+ */
+static void
+collectItems(const QList<QGraphicsItem*>& items, QList<QGraphicsItem*>* result)
+{
+    foreach (QGraphicsItem* item, items)
+    {
+        if (!item->isVisible())
+            continue;
+
+        if (item->type() == ItemGroup::Type)
+            collectItems(item->childItems(), result);
+        else
+            result->append(item);
+    }
+}
+
+SelectionProxy::SelectionProxy(const QList<QGraphicsItem*>& items, qreal scale, int maxSize)
+    : QGraphicsItem()
+{
+    QList<QGraphicsItem*> painted;
+    collectItems(items, &painted);
+    Scene::sortByStackingOrder(painted);
+
+    foreach (QGraphicsItem* item, painted)
+    {
+        mRect |= item->sceneBoundingRect();
+    }
+
+    mStart = mRect.topLeft();
+    setPos(mStart);
+    setZValue(1000);
+    setOpacity(0.8);
+    setAcceptedMouseButtons(Qt::NoButton);
+
+    if (mRect.isEmpty())
+        return;
+
+    scale = qMax(scale, 0.01);
+    qreal largest = qMax(mRect.width(), mRect.height()) * scale;
+    if (largest > maxSize)
+        scale *= maxSize / largest;
+
+    mPixmap = QPixmap(qMax(1, qCeil(mRect.width() * scale)), qMax(1, qCeil(mRect.height() * scale)));
+    mPixmap.fill(Qt::transparent);
+
+    QPainter p(&mPixmap);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    p.scale(scale, scale);
+    p.translate(-mRect.topLeft());
+    QTransform base = p.worldTransform();
+
+    QStyleOptionGraphicsItem option;
+    foreach (QGraphicsItem* item, painted)
+    {
+        QRectF rect = item->boundingRect();
+        option.state = QStyle::State_None;
+        option.rect = rect.toAlignedRect();
+        option.exposedRect = rect;
+
+        p.setWorldTransform(item->sceneTransform() * base);
+        p.setOpacity(item->effectiveOpacity());
+        item->paint(&p, &option, 0);
+    }
+    p.end();
+}
+
+QRectF
+SelectionProxy::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), mRect.size());
+}
+
+void
+SelectionProxy::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    if (mPixmap.isNull())
+        return;
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(boundingRect(), mPixmap, QRectF(mPixmap.rect()));
+}
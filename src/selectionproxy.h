@@ -0,0 +1,77 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef SELECTIONPROXY_H
+#define SELECTIONPROXY_H
+
+#include <QGraphicsItem>
+#include <QPixmap>
+
+/**
+ * A picture of the selected items that is dragged around instead of the items themselves.
+ *
+ * Moving thousands of items on every mouse move is slow, so the selection is drawn once into
+ * a pixmap at the zoom of the view and only this item moves while dragging. The items are
+ * moved to where the proxy ended up when the drag is over.
+ */
+class SelectionProxy : public QGraphicsItem
+{
+public:
+    enum
+    {
+        Type = UserType + 25
+    };
+
+    /**
+     * draw items at scale pixels per unit of the scene, pixmaps larger than maxSize pixels are
+     * drawn at a lower scale.
+     */
+    SelectionProxy(const QList<QGraphicsItem*>& items, qreal scale, int maxSize = 4096);
+
+    int
+    type() const
+    {
+        return SelectionProxy::Type;
+    }
+
+    QRectF boundingRect() const;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget);
+
+    /**
+     * how far the proxy has been moved from the items it was drawn from.
+     */
+    QPointF
+    offset() const
+    {
+        return pos() - mStart;
+    }
+    void
+    setOffset(const QPointF& offset)
+    {
+        setPos(mStart + offset);
+    }
+
+private:
+    QRectF mRect;
+    QPointF mStart;
+    QPixmap mPixmap;
+};
+
+#endif  // SELECTIONPROXY_H
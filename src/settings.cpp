@@ -98,6 +98,7 @@ Settings::setupValueList()
     mValueList["checkForUpdates"] = QVariant(true);
     mValueList["fileLocation"] = QVariant(userDocs);
 
+    mValueList["showFilePreview"] = QVariant(true);
     mValueList["maxRecentFiles"] = QVariant(5);
     mValueList["recentFiles"] = QVariant(QStringList());
 
@@ -127,6 +128,11 @@ Settings::setupValueList()
     mValueList["chartIndicatorColor"] = QVariant("#c00000");
     mValueList["showIndicatorOutline"] = QVariant(false);
 
+    // print options
+    mValueList["printTiled"] = QVariant(false);
+    mValueList["printStitchSize"] = QVariant(10);
+    mValueList["printOverlap"] = QVariant(5);
+
     // tools options
     mValueList["replaceStitchWithPress"] = QVariant(true);
     mValueList["centerNewStitchOnMouse"] = QVariant(true);
@@ -0,0 +1,187 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "snaplattice.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+SnapLattice::SnapLattice()
+    : mKind(None)
+    , mRows(0)
+    , mColumns(0)
+    , mCellWidth(0)
+    , mCellHeight(0)
+    , mSpokeAngle(0)
+{
+}
+
+SnapLattice::SnapLattice(
+    Kind kind, int rows, int columns, int cellWidth, int cellHeight, const QPointF& center)
+    : mKind(kind)
+    , mRows(rows)
+    , mColumns(columns)
+    , mCellWidth(cellWidth)
+    , mCellHeight(cellHeight)
+    , mCenter(center)
+    , mSpokeAngle(0)
+{
+    // there's nothing to snap to without a size.
+    if (mCellHeight <= 0 || ((kind == Rows || kind == Triangles) && mCellWidth <= 0))
+        mKind = None;
+    if (kind == Rounds && mColumns <= 0)
+        mKind = None;
+
+    if (mKind == Rounds)
+    {
+        for (int ring = 0; ring <= mRows + 1; ++ring)
+            mRadii.append(ring * mCellHeight);
+
+        mSpokeAngle = (M_PI * 2) / mColumns;
+        for (int spoke = 0; spoke <= mColumns; ++spoke)
+        {
+            qreal angle = spoke * mSpokeAngle + M_PI_2;
+            mSpokes.append(QPointF(cos(angle), sin(angle)));
+        }
+    }
+}
+
+SnapLattice::Kind
+SnapLattice::kind(const QString& type)
+{
+    if (type == "Rows")
+        return Rows;
+    else if (type == "Rounds")
+        return Rounds;
+    else if (type == "Triangles")
+        return Triangles;
+    return None;
+}
+
+QPointF
+SnapLattice::snap(const QPointF& pos) const
+{
+    switch (mKind)
+    {
+    case Rows:
+        return snapToRows(pos);
+    case Rounds:
+        return snapToRounds(pos);
+    case Triangles:
+        return snapToTriangles(pos);
+    case None:
+        break;
+    }
+    return pos;
+}
+
+void
+SnapLattice::snap(QVector<QPointF>& points) const
+{
+    QPointF* p = points.data();
+    int count = points.count();
+
+    switch (mKind)
+    {
+    case Rows:
+        for (int i = 0; i < count; ++i)
+            p[i] = snapToRows(p[i]);
+        break;
+    case Rounds:
+        for (int i = 0; i < count; ++i)
+            p[i] = snapToRounds(p[i]);
+        break;
+    case Triangles:
+        for (int i = 0; i < count; ++i)
+            p[i] = snapToTriangles(p[i]);
+        break;
+    case None:
+        break;
+    }
+}
+
+QPointF
+SnapLattice::snapToRows(const QPointF& pos) const
+{
+    // get the relative position to the grid
+    QPointF relPos = pos - mCenter;
+
+    // get the grid pos of the point
+    int relPosGridX = (relPos.x() + mCellWidth / 2) / mCellWidth;
+    int relPosGridY = (relPos.y() + mCellHeight / 2) / mCellHeight;
+
+    // clamp these the the grid size
+    relPosGridX = std::max(0, std::min(mColumns, relPosGridX));
+    relPosGridY = std::max(0, std::min(mRows, relPosGridY));
+
+    return QPointF(relPosGridX * mCellWidth, relPosGridY * mCellHeight) + mCenter;
+}
+
+QPointF
+SnapLattice::snapToRounds(const QPointF& pos) const
+{
+    // get the relative position to the circle
+    QPointF relPos = pos - mCenter;
+
+    // get the ring of the position
+    qreal distanceToCenter
+        = sqrt(relPos.x() * relPos.x() + relPos.y() * relPos.y()) + mCellHeight / 2;
+    int ring = distanceToCenter / mCellHeight;
+    ring = std::max(0, std::min(mRows + 1, ring));
+
+    // get the spoke of the position, measured from straight down.
+    qreal PIPI = M_PI * 2;
+    qreal angle = atan2(relPos.y(), relPos.x()) - M_PI_2;
+    angle = fmod(angle, PIPI);
+    if (angle < 0)
+        angle += PIPI;
+
+    int spoke = angle / mSpokeAngle + 0.5;
+    spoke = std::min(mColumns, spoke);
+
+    return mSpokes.at(spoke) * mRadii.at(ring) + mCenter;
+}
+
+QPointF
+SnapLattice::snapToTriangles(const QPointF& pos) const
+{
+    // get the relative position to the triangles
+    QPointF relPos = pos - mCenter;
+
+    // get the row of the current position, and clamp it
+    int relRow = relPos.y() / mCellHeight + 0.5;
+    relRow = std::max(0, std::min(mRows, relRow));
+
+    // get the max offsetX of that row
+    qreal offsetX = (relRow)*mCellWidth / 2;
+
+    // snap the distance from that offset to the grid, and clamp the column
+    qreal offsetDist = relPos.x() - offsetX;
+    int relDistColumn = offsetDist / mCellWidth - 0.5;
+    relDistColumn = std::max(-relRow, std::min(0, relDistColumn));
+
+    return QPointF(relDistColumn * mCellWidth + offsetX, relRow * mCellHeight) + mCenter;
+}
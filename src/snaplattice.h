@@ -0,0 +1,97 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef SNAPLATTICE_H
+#define SNAPLATTICE_H
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/**
+ * The points items snap to for one set of guidelines.
+ *
+ * Everything that doesn't depend on the point being snapped, the kind of guidelines, the
+ * spacing, the radii of the rings and the directions of the spokes of a round chart, is
+ * worked out when the lattice is created, so snapping a list of points only does the
+ * arithmetic for each point.
+ */
+class SnapLattice
+{
+public:
+    enum Kind
+    {
+        None,
+        Rows,
+        Rounds,
+        Triangles
+    };
+
+    SnapLattice();
+    SnapLattice(Kind kind,
+                int rows,
+                int columns,
+                int cellWidth,
+                int cellHeight,
+                const QPointF& center);
+
+    /**
+     * the kind of lattice for a Guidelines type, "None", "Rows", "Rounds" or "Triangles".
+     */
+    static Kind kind(const QString& type);
+
+    Kind
+    kind() const
+    {
+        return mKind;
+    }
+    QPointF
+    center() const
+    {
+        return mCenter;
+    }
+
+    QPointF snap(const QPointF& pos) const;
+
+    /**
+     * snap every point in points.
+     */
+    void snap(QVector<QPointF>& points) const;
+
+private:
+    QPointF snapToRows(const QPointF& pos) const;
+    QPointF snapToRounds(const QPointF& pos) const;
+    QPointF snapToTriangles(const QPointF& pos) const;
+
+    Kind mKind;
+    int mRows;
+    int mColumns;
+    int mCellWidth;
+    int mCellHeight;
+    QPointF mCenter;
+
+    // rounds: the radius of each ring, and the unit vector of each spoke, starting straight
+    // down from the center. The last spoke is the first one again.
+    QVector<qreal> mRadii;
+    QVector<QPointF> mSpokes;
+    qreal mSpokeAngle;
+};
+
+#endif  // SNAPLATTICE_H
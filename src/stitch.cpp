@@ -28,6 +28,7 @@
 #include <QFile>
 
 #include "settings.h"
+#include "stitchiconstore.h"
 
 Stitch::Stitch(QObject* parent)
     : QObject(parent)
@@ -44,6 +45,9 @@ Stitch::~Stitch()
 
     delete mPixmap;
     mPixmap = nullptr;
+
+    if (!mIconKey.isEmpty())
+        StitchIconStore::inst()->release(mIconKey);
 }
 
 void
@@ -51,6 +55,14 @@ Stitch::setFile(QString f)
 {
     if (mFile != f)
     {
+        // take the new reference before dropping the old one in case they're the same icon.
+        QString key = StitchIconStore::keyFromPath(f);
+        if (!key.isEmpty())
+            StitchIconStore::inst()->retain(key);
+        if (!mIconKey.isEmpty())
+            StitchIconStore::inst()->release(mIconKey);
+        mIconKey = key;
+
         mFile = f;
 
         delete mPixmap;
@@ -60,22 +72,35 @@ Stitch::setFile(QString f)
 
         if (!isSvg())
         {
-            mPixmap = new QPixmap(mFile);
+            mPixmap = new QPixmap();
+            mPixmap->loadFromData(iconData());
         }
     }
 }
 
-bool
-Stitch::setupSvgFiles()
+QByteArray
+Stitch::iconData() const
 {
+    if (!mIconKey.isEmpty())
+        return StitchIconStore::inst()->data(mIconKey);
+
     QFile file(mFile);
     if (!file.open(QIODevice::ReadOnly))
     {
         WARN("cannot open file for svg setup");
-        return false;
+        return QByteArray();
     }
 
-    QByteArray data = file.readAll();
+    return file.readAll();
+}
+
+bool
+Stitch::setupSvgFiles()
+{
+    QByteArray data = iconData();
+    if (data.isEmpty())
+        return false;
+
     QByteArray priData, secData;
 
     QString black = "#000000";
@@ -122,24 +147,27 @@ Stitch::addStitchColor(QString color)
     if (mRenderers.contains(color))
         return;
 
-    QFile file(mFile);
-    if (!file.open(QIODevice::ReadOnly))
-    {
-        WARN("cannot open file for svg setup");
+    QByteArray data = svgData(color);
+    if (data.isEmpty())
         return;
-    }
 
-    QByteArray data = file.readAll();
+    QSvgRenderer* svgR = new QSvgRenderer();
+    svgR->load(data);
+    mRenderers.insert(color, svgR);
+}
+
+QByteArray
+Stitch::svgData(const QString& color) const
+{
+    QByteArray data = iconData();
 
     QString black = "#000000";
 
     // Don't parse the color if we're using black
-    if (color != black)
+    if (!data.isEmpty() && color != black)
         data = data.replace(QByteArray(black.toLatin1()), QByteArray(color.toLatin1()));
 
-    QSvgRenderer* svgR = new QSvgRenderer();
-    svgR->load(data);
-    mRenderers.insert(color, svgR);
+    return data;
 }
 
 bool
@@ -154,11 +182,32 @@ Stitch::renderPixmap()
     if (mPixmap && !mPixmap->isNull())
         return mPixmap;
 
-    mPixmap = new QPixmap(mFile);
+    delete mPixmap;
+    mPixmap = new QPixmap();
+    mPixmap->loadFromData(iconData());
 
     return mPixmap;
 }
 
+QIcon
+Stitch::icon()
+{
+    if (!isSvg())
+        return QIcon(*renderPixmap());
+
+    QSvgRenderer* r = renderSvg();
+    if (!r)
+        return QIcon();
+
+    QPixmap pix(r->defaultSize());
+    pix.fill(Qt::transparent);
+    QPainter p(&pix);
+    r->render(&p);
+    p.end();
+
+    return QIcon(pix);
+}
+
 QSvgRenderer*
 Stitch::renderSvg(QColor color)
 {
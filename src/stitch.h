@@ -26,6 +26,7 @@
 #include <QObject>
 #include <QMap>
 #include <QColor>
+#include <QIcon>
 
 class QSvgRenderer;
 class QPixmap;
@@ -80,6 +81,28 @@ public:
 
     bool isSvg();
 
+    /**
+     * returns the raw icon data, from the StitchIconStore if the icon was embedded in a file,
+     * otherwise it's read from disk.
+     */
+    QByteArray iconData() const;
+
+    /**
+     * true if the icon only lives in memory in the StitchIconStore.
+     */
+    bool
+    isIconInMemory() const
+    {
+        return !mIconKey.isEmpty();
+    }
+
+    /**
+     * returns the svg data with the stitch color (black) replaced by color.
+     */
+    QByteArray svgData(const QString& color) const;
+
+    QIcon icon();
+
     QPixmap* renderPixmap();
     QSvgRenderer* renderSvg(QColor color = QColor(Qt::black));
 
@@ -98,6 +121,7 @@ protected:
         mName = n;
     }
     void setFile(QString f);
+
     void
     setDescription(QString desc)
     {
@@ -121,6 +145,7 @@ private:
 
     QString mName;
     QString mFile;
+    QString mIconKey;
     QString mDescription;
     QString mCategory;
     QString mWrongSide;
@@ -0,0 +1,126 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "stitchiconstore.h"
+
+#include <QCryptographicHash>
+
+#include "debug.h"
+
+// Global static pointer
+StitchIconStore* StitchIconStore::sInstance = nullptr;
+
+const QString StitchIconStore::sPrefix = "icon:";
+
+StitchIconStore*
+StitchIconStore::inst()
+{
+    if (!sInstance)  // Only allow one instance of the store.
+        sInstance = new StitchIconStore();
+    return sInstance;
+}
+
+StitchIconStore::StitchIconStore()
+{
+}
+
+QString
+StitchIconStore::acquire(const QByteArray& data)
+{
+    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    QString key = QString::fromLatin1(hash.toHex());
+
+    QHash<QString, Entry>::iterator it = mIcons.find(key);
+    if (it == mIcons.end())
+    {
+        Entry e;
+        e.data = data;
+        e.refs = 1;
+        mIcons.insert(key, e);
+    }
+    else
+    {
+        it->refs++;
+    }
+
+    return key;
+}
+
+void
+StitchIconStore::retain(const QString& key)
+{
+    QHash<QString, Entry>::iterator it = mIcons.find(key);
+    if (it == mIcons.end())
+    {
+        WARN("retaining an icon that isn't in the store: " + key);
+        return;
+    }
+
+    it->refs++;
+}
+
+void
+StitchIconStore::release(const QString& key)
+{
+    QHash<QString, Entry>::iterator it = mIcons.find(key);
+    if (it == mIcons.end())
+        return;
+
+    it->refs--;
+    if (it->refs <= 0)
+        mIcons.erase(it);
+}
+
+QByteArray
+StitchIconStore::data(const QString& key) const
+{
+    return mIcons.value(key).data;
+}
+
+bool
+StitchIconStore::contains(const QString& key) const
+{
+    return mIcons.contains(key);
+}
+
+int
+StitchIconStore::count() const
+{
+    return mIcons.count();
+}
+
+QString
+StitchIconStore::iconPath(const QString& key, const QString& fileName)
+{
+    return sPrefix + key + "/" + fileName;
+}
+
+QString
+StitchIconStore::keyFromPath(const QString& path)
+{
+    if (!isIconPath(path))
+        return QString();
+
+    int end = path.indexOf('/', sPrefix.length());
+    if (end == -1)
+        end = path.length();
+
+    return path.mid(sPrefix.length(), end - sPrefix.length());
+}
@@ -0,0 +1,93 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef STITCHICONSTORE_H
+#define STITCHICONSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/**
+ * In-memory, content-addressed store for stitch icons embedded in pattern and set files.
+ *
+ * Icons are keyed by the hash of their data so that every open document embedding the same
+ * icon shares a single copy. Stitches using an icon from the store get a file name of the form
+ * "icon:<key>/<original file name>" and read their data through Stitch::iconData().
+ *
+ * Entries are reference counted and dropped once the last set or stitch releases them.
+ */
+class StitchIconStore
+{
+public:
+    static StitchIconStore* inst();
+
+    /**
+     * add the icon data to the store and return its key. The caller holds a reference to the
+     * icon until it calls release().
+     */
+    QString acquire(const QByteArray& data);
+
+    /**
+     * take an additional reference on an icon already in the store.
+     */
+    void retain(const QString& key);
+    void release(const QString& key);
+
+    QByteArray data(const QString& key) const;
+    bool contains(const QString& key) const;
+
+    /**
+     * number of distinct icons currently held in memory.
+     */
+    int count() const;
+
+    /**
+     * build the stitch file name used for an icon in the store.
+     */
+    static QString iconPath(const QString& key, const QString& fileName);
+
+    /**
+     * return the store key of an icon path or an empty string if the path isn't in the store.
+     */
+    static QString keyFromPath(const QString& path);
+
+    static bool
+    isIconPath(const QString& path)
+    {
+        return path.startsWith(sPrefix);
+    }
+
+private:
+    StitchIconStore();
+
+    static StitchIconStore* sInstance;
+    static const QString sPrefix;
+
+    struct Entry
+    {
+        QByteArray data;
+        int refs;
+    };
+
+    QHash<QString, Entry> mIcons;
+};
+
+#endif  // STITCHICONSTORE_H
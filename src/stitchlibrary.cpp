@@ -393,9 +393,13 @@ StitchLibrary::removeSet(StitchSet* set)
 
         removeMasterStitches(set);
 
-        set->removeDir(set->stitchSetFolder());
-        QDir setsDir(Settings::inst()->userSettingsFolder());
-        setsDir.remove(set->stitchSetFileName);
+        // temporary sets keep their icons in memory and have nothing on disk to remove.
+        if (!set->isTemporary)
+        {
+            set->removeDir(set->stitchSetFolder());
+            QDir setsDir(Settings::inst()->userSettingsFolder());
+            setsDir.remove(set->stitchSetFileName);
+        }
 
         set->deleteLater();
     }
@@ -78,13 +78,13 @@ StitchReplacerUi::populateStitchLists()
     {
         Stitch* s = StitchLibrary::inst()->findStitch(stitch);
 
-        ui->originalStitch->addItem(QIcon(s->file()), stitch);
+        ui->originalStitch->addItem(s->icon(), stitch);
     }
 
     foreach (QString stitch, StitchLibrary::inst()->stitchList())
     {
         Stitch* s = StitchLibrary::inst()->findStitch(stitch);
 
-        ui->replacementStitch->addItem(QIcon(s->file()), stitch);
+        ui->replacementStitch->addItem(s->icon(), stitch);
     }
 }
@@ -38,6 +38,7 @@
 
 #include <QMap>
 #include "appinfo.h"
+#include "stitchiconstore.h"
 
 StitchSet::StitchSet(QObject* parent, bool isMasterSet)
     : QAbstractItemModel(parent)
@@ -49,8 +50,8 @@ StitchSet::StitchSet(QObject* parent, bool isMasterSet)
 
 StitchSet::~StitchSet()
 {
-    if (isTemporary)
-        removeDir(stitchSetFolder());
+    foreach (QString key, mIconKeys)
+        StitchIconStore::inst()->release(key);
 }
 
 /**
@@ -180,7 +181,7 @@ StitchSet::loadDataFile(QString fileName, QString dest)
 
     stitchSetFileName = dest;
 
-    loadIcons(&in);
+    loadIcons(&in, true);
 
     QByteArray docData;
     in >> docData;
@@ -207,13 +208,21 @@ StitchSet::loadDataFile(QString fileName, QString dest)
 }
 
 void
-StitchSet::loadIcons(QDataStream* in)
+StitchSet::loadIcons(QDataStream* in, bool toDisk)
 {
     QMap<QString, QByteArray> icons;
     *in >> icons;
 
     foreach (QString key, icons.keys())
     {
+        if (!toDisk)
+        {
+            if (mIconKeys.contains(key))
+                StitchIconStore::inst()->release(mIconKeys.value(key));
+            mIconKeys.insert(key, StitchIconStore::inst()->acquire(icons[key]));
+            continue;
+        }
+
         QFile f(stitchSetFolder() + key);
         f.open(QIODevice::WriteOnly);
         f.write(icons[key]);
@@ -221,6 +230,30 @@ StitchSet::loadIcons(QDataStream* in)
     }
 }
 
+void
+StitchSet::saveIconsToDisk()
+{
+    foreach (Stitch* s, mStitches)
+    {
+        if (!s->isIconInMemory())
+            continue;
+
+        QDir().mkpath(stitchSetFolder());
+        QString fileName = stitchSetFolder() + QFileInfo(s->file()).fileName();
+
+        QFile f(fileName);
+        if (!f.open(QIODevice::WriteOnly))
+        {
+            qWarning() << "Couldn't write the stitch icon" << fileName;
+            continue;
+        }
+        f.write(s->iconData());
+        f.close();
+
+        s->setFile(fileName);
+    }
+}
+
 void
 StitchSet::loadXmlStitchSet(QXmlStreamReader* stream, bool loadIcons)
 {
@@ -265,7 +298,9 @@ StitchSet::loadXmlStitch(QXmlStreamReader* stream, bool loadIcon)
             else if (name == "icon")
             {
                 QString filePath = stream->readElementText();
-                if (loadIcon && !filePath.startsWith(":/"))
+                if (loadIcon && mIconKeys.contains(filePath))
+                    s->setFile(StitchIconStore::iconPath(mIconKeys.value(filePath), filePath));
+                else if (loadIcon && !filePath.startsWith(":/"))
                     s->setFile(stitchSetFolder() + filePath);
                 else
                     s->setFile(filePath);
@@ -297,6 +332,9 @@ StitchSet::saveXmlFile(QString fileName)
         QDir(Settings::inst()->userSettingsFolder()).mkpath(QFileInfo(fileName).absolutePath());
     }
 
+    // the xml file references icons by path so they have to exist on disk.
+    saveIconsToDisk();
+
     QString* data = new QString();
 
     QXmlStreamWriter stream(data);
@@ -364,13 +402,7 @@ StitchSet::saveIcons(QDataStream* out)
     foreach (Stitch* s, mStitches)
     {
         if (!s->file().startsWith(":/"))
-        {
-            qDebug() << "doesn't start with :/";
-            QFile f(s->file());
-            f.open(QIODevice::ReadOnly);
-            icons.insert(QFileInfo(s->file()).fileName(), f.readAll());
-            f.close();
-        }
+            icons.insert(QFileInfo(s->file()).fileName(), s->iconData());
     }
     *out << icons;
 }
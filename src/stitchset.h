@@ -22,6 +22,7 @@
 #define STITCHSET_H
 
 #include <QList>
+#include <QMap>
 #include <QAbstractItemModel>
 #include "stitch.h"
 
@@ -42,6 +43,7 @@ class StitchSet : public QAbstractItemModel
     friend class FileFactory;
     friend class File_v1;
     friend class File_v2;
+    friend class TestStitchSet;
 
 public:
     enum SaveVersion
@@ -192,7 +194,17 @@ protected:
     void saveXmlStitchSet(QXmlStreamWriter* stream, bool saveIcons = false);
 
     void saveIcons(QDataStream* out);
-    void loadIcons(QDataStream* in);
+
+    /**
+     * load the icons embedded in a file. By default the icons are kept in the StitchIconStore,
+     * \param toDisk writes them into the stitchSetFolder() instead, for sets the user imports.
+     */
+    void loadIcons(QDataStream* in, bool toDisk = false);
+
+    /**
+     * write any icons held in memory out to the stitchSetFolder() so the set can be reloaded.
+     */
+    void saveIconsToDisk();
 
 private:
     /**
@@ -213,6 +225,11 @@ private:
 
     QString mName, mAuthor, mEmail, mOrg, mUrl;
 
+    /**
+     * embedded icon file name -> StitchIconStore key, for icons loaded into memory.
+     */
+    QMap<QString, QString> mIconKeys;
+
     /***************************************************************\
     |QAbstractItemModel
     \***************************************************************/
@@ -0,0 +1,470 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "svgsymbolwriter.h"
+
+#include <QBuffer>
+#include <QFontMetricsF>
+#include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
+#include <QGraphicsPathItem>
+#include <QGraphicsPolygonItem>
+#include <QGraphicsRectItem>
+#include <QTextDocument>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtSvg/QSvgRenderer>
+
+#include "cell.h"
+#include "ChartImage.h"
+#include "debug.h"
+#include "indicator.h"
+#include "itemgroup.h"
+#include "settings.h"
+
+static const QString sSvgNs = "http://www.w3.org/2000/svg";
+static const QString sXlinkNs = "http://www.w3.org/1999/xlink";
+
+SvgSymbolWriter::SvgSymbolWriter()
+{
+}
+
+bool
+SvgSymbolWriter::write(QIODevice* device, const QList<QGraphicsItem*>& items, const QRectF& viewBox)
+{
+    mSymbols.clear();
+
+    QXmlStreamWriter stream(device);
+    stream.writeStartDocument();
+
+    stream.writeStartElement("svg");
+    stream.writeDefaultNamespace(sSvgNs);
+    stream.writeNamespace(sXlinkNs, "xlink");
+    stream.writeAttribute("version", "1.1");
+    stream.writeAttribute("width", number(viewBox.width()));
+    stream.writeAttribute("height", number(viewBox.height()));
+    stream.writeAttribute("viewBox", QString("%1 %2 %3 %4")
+                                         .arg(number(viewBox.x()))
+                                         .arg(number(viewBox.y()))
+                                         .arg(number(viewBox.width()))
+                                         .arg(number(viewBox.height())));
+
+    if (!mTitle.isEmpty())
+        stream.writeTextElement("title", mTitle);
+    if (!mDescription.isEmpty())
+        stream.writeTextElement("desc", mDescription);
+
+    // collect the symbols first so they can all be written in one <defs> block.
+    stream.writeStartElement("defs");
+    foreach (QGraphicsItem* item, items)
+    {
+        if (item->type() != Cell::Type || !item->isVisible())
+            continue;
+
+        Cell* c = qgraphicsitem_cast<Cell*>(item);
+        if (!c->stitch())
+            continue;
+
+        QString key = symbolKey(c);
+        if (mSymbols.contains(key))
+            continue;
+
+        QString id = QString("s%1").arg(mSymbols.count());
+        mSymbols.insert(key, id);
+        writeSymbol(&stream, c, id);
+    }
+    stream.writeEndElement();  // defs
+
+    foreach (QGraphicsItem* item, items)
+    {
+        if (!item->isVisible())
+            continue;
+
+        switch (item->type())
+        {
+        case Cell::Type:
+            writeCell(&stream, qgraphicsitem_cast<Cell*>(item));
+            break;
+        case Indicator::Type:
+            writeIndicator(&stream, qgraphicsitem_cast<Indicator*>(item));
+            break;
+        case ChartImage::Type:
+            writeImage(&stream, qgraphicsitem_cast<ChartImage*>(item));
+            break;
+        case ItemGroup::Type:
+            // groups don't draw anything themselves.
+            break;
+        default:
+            writeShape(&stream, item);
+            break;
+        }
+    }
+
+    stream.writeEndElement();  // svg
+    stream.writeEndDocument();
+
+    return !stream.hasError();
+}
+
+QString
+SvgSymbolWriter::symbolKey(Cell* c) const
+{
+    QString key = QString::number((quintptr)c->stitch(), 16);
+
+    if (c->stitch()->isSvg())
+        key += c->color().name();
+
+    QColor bg = c->bgColor();
+    if (bg.isValid() && bg != Qt::white)
+        key += "/" + bg.name();
+
+    return key;
+}
+
+void
+SvgSymbolWriter::writeSymbol(QXmlStreamWriter* stream, Cell* c, const QString& id)
+{
+    Stitch* s = c->stitch();
+    QRectF rect = c->boundingRect();
+
+    stream->writeStartElement("symbol");
+    stream->writeAttribute("id", id);
+    // draw in the cell's own coordinates, the <use> doesn't need a size.
+    stream->writeAttribute("overflow", "visible");
+
+    QColor bg = c->bgColor();
+    if (bg.isValid() && bg != Qt::white)
+    {
+        stream->writeEmptyElement("rect");
+        stream->writeAttribute("x", number(rect.x()));
+        stream->writeAttribute("y", number(rect.y()));
+        stream->writeAttribute("width", number(rect.width()));
+        stream->writeAttribute("height", number(rect.height()));
+        stream->writeAttribute("fill", bg.name());
+    }
+
+    if (s->isSvg())
+    {
+        QSvgRenderer* r = s->renderSvg(c->color());
+        QRectF viewBox = r ? r->viewBoxF() : rect;
+
+        // QGraphicsSvgItem stretches the view box over the bounding rect.
+        stream->writeStartElement("svg");
+        stream->writeAttribute("x", number(rect.x()));
+        stream->writeAttribute("y", number(rect.y()));
+        stream->writeAttribute("width", number(rect.width()));
+        stream->writeAttribute("height", number(rect.height()));
+        stream->writeAttribute("viewBox", QString("%1 %2 %3 %4")
+                                              .arg(number(viewBox.x()))
+                                              .arg(number(viewBox.y()))
+                                              .arg(number(viewBox.width()))
+                                              .arg(number(viewBox.height())));
+        stream->writeAttribute("preserveAspectRatio", "none");
+        writeSvgContents(stream, s->svgData(c->color().name()), id);
+        stream->writeEndElement();  // svg
+    }
+    else
+    {
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        s->renderPixmap()->save(&buffer, "PNG");
+
+        stream->writeEmptyElement("image");
+        stream->writeAttribute("x", number(rect.x()));
+        stream->writeAttribute("y", number(rect.y()));
+        stream->writeAttribute("width", number(rect.width()));
+        stream->writeAttribute("height", number(rect.height()));
+        stream->writeAttribute(sXlinkNs, "href",
+                               "data:image/png;base64," + QString::fromLatin1(png.toBase64()));
+    }
+
+    stream->writeEndElement();  // symbol
+}
+
+void
+SvgSymbolWriter::writeSvgContents(QXmlStreamWriter* stream, const QByteArray& data,
+                                  const QString& id)
+{
+    QXmlStreamReader reader(data);
+    // ids are prefixed with the symbol id so they stay unique across symbols.
+    QString prefix = id + "-";
+    int depth = 0;
+
+    while (!reader.atEnd())
+    {
+        reader.readNext();
+
+        if (reader.isStartElement())
+        {
+            depth++;
+            // the root element is replaced by the symbol's own <svg>.
+            if (depth == 1)
+                continue;
+
+            // drop editor data like sodipodi:namedview and <metadata>.
+            QStringRef ns = reader.namespaceUri();
+            if ((!ns.isEmpty() && ns != sSvgNs) || reader.name() == QLatin1String("metadata"))
+            {
+                reader.skipCurrentElement();
+                depth--;
+                continue;
+            }
+
+            stream->writeStartElement(reader.name().toString());
+            foreach (const QXmlStreamAttribute& attr, reader.attributes())
+            {
+                QString value = attr.value().toString();
+
+                if (attr.namespaceUri().isEmpty())
+                {
+                    if (attr.name() == QLatin1String("id"))
+                        value.prepend(prefix);
+                    else
+                        value.replace("url(#", "url(#" + prefix);
+                    stream->writeAttribute(attr.name().toString(), value);
+                }
+                else if (attr.namespaceUri() == sXlinkNs)
+                {
+                    if (value.startsWith('#'))
+                        value.insert(1, prefix);
+                    stream->writeAttribute(sXlinkNs, attr.name().toString(), value);
+                }
+            }
+        }
+        else if (reader.isEndElement())
+        {
+            depth--;
+            if (depth == 0)
+                break;
+            stream->writeEndElement();
+        }
+        else if (reader.isCharacters() && !reader.isWhitespace() && depth > 1)
+        {
+            stream->writeCharacters(reader.text().toString());
+        }
+    }
+
+    if (reader.hasError())
+        qWarning() << "Error copying stitch svg:" << reader.errorString();
+}
+
+void
+SvgSymbolWriter::writeCell(QXmlStreamWriter* stream, Cell* c)
+{
+    QString id = mSymbols.value(symbolKey(c));
+    if (id.isEmpty())
+        return;
+
+    stream->writeEmptyElement("use");
+    stream->writeAttribute(sXlinkNs, "href", "#" + id);
+
+    QString t = transform(c);
+    if (!t.isEmpty())
+        stream->writeAttribute("transform", t);
+}
+
+void
+SvgSymbolWriter::writeIndicator(QXmlStreamWriter* stream, Indicator* i)
+{
+    QString color = Settings::inst()->value("chartIndicatorColor").toString();
+    QString style = i->style();
+
+    stream->writeStartElement("g");
+    QString t = transform(i);
+    if (!t.isEmpty())
+        stream->writeAttribute("transform", t);
+
+    if (style == "Dots" || style == "Dots and Text")
+    {
+        stream->writeEmptyElement("circle");
+        stream->writeAttribute("cx", "5");
+        stream->writeAttribute("cy", "5");
+        stream->writeAttribute("r", "5");
+        stream->writeAttribute("fill", color);
+    }
+
+    if (style == "Text" || style == "Dots and Text")
+    {
+        QFont font = i->font();
+        QFontMetricsF fm(font);
+        qreal margin = i->document()->documentMargin();
+
+        stream->writeStartElement("text");
+        stream->writeAttribute("font-family", font.family());
+        if (font.pointSizeF() > 0)
+            stream->writeAttribute("font-size", number(font.pointSizeF()) + "pt");
+        else
+            stream->writeAttribute("font-size", number(font.pixelSize()) + "px");
+        stream->writeAttribute("fill", i->defaultTextColor().name());
+
+        QStringList lines = i->toPlainText().split('\n');
+        for (int l = 0; l < lines.count(); ++l)
+        {
+            stream->writeStartElement("tspan");
+            stream->writeAttribute("x", number(margin));
+            stream->writeAttribute("y", number(margin + fm.ascent() + l * fm.lineSpacing()));
+            stream->writeCharacters(lines.at(l));
+            stream->writeEndElement();
+        }
+
+        stream->writeEndElement();  // text
+    }
+
+    stream->writeEndElement();  // g
+}
+
+void
+SvgSymbolWriter::writeImage(QXmlStreamWriter* stream, ChartImage* image)
+{
+    QImage pixels = image->image();
+    if (pixels.isNull())
+        return;
+
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    pixels.save(&buffer, "PNG");
+
+    QRectF rect = image->boundingRect();
+
+    stream->writeEmptyElement("image");
+    stream->writeAttribute("x", number(rect.x()));
+    stream->writeAttribute("y", number(rect.y()));
+    stream->writeAttribute("width", number(pixels.width()));
+    stream->writeAttribute("height", number(pixels.height()));
+    stream->writeAttribute(sXlinkNs, "href",
+                           "data:image/png;base64," + QString::fromLatin1(png.toBase64()));
+
+    QString t = transform(image);
+    if (!t.isEmpty())
+        stream->writeAttribute("transform", t);
+}
+
+void
+SvgSymbolWriter::writeShape(QXmlStreamWriter* stream, QGraphicsItem* item)
+{
+    QPen pen;
+    QBrush brush;
+    QPainterPath path;
+
+    if (QGraphicsLineItem* line = dynamic_cast<QGraphicsLineItem*>(item))
+    {
+        pen = line->pen();
+        path.moveTo(line->line().p1());
+        path.lineTo(line->line().p2());
+    }
+    else if (QGraphicsEllipseItem* ellipse = dynamic_cast<QGraphicsEllipseItem*>(item))
+    {
+        pen = ellipse->pen();
+        brush = ellipse->brush();
+        path.addEllipse(ellipse->rect());
+    }
+    else if (QGraphicsRectItem* rect = dynamic_cast<QGraphicsRectItem*>(item))
+    {
+        pen = rect->pen();
+        brush = rect->brush();
+        path.addRect(rect->rect());
+    }
+    else if (QGraphicsPathItem* p = dynamic_cast<QGraphicsPathItem*>(item))
+    {
+        pen = p->pen();
+        brush = p->brush();
+        path = p->path();
+    }
+    else if (QGraphicsPolygonItem* polygon = dynamic_cast<QGraphicsPolygonItem*>(item))
+    {
+        pen = polygon->pen();
+        brush = polygon->brush();
+        path.addPolygon(polygon->polygon());
+        path.closeSubpath();
+    }
+    else
+    {
+        return;
+    }
+
+    QString d;
+    for (int i = 0; i < path.elementCount(); ++i)
+    {
+        const QPainterPath::Element& e = path.elementAt(i);
+        switch (e.type)
+        {
+        case QPainterPath::MoveToElement:
+            d += "M";
+            break;
+        case QPainterPath::LineToElement:
+            d += "L";
+            break;
+        case QPainterPath::CurveToElement:
+            d += "C";
+            break;
+        case QPainterPath::CurveToDataElement:
+            d += " ";
+            break;
+        }
+        d += number(e.x) + " " + number(e.y);
+    }
+
+    stream->writeEmptyElement("path");
+    stream->writeAttribute("d", d);
+    stream->writeAttribute("fill", brush.style() == Qt::NoBrush ? "none" : brush.color().name());
+    if (pen.style() == Qt::NoPen)
+    {
+        stream->writeAttribute("stroke", "none");
+    }
+    else
+    {
+        stream->writeAttribute("stroke", pen.color().name());
+        stream->writeAttribute("stroke-width", number(pen.widthF() > 0 ? pen.widthF() : 1));
+    }
+
+    QString t = transform(item);
+    if (!t.isEmpty())
+        stream->writeAttribute("transform", t);
+}
+
+QString
+SvgSymbolWriter::transform(QGraphicsItem* item)
+{
+    // the scene transform combines the position, the rotation and scale set through
+    // ChartItemTools and the transforms of any parent groups.
+    QTransform t = item->sceneTransform();
+
+    if (t.type() == QTransform::TxNone)
+        return QString();
+
+    if (t.type() == QTransform::TxTranslate)
+        return "translate(" + number(t.dx()) + " " + number(t.dy()) + ")";
+
+    return QString("matrix(%1 %2 %3 %4 %5 %6)")
+        .arg(number(t.m11()))
+        .arg(number(t.m12()))
+        .arg(number(t.m21()))
+        .arg(number(t.m22()))
+        .arg(number(t.dx()))
+        .arg(number(t.dy()));
+}
+
+QString
+SvgSymbolWriter::number(qreal value)
+{
+    return QString::number(value, 'g', 7);
+}
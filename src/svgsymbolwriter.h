@@ -0,0 +1,95 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef SVGSYMBOLWRITER_H
+#define SVGSYMBOLWRITER_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+#include <QString>
+
+class Cell;
+class ChartImage;
+class Indicator;
+class QGraphicsItem;
+class QIODevice;
+class QXmlStreamWriter;
+
+/**
+ * Writes chart items to an svg file without going through a QPainter.
+ *
+ * Each stitch, color and background combination is written once into <defs> as a <symbol> and
+ * every cell becomes a <use> with the cell's scene transform, so the output grows with the
+ * number of cells instead of the number of cells times the size of the stitch artwork.
+ */
+class SvgSymbolWriter
+{
+public:
+    SvgSymbolWriter();
+
+    void
+    setTitle(const QString& title)
+    {
+        mTitle = title;
+    }
+    void
+    setDescription(const QString& description)
+    {
+        mDescription = description;
+    }
+
+    /**
+     * write the items, which must be in ascending stacking order, to device. viewBox is the
+     * area of the scene shown in the output.
+     */
+    bool write(QIODevice* device, const QList<QGraphicsItem*>& items, const QRectF& viewBox);
+
+    /**
+     * the number of symbols written by the last call to write().
+     */
+    int
+    symbolCount() const
+    {
+        return mSymbols.count();
+    }
+
+private:
+    QString symbolKey(Cell* c) const;
+
+    void writeSymbol(QXmlStreamWriter* stream, Cell* c, const QString& id);
+    void writeSvgContents(QXmlStreamWriter* stream, const QByteArray& data, const QString& id);
+
+    void writeCell(QXmlStreamWriter* stream, Cell* c);
+    void writeIndicator(QXmlStreamWriter* stream, Indicator* i);
+    void writeImage(QXmlStreamWriter* stream, ChartImage* image);
+    void writeShape(QXmlStreamWriter* stream, QGraphicsItem* item);
+
+    static QString transform(QGraphicsItem* item);
+    static QString number(qreal value);
+
+    QString mTitle;
+    QString mDescription;
+
+    // symbol key -> symbol id
+    QHash<QString, QString> mSymbols;
+};
+
+#endif  // SVGSYMBOLWRITER_H
@@ -24,7 +24,7 @@
 #include "settings.h"
 #include "scene.h"
 
-#include <math.h>
+#include <algorithm>
 
 TextView::TextView(QWidget* parent, Scene* scene)
     : QObject(parent)
@@ -36,33 +36,32 @@ TextView::~TextView()
 {
 }
 
+void
+TextView::setScene(Scene* scene)
+{
+    mScene = scene;
+    clearCache();
+}
+
+void
+TextView::clearCache()
+{
+    mRows.clear();
+    mCellRows.clear();
+}
+
 QString
 TextView::generateTextRow(int row, bool cleanOutput, bool useRepeats)
 {
-    QString rowText = "";
-    QString curStitch;
+    bool genRepeats = Settings::inst()->value("generateTextRepeats").toBool();
+    useRepeats = useRepeats && genRepeats;
 
-    QStringList rowList;
+    RowCache* cache = rowCache(row);
+    int variant = (cleanOutput ? 1 : 0) | (useRepeats ? 2 : 0);
+    if (cache && !cache->text[variant].isNull())
+        return cache->text[variant];
 
-    int cols = mScene->columnCount(row);
-
-    // create a list of stitches
-    for (int c = 0; c < cols; ++c)
-    {
-        qDebug() << "row iteration!";
-        Cell* cell = mScene->grid[row][c];
-        if (!cell)
-            continue;
-
-        curStitch = cell->name();
-        if (cleanOutput)
-        {
-            // TODO: any special preprocessing that needs to be done.
-        }
-        rowList.append(curStitch);
-        curStitch = "";
-    }
-    rowText = generateText(rowList, useRepeats);
+    QString rowText = generateText(cache ? cache->stitches : QVector<int>(), useRepeats);
 
     if (cleanOutput)
     {
@@ -79,137 +78,142 @@ TextView::generateTextRow(int row, bool cleanOutput, bool useRepeats)
         rowText += ".";
     }
 
+    if (cache)
+        cache->text[variant] = rowText;
     return rowText;
 }
 
-QString
-TextView::generateText(QStringList row, bool /*useRepeats*/)
+TextView::RowCache*
+TextView::rowCache(int row)
 {
-    QString text;
-    QString curStitch, previousStitch;
-    QMap<QString, QStringList> data;
-    int count = 1;
-    bool firstPass = true;
-
-    // TODO bool genRepeats = Settings::inst()->value("generateTextRepeats").toBool();
-    QString prefix = ".sws_";
+    int cols = mScene->columnCount(row);
+    if (cols == 0)
+        return nullptr;
 
-    /*if(genRepeats && useRepeats) {
-        data = generateRepeats(row, prefix);
-        row = data.value("row");
-    }*/
+    const QList<Cell*>& cells = mScene->grid[row];
+    Cell* first = nullptr;
+    foreach (Cell* cell, cells)
+    {
+        if (cell)
+        {
+            first = cell;
+            break;
+        }
+    }
+    if (!first)
+        return nullptr;
 
-    previousStitch = "";
-    for (int i = 0; i < row.count(); ++i)
+    // rows are found by their first cell so adding or moving rows doesn't clear the others.
+    QHash<Cell*, RowCache>::iterator it = mRows.find(first);
+    if (it != mRows.end())
     {
-        curStitch = row.value(i);
+        if (it->cells.count() == cols && std::equal(cells.begin(), cells.end(), it->cells.begin()))
+            return &it.value();
+        dropRow(first);
+    }
 
-        if (curStitch != previousStitch)
-        {
-            if (!firstPass)
-                text += ", ";
+    RowCache cache;
+    cache.cells.reserve(cols);
+    cache.stitches.reserve(cols);
 
-            if (curStitch.startsWith(prefix))
-            {
-                text += "[" + generateText(data.value(curStitch)) + "]";
-            }
-            else
-                text += curStitch;
-        }
+    foreach (Cell* cell, cells)
+    {
+        cache.cells.append(cell);
+        if (!cell)
+            continue;
 
-        if (curStitch == previousStitch)
-        {
-            count++;
-        }
-        else
+        QString name = cell->name();
+        QHash<QString, int>::const_iterator code = mStitchCodes.constFind(name);
+        if (code == mStitchCodes.constEnd())
         {
-            text += " " + QString::number(count);
-            count = 1;
-            if (curStitch.startsWith(prefix))
-                text += " times";
+            code = mStitchCodes.insert(name, mStitchNames.count());
+            mStitchNames.append(name);
         }
+        cache.stitches.append(code.value());
 
-        previousStitch = curStitch;
-        firstPass = false;
+        connect(cell, SIGNAL(stitchChanged(QString, QString)), SLOT(cellChanged()),
+                Qt::UniqueConnection);
+        connect(cell, SIGNAL(destroyed(QObject*)), SLOT(cellDestroyed(QObject*)),
+                Qt::UniqueConnection);
+        mCellRows.insert(cell, first);
     }
 
-    return text;
+    return &mRows.insert(first, cache).value();
 }
 
-QMap<QString, QStringList>
-TextView::generateRepeats(QStringList stitches, QString prefix)
+void
+TextView::dropRow(Cell* first)
 {
-    QMap<QString, QStringList> data;
-    QStringList row;
-    int count = stitches.count();
-    bool repeat = true;
-
-    // loop through each stitch in the row to find matches.
-    for (int i = 0; i < count; ++i)
+    RowCache cache = mRows.take(first);
+    foreach (Cell* cell, cache.cells)
     {
-        QStringList stRepeat;
-
-        int match = stitches.indexOf(stitches[i], i + 1);
+        if (cell && mCellRows.value(cell) == first)
+            mCellRows.remove(cell);
+    }
+}
 
-        // no match for this stitch
-        if (match == -1)
-        {
-            continue;
-        }
+void
+TextView::cellChanged()
+{
+    Cell* first = mCellRows.value(sender());
+    if (first)
+        dropRow(first);
+}
 
-        int diff = match - i;
-        // don't try to match beyond the end of the array.
-        int endDiff = stitches.count() - match;
-        if (endDiff < diff)
-            diff = endDiff;
+void
+TextView::cellDestroyed(QObject* cell)
+{
+    Cell* first = mCellRows.take(cell);
+    if (first)
+        dropRow(first);
+}
 
-        // walk through the match and see if it is a repeat.
-        for (int j = i; j < match; j++)
+QString
+TextView::generateText(const QVector<int>& row, bool useRepeats)
+{
+    QList<RepeatFinder::Item> items;
+    if (useRepeats)
+    {
+        items = RepeatFinder::group(row);
+    }
+    else
+    {
+        foreach (int stitch, row)
         {
-            qDebug() << j << stitches[j] << j + diff << stitches[j + diff];
-            if (stitches[j] != stitches[j + diff])
-                repeat = false;
-            else
+            if (!items.isEmpty() && items.last().value == stitch)
             {
-                stRepeat.append(stitches[j]);
+                items.last().count++;
+                continue;
             }
-        }
 
-        if (!repeat)
-        {
-            if (stRepeat.count() <= 1)
-            {
-                stRepeat.clear();
-                repeat = true;
-            }
+            RepeatFinder::Item item;
+            item.value = stitch;
+            item.count = 1;
+            items.append(item);
         }
-
-        data.insert(prefix + QString::number(i), stRepeat);
     }
 
-    data.insert("row", row);
-
-    qDebug() << data;
-    return data;
+    return generateText(items);
 }
 
-int
-TextView::matchCount(QStringList stitches, int startPos, int length)
+QString
+TextView::generateText(const QList<RepeatFinder::Item>& items)
 {
-    QStringList sub;
-    int count = 0;
-
-    for (int i = 0; i < length; ++i)
-        sub.append(stitches.value(startPos + i));
+    QStringList parts;
 
-    for (int i = startPos; i < stitches.count(); ++i)
+    foreach (const RepeatFinder::Item& item, items)
     {
-        if (sub.value(i % length) != stitches.value(i))
-            break;
-        count = floor(double(i + 1 - startPos) / length);
+        if (item.value == -1)
+        {
+            parts.append(tr("[%1] %2 times").arg(generateText(item.items)).arg(item.count));
+        }
+        else
+        {
+            parts.append(mStitchNames.value(item.value) + " " + QString::number(item.count));
+        }
     }
 
-    return count;
+    return parts.join(", ");
 }
 
 QString
@@ -242,83 +246,53 @@ TextView::copyInstructions()
         rowText << generateTextRow(r, true, true);
     }
 
-    QMap<QString, QStringList> data;
-    QString prefix = ".sws_rows_";
+    // blocks of rows that repeat the rows right before them get one line.
+    QVector<int> sequence = RepeatFinder::encode(rowText);
+    QList<RepeatFinder::Run> runs = RepeatFinder::selectRuns(RepeatFinder(sequence).runs());
 
-    data = generateRepeatRows(rowText, prefix);
+    QHash<QString, int> firstRow;
+    int nextRun = 0;
 
-    for (int i = 0; i < rowText.count(); ++i)
+    for (int r = 0; r < rowText.count();)
     {
-        QString row = rowText[i];
-        // don't match rows that are already repeats.
-        if (row.startsWith(tr("Repeat row")))
-            continue;
-
-        if (rowText.count(row) > 1)
+        if (nextRun < runs.count() && r == runs[nextRun].start + runs[nextRun].period)
         {
-            for (int j = i + 1; j < rowText.count(); ++j)
-            {
-                if (rowText[j] == row)
-                    rowText[j] = tr("Repeat row %1.").arg(i + 1);
-            }
+            const RepeatFinder::Run& run = runs[nextRun];
+            int last = run.end() - 1;
+
+            if (run.period > 1)
+                text += tr("Rows %1-%2: Repeat rows %3-%4.\n")
+                            .arg(r + 1)
+                            .arg(last + 1)
+                            .arg(run.start + 1)
+                            .arg(run.start + run.period);
+            else if (last > r)
+                text += tr("Rows %1-%2: Repeat row %3.\n")
+                            .arg(r + 1)
+                            .arg(last + 1)
+                            .arg(run.start + 1);
+            else
+                text += tr("Row %1: Repeat row %2.\n").arg(r + 1).arg(run.start + 1);
+
+            r = run.end();
+            ++nextRun;
+            continue;
         }
-    }
 
-    for (int i = 0; i < rowText.count(); ++i)
-        text += tr("Row %1: %2\n").arg(i + 1).arg(rowText[i]);
+        QString row = rowText[r];
+        // don't write out rows that are the same as an earlier row.
+        if (firstRow.contains(row))
+            row = tr("Repeat row %1.").arg(firstRow.value(row) + 1);
+        else
+            firstRow.insert(row, r);
+
+        text += tr("Row %1: %2\n").arg(r + 1).arg(row);
+        ++r;
+    }
 
     if (text == "")
         text
             = "There are no rows on this chart, to create rows please goto the \"Modes\" menu and "
               "select \"Row Edit\"";
-    qDebug() << text;
     return text;
 }
-
-QMap<QString, QStringList>
-TextView::generateRepeatRows(QStringList rows, QString prefix)
-{
-    QMap<QString, QStringList> data;
-    QStringList newRows;
-    int count = rows.count();
-
-    for (int i = 0; i < count; ++i)
-    {
-        QString value = rows.value(i);
-        for (int j = i + 1; j < count; ++j)
-        {
-            if (rows.value(i) == rows.value(j))
-            {
-                int diff = j - i;
-                int diffSts = false;
-                for (int l = 0; l <= diff; ++l)
-                {
-                    if (rows.value(i + l) != rows.value(i))
-                        diffSts = true;
-                }
-                if (!diffSts)
-                    continue;
-
-                int count = matchCount(rows, i, diff);
-
-                if (count > 1)
-                {
-                    QStringList sub;
-                    for (int k = 0; k < diff; ++k)
-                    {
-                        sub.append(rows.value(k));
-                        newRows.append(prefix + QString::number(i));
-                    }
-                    data.insert(prefix + QString::number(i), sub);
-                    j += (diff * count);
-                    i += (diff * count);
-                }
-            }
-        }
-        if (i < count)
-            newRows.append(value);
-    }
-
-    data.insert("rows", newRows);
-    return data;
-}
@@ -24,6 +24,9 @@
 #include <QObject>
 #include <QMap>
 
+#include "repeatfinder.h"
+
+class Cell;
 class Scene;
 
 class TextView : public QObject
@@ -34,11 +37,12 @@ public:
     TextView(QWidget* parent = nullptr, Scene* scene = nullptr);
     ~TextView();
 
-    void
-    setScene(Scene* scene)
-    {
-        mScene = scene;
-    }
+    void setScene(Scene* scene);
+
+    /**
+     * forget the text of every row, the cache clears itself when rows change.
+     */
+    void clearCache();
 
     QString copyInstructions();
 
@@ -48,35 +52,52 @@ public:
      **/
     QString generateTextRow(int row, bool cleanOutput = false, bool useRepeats = false);
 
+private slots:
+    void cellChanged();
+    void cellDestroyed(QObject* cell);
+
 private:
     /**
-     * This function strips off any incomplete repeat indicators or other
-     * special text input from the user input that might be incomplete.
+     * The stitches of a row and the text generated for it.
      */
-    QString cleanToken(QString token);
+    struct RowCache
+    {
+        QVector<Cell*> cells;
+        QVector<int> stitches;
+        // indexed by cleanOutput | useRepeats << 1.
+        QString text[4];
+    };
 
     /**
-     * @brief generateRepeats - extract repeats from a row of stitches.
-     * @param stitches - the row of stitches
-     * @param prefix - the prefix to use as a substitute for a match
-     * @return the original row and any substitutes created in place of repeats.
+     * the cache for row, rebuilt if the cells in the row aren't the cached ones.
+     * Returns null for a row without cells.
      */
-    QMap<QString, QStringList> generateRepeats(QStringList stitches, QString prefix);
-
-    QMap<QString, QStringList> generateRepeatRows(QStringList stitches, QString prefix);
+    RowCache* rowCache(int row);
+    void dropRow(Cell* first);
 
     /**
-     * Take a list of stitches and convert them into a crochet sentence.
+     * This function strips off any incomplete repeat indicators or other
+     * special text input from the user input that might be incomplete.
      */
-    QString generateText(QStringList row, bool useRepeats = false);
+    QString cleanToken(QString token);
 
     /**
-     * Returns the number of repeat matches occurring in stitches
+     * Take a row of stitch codes and convert them into a crochet sentence.
+     * If useRepeats = true repeated groups of stitches are written as "[...] n times".
      */
-    int matchCount(QStringList stitches, int startPos, int length);
+    QString generateText(const QVector<int>& row, bool useRepeats = false);
+
+    QString generateText(const QList<RepeatFinder::Item>& items);
 
 private:
     Scene* mScene;
+
+    // cached rows by their first cell, and the first cell of the row each cached cell is in.
+    QHash<Cell*, RowCache> mRows;
+    QHash<QObject*, Cell*> mCellRows;
+
+    QHash<QString, int> mStitchCodes;
+    QStringList mStitchNames;
 };
 
 #endif  // TEXTVIEW_H
@@ -0,0 +1,496 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "tiledimage.h"
+
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtMath>
+
+#include <cmath>
+
+struct TiledImage::Source
+{
+    // the image is decoded from the file unless it's already in memory.
+    QString fileName;
+    QImage image;
+    // the reader can decode just the part of the file a batch of tiles needs. If it can't the
+    // whole file is decoded into image once and every tile is cut from that.
+    bool clip;
+    QMutex mutex;
+};
+
+/**
+ * the whole image of a source that isn't decoded a piece at a time.
+ */
+static QImage
+wholeImage(TiledImage::Source& source)
+{
+    QMutexLocker locker(&source.mutex);
+    if (source.image.isNull() && !source.fileName.isEmpty())
+    {
+        QImageReader reader(source.fileName);
+        source.image = reader.read();
+    }
+    return source.image;
+}
+
+/**
+ * decode tiles, a rect of tile numbers, of level from source. The tiles are returned row by
+ * row, or none if the image couldn't be read.
+ */
+static QVector<QImage>
+decodeTiles(TiledImage::Source& source, const QSize& size, int level, const QRect& tiles)
+{
+    const int t = TILED_IMAGE_TILE_SIZE;
+    int span = t << level;
+
+    QSize levelSize((size.width() + (1 << level) - 1) >> level,
+                    (size.height() + (1 << level) - 1) >> level);
+    QRect area = QRect(tiles.x() * span, tiles.y() * span, tiles.width() * span,
+                       tiles.height() * span)
+                 & QRect(QPoint(0, 0), size);
+    QRect levelArea = QRect(tiles.x() * t, tiles.y() * t, tiles.width() * t, tiles.height() * t)
+                      & QRect(QPoint(0, 0), levelSize);
+
+    QImage image;
+    if (!source.clip)
+    {
+        image = wholeImage(source).copy(area);
+    }
+    else
+    {
+        QImageReader reader(source.fileName);
+        reader.setClipRect(area);
+        reader.setScaledSize(levelArea.size());
+        image = reader.read();
+    }
+
+    QVector<QImage> images;
+    if (image.isNull())
+        return images;
+
+    if (image.size() != levelArea.size())
+        image = image.scaled(levelArea.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y)
+    {
+        for (int x = tiles.left(); x <= tiles.right(); ++x)
+        {
+            QRect r = QRect((x - tiles.x()) * t, (y - tiles.y()) * t, t, t)
+                      & QRect(QPoint(0, 0), image.size());
+            images.append(image.copy(r));
+        }
+    }
+
+    return images;
+}
+
+/**
+ * decodes tiles on the thread pool and posts them to the TileCache.
+ */
+class TileLoader : public QRunnable
+{
+public:
+    TileLoader(quint32 id,
+               QSharedPointer<TiledImage::Source> source,
+               const QSize& size,
+               int level,
+               const QRect& tiles)
+        : mId(id)
+        , mSource(source)
+        , mSize(size)
+        , mLevel(level)
+        , mTiles(tiles)
+    {
+    }
+
+    void
+    run()
+    {
+        TileCache::inst()->post(mId, mLevel, mTiles, decodeTiles(*mSource, mSize, mLevel, mTiles));
+    }
+
+private:
+    quint32 mId;
+    QSharedPointer<TiledImage::Source> mSource;
+    QSize mSize;
+    int mLevel;
+    QRect mTiles;
+};
+
+TiledImage::TiledImage(QObject* parent)
+    : QObject(parent)
+    , mLevelCount(1)
+    , mReserved(0)
+{
+    mId = TileCache::inst()->add(this);
+}
+
+TiledImage::~TiledImage()
+{
+    TileCache::inst()->remove(mId);
+    TileCache::inst()->reserve(-mReserved);
+}
+
+bool
+TiledImage::setFile(const QString& fileName)
+{
+    QImageReader reader(fileName);
+    if (!reader.canRead())
+        return false;
+
+    QSize size = reader.size();
+    if (!size.isValid())
+    {
+        // the format doesn't say how big the image is without decoding it.
+        QImage image = reader.read();
+        if (image.isNull())
+            return false;
+
+        setImage(image);
+        return true;
+    }
+
+    QSharedPointer<Source> source(new Source);
+    source->fileName = fileName;
+    // without a clip rect the reader decodes the whole file for every batch of tiles.
+    source->clip = reader.supportsOption(QImageIOHandler::ClipRect);
+    reset(source, size);
+    return true;
+}
+
+void
+TiledImage::setImage(const QImage& image)
+{
+    QSharedPointer<Source> source(new Source);
+    source->image = image;
+    source->clip = false;
+    reset(source, image.size());
+}
+
+void
+TiledImage::reset(QSharedPointer<Source> source, const QSize& size)
+{
+    // tiles of the old image that are still loading are dropped when they arrive.
+    TileCache::inst()->remove(mId);
+    mId = TileCache::inst()->add(this);
+
+    mSource = source;
+    mSize = size;
+    mThumbnail = QPixmap();
+    mPending.clear();
+
+    // a whole image in memory takes room from the tiles.
+    TileCache::inst()->reserve(-mReserved);
+    mReserved = source->clip ? 0 : qMax(1, int(qint64(size.width()) * size.height() * 4 / 1024));
+    TileCache::inst()->reserve(mReserved);
+
+    mLevelCount = 1;
+    while (true)
+    {
+        QSize s = levelSize(mLevelCount - 1);
+        if (s.width() <= TILED_IMAGE_TILE_SIZE && s.height() <= TILED_IMAGE_TILE_SIZE)
+            break;
+        mLevelCount++;
+    }
+
+    if (!isNull())
+        loadTiles(mLevelCount - 1, QRect(0, 0, 1, 1), false);
+}
+
+QImage
+TiledImage::image() const
+{
+    if (!mSource)
+        return QImage();
+    if (!mSource->clip)
+        return wholeImage(*mSource);
+
+    QImageReader reader(mSource->fileName);
+    return reader.read();
+}
+
+QSize
+TiledImage::levelSize(int level) const
+{
+    return QSize((mSize.width() + (1 << level) - 1) >> level,
+                 (mSize.height() + (1 << level) - 1) >> level);
+}
+
+int
+TiledImage::levelFor(qreal scale) const
+{
+    if (scale <= 0)
+        return mLevelCount - 1;
+
+    // use the level that's the same size or just bigger than it's drawn.
+    int level = qFloor(std::log2(1.0 / scale));
+    return qBound(0, level, mLevelCount - 1);
+}
+
+QRectF
+TiledImage::tileRect(int level, int x, int y) const
+{
+    qreal span = TILED_IMAGE_TILE_SIZE << level;
+    return QRectF(x * span, y * span, span, span) & QRectF(QPointF(0, 0), mSize);
+}
+
+void
+TiledImage::paint(QPainter* painter, const QRectF& exposed, bool wait)
+{
+    QRectF visible = exposed & QRectF(QPointF(0, 0), mSize);
+    if (isNull() || visible.isEmpty())
+        return;
+
+    // the number of device pixels covered by one pixel of the image.
+    qreal scale = qSqrt(qAbs(painter->worldTransform().determinant()));
+    int level = levelFor(scale);
+
+    qreal span = TILED_IMAGE_TILE_SIZE << level;
+    QSize size = levelSize(level);
+    QRect all(0, 0, (size.width() + TILED_IMAGE_TILE_SIZE - 1) / TILED_IMAGE_TILE_SIZE,
+              (size.height() + TILED_IMAGE_TILE_SIZE - 1) / TILED_IMAGE_TILE_SIZE);
+    QRect tiles = QRect(QPoint(qFloor(visible.left() / span), qFloor(visible.top() / span)),
+                        QPoint(qCeil(visible.right() / span) - 1, qCeil(visible.bottom() / span) - 1))
+                  & all;
+
+    loadTiles(level, tiles, wait);
+
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y)
+    {
+        for (int x = tiles.left(); x <= tiles.right(); ++x)
+        {
+            // cover a missing tile with the closest level that has the same area.
+            QRectF target = tileRect(level, x, y);
+            for (int l = level; l < mLevelCount; ++l)
+            {
+                if (drawTile(painter, l, x >> (l - level), y >> (l - level), target))
+                    break;
+            }
+        }
+    }
+}
+
+void
+TiledImage::paintFull(QPainter* painter)
+{
+    if (isNull())
+        return;
+
+    painter->drawImage(QRectF(QPointF(0, 0), mSize), image());
+}
+
+bool
+TiledImage::drawTile(QPainter* painter, int level, int x, int y, const QRectF& target)
+{
+    QPixmap* pixmap = nullptr;
+    if (level == mLevelCount - 1)
+        pixmap = mThumbnail.isNull() ? nullptr : &mThumbnail;
+    else
+        pixmap = TileCache::inst()->tile(TileCache::key(mId, level, x, y));
+
+    if (!pixmap)
+        return false;
+
+    QRectF rect = tileRect(level, x, y);
+    qreal sx = pixmap->width() / rect.width();
+    qreal sy = pixmap->height() / rect.height();
+    QRectF source((target.left() - rect.left()) * sx, (target.top() - rect.top()) * sy,
+                  target.width() * sx, target.height() * sy);
+
+    painter->drawPixmap(target, *pixmap, source);
+    return true;
+}
+
+void
+TiledImage::loadTiles(int level, const QRect& tiles, bool wait)
+{
+    TileCache* cache = TileCache::inst();
+    bool thumbnail = level == mLevelCount - 1;
+
+    // the smallest rect of tiles that covers all the missing ones.
+    QRect missing;
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y)
+    {
+        for (int x = tiles.left(); x <= tiles.right(); ++x)
+        {
+            quint64 key = TileCache::key(mId, level, x, y);
+            bool loaded = thumbnail ? !mThumbnail.isNull() : cache->mTiles.contains(key);
+            if (loaded || (!wait && mPending.contains(key)))
+                continue;
+            missing |= QRect(x, y, 1, 1);
+        }
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    if (wait)
+    {
+        tilesReady(level, missing, decodeTiles(*mSource, mSize, level, missing), false);
+        return;
+    }
+
+    for (int y = missing.top(); y <= missing.bottom(); ++y)
+    {
+        for (int x = missing.left(); x <= missing.right(); ++x)
+            mPending.insert(TileCache::key(mId, level, x, y));
+    }
+    QThreadPool::globalInstance()->start(new TileLoader(mId, mSource, mSize, level, missing));
+}
+
+void
+TiledImage::tilesReady(int level, const QRect& tiles, const QVector<QImage>& images, bool notify)
+{
+    // the image couldn't be read, the tiles stay pending so they aren't tried again.
+    if (images.count() != tiles.width() * tiles.height())
+        return;
+
+    int i = 0;
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y)
+    {
+        for (int x = tiles.left(); x <= tiles.right(); ++x)
+        {
+            quint64 key = TileCache::key(mId, level, x, y);
+            mPending.remove(key);
+            if (level == mLevelCount - 1)
+                mThumbnail = QPixmap::fromImage(images.at(i));
+            else
+                TileCache::inst()->insert(key, images.at(i));
+            ++i;
+        }
+    }
+
+    if (notify)
+        emit tilesLoaded();
+}
+
+TileCache* TileCache::sInstance = nullptr;
+
+TileCache*
+TileCache::inst()
+{
+    if (!sInstance)
+        sInstance = new TileCache();
+    return sInstance;
+}
+
+TileCache::TileCache()
+    : QObject()
+    , mTiles(TILED_IMAGE_CACHE_SIZE)
+    , mMaxCost(TILED_IMAGE_CACHE_SIZE)
+    , mReserved(0)
+    , mNextId(1)
+{
+}
+
+void
+TileCache::setMaxCost(int kb)
+{
+    mMaxCost = kb;
+    mTiles.setMaxCost(qMax(0, mMaxCost - mReserved));
+}
+
+void
+TileCache::reserve(int kb)
+{
+    mReserved += kb;
+    mTiles.setMaxCost(qMax(0, mMaxCost - mReserved));
+}
+
+quint64
+TileCache::key(quint32 id, int level, int x, int y)
+{
+    return (quint64(id) << 31) | (quint64(level & 0x1f) << 26) | (quint64(x & 0x1fff) << 13)
+           | quint64(y & 0x1fff);
+}
+
+quint32
+TileCache::add(TiledImage* image)
+{
+    quint32 id = mNextId++;
+    mImages.insert(id, image);
+    return id;
+}
+
+void
+TileCache::remove(quint32 id)
+{
+    mImages.remove(id);
+
+    foreach (quint64 key, mTiles.keys())
+    {
+        if ((key >> 31) == id)
+            mTiles.remove(key);
+    }
+}
+
+QPixmap*
+TileCache::tile(quint64 key)
+{
+    return mTiles.object(key);
+}
+
+void
+TileCache::insert(quint64 key, const QImage& image)
+{
+    int cost = qMax(1, image.width() * image.height() * 4 / 1024);
+    mTiles.insert(key, new QPixmap(QPixmap::fromImage(image)), cost);
+}
+
+void
+TileCache::post(quint32 id, int level, const QRect& tiles, const QVector<QImage>& images)
+{
+    Result result;
+    result.id = id;
+    result.level = level;
+    result.tiles = tiles;
+    result.images = images;
+
+    QMutexLocker locker(&mMutex);
+    mResults.append(result);
+    // one delivery picks up everything posted before it runs.
+    if (mResults.count() == 1)
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void
+TileCache::deliver()
+{
+    QList<Result> results;
+    {
+        QMutexLocker locker(&mMutex);
+        results.swap(mResults);
+    }
+
+    foreach (const Result& r, results)
+    {
+        // the image was deleted or given a new file while its tiles were loading.
+        TiledImage* image = mImages.value(r.id);
+        if (!image)
+            continue;
+        image->tilesReady(r.level, r.tiles, r.images);
+    }
+}
@@ -0,0 +1,217 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+class QPainter;
+
+// the width and height of a tile in pixels.
+#define TILED_IMAGE_TILE_SIZE 256
+// the memory used by the tiles of all images, in KB.
+#define TILED_IMAGE_CACHE_SIZE (256 * 1024)
+
+/**
+ * An image that's decoded on the thread pool, a piece at a time, as it's painted.
+ *
+ * The image is split into a mip pyramid, level n is the image at 1/2^n of its size, and every
+ * level is split into tiles. Painting picks the level that matches the painter's transform and
+ * only draws the tiles that are exposed. Tiles that aren't loaded yet are queued and covered
+ * by a coarser level until they're ready. The smallest level fits in one tile and is kept
+ * with the image, the other tiles are kept in the TileCache shared by every image.
+ *
+ * Formats that can't decode part of a file, like png, are decoded once in full and the tiles
+ * are cut from that. A whole image in memory counts against the TileCache's maxCost.
+ */
+class TiledImage : public QObject
+{
+    Q_OBJECT
+    friend class TileCache;
+
+public:
+    struct Source;
+
+    explicit TiledImage(QObject* parent = nullptr);
+    ~TiledImage();
+
+    /**
+     * only reads the size of the image, returns false if it isn't a valid image.
+     */
+    bool setFile(const QString& fileName);
+    void setImage(const QImage& image);
+
+    bool
+    isNull() const
+    {
+        return mSize.isEmpty();
+    }
+    QSize
+    size() const
+    {
+        return mSize;
+    }
+
+    /**
+     * the whole image at full size, decoded now.
+     */
+    QImage image() const;
+
+    int
+    levelCount() const
+    {
+        return mLevelCount;
+    }
+    QSize levelSize(int level) const;
+
+    /**
+     * the level to paint with when one pixel of the image covers scale pixels.
+     */
+    int levelFor(qreal scale) const;
+
+    /**
+     * paint the part of the image in exposed, in image coordinates.
+     * If wait is true the missing tiles are loaded before painting, otherwise they're
+     * queued and tilesLoaded is emitted when they're ready.
+     */
+    void paint(QPainter* painter, const QRectF& exposed, bool wait = false);
+
+    /**
+     * paint the whole image at full size, for printing and exporting.
+     */
+    void paintFull(QPainter* painter);
+
+signals:
+    void tilesLoaded();
+
+private:
+    void reset(QSharedPointer<Source> source, const QSize& size);
+
+    /**
+     * the rect the tile covers in image coordinates.
+     */
+    QRectF tileRect(int level, int x, int y) const;
+    bool drawTile(QPainter* painter, int level, int x, int y, const QRectF& target);
+
+    void loadTiles(int level, const QRect& tiles, bool wait);
+    void tilesReady(int level, const QRect& tiles, const QVector<QImage>& images, bool notify = true);
+
+    quint32 mId;
+    QSharedPointer<Source> mSource;
+    QSize mSize;
+    int mLevelCount;
+
+    QPixmap mThumbnail;
+    // tile keys that are queued on the thread pool.
+    QSet<quint64> mPending;
+    // the KB this image holds back from the TileCache.
+    int mReserved;
+};
+
+/**
+ * The tiles of all the TiledImages, the least recently used tiles are dropped once they
+ * use more than maxCost KB, less what's reserved for whole images.
+ */
+class TileCache : public QObject
+{
+    Q_OBJECT
+    friend class TiledImage;
+    friend class TileLoader;
+
+public:
+    static TileCache* inst();
+
+    int
+    maxCost() const
+    {
+        return mMaxCost;
+    }
+    void setMaxCost(int kb);
+
+    /**
+     * the KB held by images decoded in full, which the tiles can't use.
+     */
+    int
+    reservedCost() const
+    {
+        return mReserved;
+    }
+
+    int
+    totalCost() const
+    {
+        return mTiles.totalCost();
+    }
+    int
+    count() const
+    {
+        return mTiles.count();
+    }
+
+    static quint64 key(quint32 id, int level, int x, int y);
+
+private slots:
+    void deliver();
+
+private:
+    TileCache();
+
+    quint32 add(TiledImage* image);
+    void remove(quint32 id);
+    void reserve(int kb);
+
+    QPixmap* tile(quint64 key);
+    void insert(quint64 key, const QImage& image);
+
+    /**
+     * queue tiles from the thread pool to be handed to their image on the gui thread.
+     */
+    void post(quint32 id, int level, const QRect& tiles, const QVector<QImage>& images);
+
+    struct Result
+    {
+        quint32 id;
+        int level;
+        QRect tiles;
+        QVector<QImage> images;
+    };
+
+    static TileCache* sInstance;
+
+    QCache<quint64, QPixmap> mTiles;
+    int mMaxCost;
+    int mReserved;
+    QHash<quint32, TiledImage*> mImages;
+    quint32 mNextId;
+
+    QMutex mMutex;
+    QList<Result> mResults;
+};
+
+#endif  // TILEDIMAGE_H
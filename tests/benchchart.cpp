@@ -0,0 +1,484 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "benchchart.h"
+
+#include <QApplication>
+#include <QBuffer>
+#include <QClipboard>
+#include <QFile>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QTabWidget>
+
+#include "../src/chartLayer.h"
+#include "../src/crochettab.h"
+#include "../src/filefactory.h"
+#include "../src/indicator.h"
+#include "../src/mainwindow.h"
+#include "../src/repeatfinder.h"
+#include "../src/scene.h"
+#include "../src/settings.h"
+#include "../src/snaplattice.h"
+#include "../src/stitchlibrary.h"
+#include "../src/svgsymbolwriter.h"
+#include "../src/textview.h"
+
+void BenchChart::initTestCase()
+{
+    StitchLibrary::inst()->loadStitchSets();
+    mMainWindow = new MainWindow();
+    mFileName = "crochetcharts-bench.pattern";
+}
+
+void BenchChart::cleanup()
+{
+    removeCharts();
+    QFile::remove(mFileName);
+}
+
+void BenchChart::cleanupTestCase()
+{
+    delete mMainWindow;
+    mMainWindow = 0;
+}
+
+void BenchChart::charts_data()
+{
+    QTest::addColumn<QString>("style");
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("columns");
+    QTest::addColumn<int>("layers");
+
+    QTest::newRow("rows 100x100") << "rows" << 100 << 100 << 1;
+    QTest::newRow("rows 300x300") << "rows" << 300 << 300 << 1;
+    QTest::newRow("rounds 60") << "rounds" << 60 << 12 << 1;
+    QTest::newRow("mixed 3x60x60") << "mixed" << 60 << 60 << 3;
+}
+
+CrochetTab* BenchChart::createChart()
+{
+    QFETCH(QString, style);
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+    QFETCH(int, layers);
+
+    Scene::ChartStyle chartStyle = style == "rounds" ? Scene::Rounds : Scene::Rows;
+    CrochetTab* tab = mMainWindow->createTab(chartStyle);
+    mMainWindow->tabWidget()->addTab(tab, style);
+    mMainWindow->tabWidget()->setCurrentWidget(tab);
+    Scene* scene = tab->scene();
+
+    if (style == "rounds")
+    {
+        tab->createChart(Scene::Rounds, rows, columns, "ch", QSizeF(32, 96), columns);
+        return tab;
+    }
+
+    for (int l = 0; l < layers; ++l)
+    {
+        if (l > 0)
+        {
+            ChartLayer* layer = new ChartLayer(QString("Layer %1").arg(l + 1));
+            scene->addLayer(layer);
+            scene->selectLayer(layer->uid());
+        }
+        tab->createChart(Scene::Rows, rows, columns, l % 2 ? "sc" : "ch", QSizeF(32, 96), 0);
+    }
+
+    if (style == "mixed")
+    {
+        // an indicator at the start of every row and the first row grouped in eights.
+        for (int r = 0; r < rows; ++r)
+        {
+            Indicator* i = new Indicator();
+            scene->addItem(i);
+            i->setPos(-64, r * 96);
+        }
+
+        for (int c = 0; c + 8 <= scene->columnCount(0); c += 8)
+        {
+            QList<QGraphicsItem*> group;
+            for (int i = c; i < c + 8; ++i)
+                group.append(scene->cell(0, i));
+            scene->setSelection(group);
+            scene->group();
+        }
+        scene->setSelection(QList<QGraphicsItem*>());
+    }
+
+    scene->undoStack()->clear();
+    return tab;
+}
+
+void BenchChart::removeCharts()
+{
+    QTabWidget* tabs = mMainWindow->tabWidget();
+    while (tabs->count() > 0)
+    {
+        QWidget* tab = tabs->widget(0);
+        tabs->removeTab(0);
+        delete tab;
+    }
+}
+
+QList<QGraphicsItem*> BenchChart::topLevelItems(CrochetTab* tab)
+{
+    QList<QGraphicsItem*> items;
+    foreach (QGraphicsItem* item, tab->scene()->items())
+    {
+        if (!item->parentItem() && (item->flags() & QGraphicsItem::ItemIsSelectable))
+            items.append(item);
+    }
+    return items;
+}
+
+void BenchChart::selectAll(CrochetTab* tab)
+{
+    tab->scene()->setSelection(topLevelItems(tab));
+}
+
+void BenchChart::load()
+{
+    createChart();
+    FileFactory saver(mMainWindow);
+    saver.fileName = mFileName;
+    QCOMPARE(saver.save(), FileFactory::No_Error);
+    removeCharts();
+
+    // removing the loaded chart is part of each iteration.
+    QBENCHMARK
+    {
+        FileFactory loader(mMainWindow);
+        loader.fileName = mFileName;
+        QCOMPARE(loader.load(), FileFactory::No_Error);
+        removeCharts();
+    }
+}
+
+void BenchChart::load_data()
+{
+    charts_data();
+}
+
+void BenchChart::save()
+{
+    createChart();
+
+    QBENCHMARK
+    {
+        FileFactory saver(mMainWindow);
+        saver.fileName = mFileName;
+        QCOMPARE(saver.save(), FileFactory::No_Error);
+    }
+}
+
+void BenchChart::save_data()
+{
+    charts_data();
+}
+
+void BenchChart::render()
+{
+    Scene* scene = createChart()->scene();
+    QRectF source = scene->itemsBoundingRect();
+
+    // the whole chart on a 2048px wide image.
+    QSize size = source.size().scaled(2048, 2048, Qt::KeepAspectRatio).toSize();
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK
+    {
+        image.fill(Qt::white);
+        QPainter p(&image);
+        scene->render(&p, QRectF(image.rect()), source);
+    }
+}
+
+void BenchChart::render_data()
+{
+    charts_data();
+}
+
+void BenchChart::paste()
+{
+    CrochetTab* tab = createChart();
+    selectAll(tab);
+    tab->scene()->copy();
+
+    QBENCHMARK_ONCE
+    {
+        tab->scene()->paste();
+    }
+}
+
+void BenchChart::paste_data()
+{
+    charts_data();
+}
+
+void BenchChart::deleteItems()
+{
+    CrochetTab* tab = createChart();
+    selectAll(tab);
+
+    QBENCHMARK_ONCE
+    {
+        tab->scene()->deleteSelection();
+    }
+}
+
+void BenchChart::deleteItems_data()
+{
+    charts_data();
+}
+
+void BenchChart::undo()
+{
+    CrochetTab* tab = createChart();
+    selectAll(tab);
+    tab->scene()->deleteSelection();
+
+    QBENCHMARK_ONCE
+    {
+        tab->scene()->undoStack()->undo();
+    }
+}
+
+void BenchChart::undo_data()
+{
+    charts_data();
+}
+
+void BenchChart::copyInstructions()
+{
+    Scene* scene = createChart()->scene();
+    TextView view(0, scene);
+
+    // from the cells each time, not the text of the last run.
+    QBENCHMARK
+    {
+        view.clearCache();
+        view.copyInstructions();
+    }
+}
+
+void BenchChart::copyInstructions_data()
+{
+    charts_data();
+}
+
+void BenchChart::toggleLayers()
+{
+    Scene* scene = createChart()->scene();
+    QList<ChartLayer*> layers = scene->layers();
+
+    QBENCHMARK
+    {
+        foreach (ChartLayer* layer, layers)
+        {
+            layer->setVisible(!layer->visible());
+            scene->editedLayer(layer);
+        }
+    }
+}
+
+void BenchChart::toggleLayers_data()
+{
+    charts_data();
+}
+
+void BenchChart::setSelected()
+{
+    CrochetTab* tab = createChart();
+    Scene* scene = tab->scene();
+    QList<QGraphicsItem*> items = topLevelItems(tab);
+
+    // the way items were selected before Scene::setSelection, to compare it with.
+    QBENCHMARK
+    {
+        scene->blockSignals(true);
+        scene->clearSelection();
+        foreach (QGraphicsItem* item, items)
+            item->setSelected(true);
+        scene->blockSignals(false);
+        emit scene->selectionChanged();
+    }
+}
+
+void BenchChart::setSelected_data()
+{
+    charts_data();
+    QTest::newRow("rows 100x1000") << "rows" << 100 << 1000 << 1;
+}
+
+void BenchChart::setSelection()
+{
+    CrochetTab* tab = createChart();
+    Scene* scene = tab->scene();
+    QList<QGraphicsItem*> items = topLevelItems(tab);
+
+    QBENCHMARK
+    {
+        scene->setSelection(QList<QGraphicsItem*>());
+        scene->setSelection(items);
+    }
+}
+
+void BenchChart::setSelection_data()
+{
+    charts_data();
+    QTest::newRow("rows 100x1000") << "rows" << 100 << 1000 << 1;
+}
+
+void BenchChart::distribute()
+{
+    CrochetTab* tab = createChart();
+    Scene* scene = tab->scene();
+    scene->setSelection(topLevelItems(tab));
+
+    QBENCHMARK
+    {
+        scene->distribute(2, 2);
+    }
+}
+
+void BenchChart::distribute_data()
+{
+    charts_data();
+}
+
+void BenchChart::createRounds()
+{
+    QFETCH(int, rows);
+    QFETCH(int, increaseBy);
+
+    QBENCHMARK
+    {
+        Scene scene;
+        scene.createRoundsChart(rows, 12, "ch", QSizeF(32, 96), increaseBy);
+    }
+}
+
+void BenchChart::createRounds_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("increaseBy");
+
+    // about 60,000 and 540,000 cells.
+    QTest::newRow("rounds 100") << 100 << 12;
+    QTest::newRow("rounds 300") << 300 << 12;
+}
+
+void BenchChart::exportSvg()
+{
+    Scene* scene = createChart()->scene();
+    QList<QGraphicsItem*> items = scene->items(Qt::AscendingOrder);
+    QRectF rect = scene->itemsBoundingRect();
+
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        SvgSymbolWriter writer;
+        writer.write(&buffer, items, rect);
+    }
+}
+
+void BenchChart::exportSvg_data()
+{
+    charts_data();
+}
+
+void BenchChart::paintSvg()
+{
+    Scene* scene = createChart()->scene();
+    QRectF rect = scene->itemsBoundingRect();
+
+    // the svg export before SvgSymbolWriter, to compare it with.
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QSvgGenerator gen;
+        gen.setOutputDevice(&buffer);
+        gen.setSize(rect.size().toSize());
+        gen.setViewBox(rect);
+
+        QPainter p;
+        p.begin(&gen);
+        scene->render(&p, rect, rect);
+        p.end();
+    }
+}
+
+void BenchChart::paintSvg_data()
+{
+    charts_data();
+}
+
+void BenchChart::findRepeats()
+{
+    // 1000 rows of 400 stitches made of a short repeat with the odd stitch changed.
+    qsrand(1);
+    QList<QVector<int> > chart;
+    QVector<int> rowCodes;
+    for (int r = 0; r < 1000; ++r)
+    {
+        QVector<int> unit(2 + qrand() % 7);
+        for (int i = 0; i < unit.count(); ++i)
+            unit[i] = qrand() % 6;
+
+        QVector<int> row(400);
+        for (int i = 0; i < row.count(); ++i)
+            row[i] = (qrand() % 50 == 0) ? 6 : unit[i % unit.count()];
+
+        chart.append(row);
+        // every other block of four rows repeats the block before it.
+        rowCodes.append(r % 8 >= 4 ? rowCodes.value(r - 4) : r);
+    }
+
+    int groups = 0;
+    int rowRuns = 0;
+    QBENCHMARK
+    {
+        groups = 0;
+        foreach (const QVector<int>& row, chart)
+            groups += RepeatFinder::group(row).count();
+        rowRuns = RepeatFinder::selectRuns(RepeatFinder(rowCodes).runs()).count();
+    }
+
+    QVERIFY(groups < chart.count() * 400);
+    QVERIFY(rowRuns > 0);
+}
+
+void BenchChart::snapRounds()
+{
+    SnapLattice lattice(SnapLattice::Rounds, 100, 64, 32, 32, QPointF(0, 0));
+    QVector<QPointF> points;
+    for (int i = 0; i < 100000; ++i)
+        points.append(QPointF((i * 37) % 4000 - 2000, (i * 53) % 4000 - 2000));
+
+    QBENCHMARK
+    {
+        QVector<QPointF> snapped = points;
+        lattice.snap(snapped);
+    }
+}
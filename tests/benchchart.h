@@ -0,0 +1,104 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef BENCHCHART_H
+#define BENCHCHART_H
+
+#include <QtTest/QTest>
+#include <QDebug>
+#include <QObject>
+
+class CrochetTab;
+class QGraphicsItem;
+class MainWindow;
+
+/**
+ * Benchmarks of whole charts, run by crochetcharts-bench.
+ *
+ * Most benchmarks take the same charts from charts_data(): a grid of rows, a round chart
+ * and a chart with several layers, groups and indicators. The chart is built before the
+ * benchmark starts and removed when it ends. createRounds measures building a chart.
+ * findRepeats and snapRounds time the repeat search and the snapping to a round grid on
+ * large made up input instead of a chart.
+ */
+class BenchChart : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanup();
+    void cleanupTestCase();
+
+    void load();
+    void load_data();
+    void save();
+    void save_data();
+    void render();
+    void render_data();
+    void paste();
+    void paste_data();
+    void deleteItems();
+    void deleteItems_data();
+    void undo();
+    void undo_data();
+    void copyInstructions();
+    void copyInstructions_data();
+    void toggleLayers();
+    void toggleLayers_data();
+    void setSelected();
+    void setSelected_data();
+    void setSelection();
+    void setSelection_data();
+    void distribute();
+    void distribute_data();
+    void createRounds();
+    void createRounds_data();
+    void exportSvg();
+    void exportSvg_data();
+    void paintSvg();
+    void paintSvg_data();
+    void findRepeats();
+    void snapRounds();
+
+private:
+    void charts_data();
+
+    /**
+     * a new chart, current in the main window, built from the current data row.
+     */
+    CrochetTab* createChart();
+
+    void removeCharts();
+
+    /**
+     * every top level item of the chart that can be selected.
+     */
+    QList<QGraphicsItem*> topLevelItems(CrochetTab* tab);
+
+    /**
+     * select every top level item of the current chart.
+     */
+    void selectAll(CrochetTab* tab);
+
+    MainWindow* mMainWindow;
+    QString mFileName;
+};
+
+#endif // BENCHCHART_H
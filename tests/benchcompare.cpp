@@ -0,0 +1,188 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "benchcompare.h"
+
+#include <QTextStream>
+
+#include <algorithm>
+
+// the tolerance of metrics that don't have one of their own.
+#define BENCH_DEFAULT_TOLERANCE 0.10
+// MAD * 1.4826 estimates the standard deviation of normally distributed runs.
+#define BENCH_MAD_SCALE 1.4826
+
+BenchCompare::BenchCompare(const BenchResults& baseline)
+    : mBaseline(baseline)
+{
+    // wall time and ticks move with whatever else the machine is doing, callgrind counts
+    // instructions and only moves when the code does.
+    mTolerances.insert("WalltimeMilliseconds", 0.10);
+    mTolerances.insert("CPUTicks", 0.10);
+    mTolerances.insert("InstructionReads", 0.02);
+    mTolerances.insert("Events", 0.05);
+}
+
+void
+BenchCompare::setTolerance(const QString& key, qreal tolerance)
+{
+    mTolerances.insert(key, tolerance);
+}
+
+qreal
+BenchCompare::tolerance(const QString& function, const QString& tag, const QString& metric) const
+{
+    QString name = tag.isEmpty() ? function : function + ":" + tag;
+    if (mTolerances.contains(name))
+        return mTolerances.value(name);
+    if (mTolerances.contains(function))
+        return mTolerances.value(function);
+    return mTolerances.value(metric, BENCH_DEFAULT_TOLERANCE);
+}
+
+qreal
+BenchCompare::median(QVector<qreal> values)
+{
+    if (values.isEmpty())
+        return 0;
+
+    std::sort(values.begin(), values.end());
+    int mid = values.count() / 2;
+    if (values.count() % 2)
+        return values.at(mid);
+    return (values.at(mid - 1) + values.at(mid)) / 2;
+}
+
+qreal
+BenchCompare::mad(const QVector<qreal>& values)
+{
+    qreal m = median(values);
+    QVector<qreal> deviations;
+    deviations.reserve(values.count());
+    foreach (qreal v, values)
+        deviations.append(qAbs(v - m));
+    return median(deviations);
+}
+
+QList<BenchCompare::Comparison>
+BenchCompare::compare(const BenchResults& current) const
+{
+    QList<Comparison> comparisons;
+    foreach (const BenchResults::Result& r, current.results())
+    {
+        Comparison c;
+        c.name = r.name();
+        c.metric = r.metric;
+        c.current = median(r.values);
+        c.baseline = 0;
+        c.threshold = 0;
+        c.verdict = New;
+
+        const BenchResults::Result* base = mBaseline.find(c.name, r.metric);
+        if (base)
+        {
+            c.baseline = median(base->values);
+            qreal noise = BENCH_MAD_SCALE * qMax(mad(base->values), mad(r.values));
+            c.threshold = qMax(tolerance(r.function, r.tag, r.metric) * c.baseline, 3 * noise);
+
+            if (c.current - c.baseline > c.threshold)
+                c.verdict = Slower;
+            else if (c.baseline - c.current > c.threshold)
+                c.verdict = Faster;
+            else
+                c.verdict = Unchanged;
+        }
+
+        comparisons.append(c);
+    }
+
+    return comparisons;
+}
+
+QStringList
+BenchCompare::slower(const QList<Comparison>& comparisons)
+{
+    QStringList names;
+    foreach (const Comparison& c, comparisons)
+    {
+        if (c.verdict == Slower && !names.contains(c.name))
+            names.append(c.name);
+    }
+    return names;
+}
+
+QString
+BenchCompare::report(const QList<Comparison>& comparisons)
+{
+    int nameWidth = 9;
+    int metricWidth = 6;
+    foreach (const Comparison& c, comparisons)
+    {
+        nameWidth = qMax(nameWidth, c.name.length());
+        metricWidth = qMax(metricWidth, c.metric.length());
+    }
+
+    QString text;
+    QTextStream out(&text);
+    out << QString("benchmark").leftJustified(nameWidth) << "  "
+        << QString("metric").leftJustified(metricWidth) << "  "
+        << QString("baseline").rightJustified(12) << "  " << QString("current").rightJustified(12)
+        << "  " << QString("change").rightJustified(8) << "\n";
+
+    int slowerCount = 0;
+    int fasterCount = 0;
+    foreach (const Comparison& c, comparisons)
+    {
+        QString change;
+        QString verdict;
+        if (c.verdict == New)
+        {
+            verdict = "new";
+        }
+        else
+        {
+            if (c.baseline > 0)
+                change = QString("%1%2%").arg(c.current >= c.baseline ? "+" : "")
+                             .arg((c.current / c.baseline - 1) * 100, 0, 'f', 1);
+            if (c.verdict == Slower)
+            {
+                verdict = "SLOWER";
+                slowerCount++;
+            }
+            else if (c.verdict == Faster)
+            {
+                verdict = "faster";
+                fasterCount++;
+            }
+        }
+
+        out << c.name.leftJustified(nameWidth) << "  " << c.metric.leftJustified(metricWidth)
+            << "  "
+            << (c.verdict == New ? QString("-") : QString::number(c.baseline, 'g', 6)).rightJustified(12)
+            << "  " << QString::number(c.current, 'g', 6).rightJustified(12) << "  "
+            << change.rightJustified(8) << "  " << verdict << "\n";
+    }
+
+    out << "\n"
+        << slowerCount << " of " << comparisons.count() << " benchmarks are slower and "
+        << fasterCount << " are faster than the baseline.\n";
+
+    return text;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef BENCHCOMPARE_H
+#define BENCHCOMPARE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "benchresults.h"
+
+/**
+ * Compares benchmark results against a baseline.
+ *
+ * Each side is summarised by the median of its runs and the median absolute deviation (MAD)
+ * of them. A result is only slower or faster when the medians differ by more than both the
+ * tolerance for the result and three times the noise of the noisier side, so a single
+ * noisy run doesn't count as a regression.
+ */
+class BenchCompare
+{
+public:
+    enum Verdict
+    {
+        Unchanged,
+        Faster,
+        Slower,
+        // not in the baseline.
+        New
+    };
+
+    struct Comparison
+    {
+        QString name;
+        QString metric;
+        qreal baseline;
+        qreal current;
+        // the difference either side has to exceed to count.
+        qreal threshold;
+        Verdict verdict;
+    };
+
+    explicit BenchCompare(const BenchResults& baseline);
+
+    /**
+     * set the tolerance, a fraction of the baseline, of a metric, a benchmark function
+     * or one data row as function:tag. The most specific one is used.
+     */
+    void setTolerance(const QString& key, qreal tolerance);
+    qreal tolerance(const QString& function, const QString& tag, const QString& metric) const;
+
+    QList<Comparison> compare(const BenchResults& current) const;
+
+    /**
+     * the function:tag names of the slower results, to run them again.
+     */
+    static QStringList slower(const QList<Comparison>& comparisons);
+
+    /**
+     * a table of the comparisons followed by a summary.
+     */
+    static QString report(const QList<Comparison>& comparisons);
+
+    static qreal median(QVector<qreal> values);
+    static qreal mad(const QVector<qreal>& values);
+
+private:
+    const BenchResults& mBaseline;
+    QHash<QString, qreal> mTolerances;
+};
+
+#endif // BENCHCOMPARE_H
@@ -0,0 +1,192 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+/**
+ * crochetcharts-bench runs the BenchChart benchmarks and writes what they measured.
+ *
+ *   crochetcharts-bench [--runs n] [--json file] [--csv file]
+ *                       [--compare baseline.json] [--tolerance key=percent] [--reruns n]
+ *                       [QtTest options and functions]
+ *
+ * --runs runs every benchmark n times, --json and --csv write the results of all the runs.
+ * Everything else is passed to QtTest, so "crochetcharts-bench render:rounds\ 60" runs one
+ * benchmark and -tickcounter or -callgrind change what's measured.
+ *
+ * --compare compares the results with a file written by --json and exits with 1 if any
+ * benchmark is slower. The slower benchmarks are run --reruns more times (2 by default)
+ * before they're reported, so a slow run has to be slow again to count. The reruns only count
+ * in the comparison, --json and --csv leave them out. --tolerance sets the
+ * tolerance of a metric, a benchmark or a data row, e.g. --tolerance render=15 or
+ * --tolerance "load:rounds 60=20", see BenchCompare.
+ */
+#include <QApplication>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "benchchart.h"
+#include "benchcompare.h"
+#include "benchresults.h"
+
+/**
+ * run the benchmarks once and add what they measured to results.
+ */
+static int
+runBenchmarks(BenchChart* bench, QStringList args, BenchResults* results)
+{
+    QTemporaryFile log;
+    if (!log.open())
+        return 1;
+    log.close();
+
+    // the xml log is read back for the results, the text log is for whoever's watching.
+    args << "-o" << log.fileName() + ",xml" << "-o" << "-,txt";
+    int retval = QTest::qExec(bench, args);
+    results->readTestLog(log.fileName());
+    return retval;
+}
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv);
+
+    // the QtTest options that are followed by a value.
+    QStringList valueOptions;
+    valueOptions << "-o" << "-maxwarnings" << "-eventdelay" << "-keydelay" << "-mousedelay"
+                 << "-iterations" << "-median" << "-minimumvalue" << "-minimumtotal" << "-seed";
+
+    QStringList args = app.arguments();
+    QStringList testArgs;
+    testArgs << args.first();
+    // testArgs without the functions, to run other functions with the same options.
+    QStringList testOptions = testArgs;
+
+    QString jsonFile;
+    QString csvFile;
+    QString baselineFile;
+    QList<QPair<QString, qreal> > tolerances;
+    int runs = 1;
+    int reruns = 2;
+    for (int i = 1; i < args.count(); ++i)
+    {
+        const QString& arg = args.at(i);
+        bool hasValue = i + 1 < args.count();
+
+        if (arg == "--json" && hasValue)
+        {
+            jsonFile = args.at(++i);
+        }
+        else if (arg == "--csv" && hasValue)
+        {
+            csvFile = args.at(++i);
+        }
+        else if (arg == "--runs" && hasValue)
+        {
+            runs = qMax(1, args.at(++i).toInt());
+        }
+        else if (arg == "--compare" && hasValue)
+        {
+            baselineFile = args.at(++i);
+        }
+        else if (arg == "--reruns" && hasValue)
+        {
+            reruns = qMax(0, args.at(++i).toInt());
+        }
+        else if (arg == "--tolerance" && hasValue)
+        {
+            QString value = args.at(++i);
+            int split = value.lastIndexOf('=');
+            bool ok = false;
+            qreal percent = value.mid(split + 1).toDouble(&ok);
+            if (split <= 0 || !ok)
+            {
+                qWarning() << "Invalid tolerance" << value << "expected key=percent";
+                return 1;
+            }
+            tolerances.append(qMakePair(value.left(split), percent / 100));
+        }
+        else
+        {
+            testArgs << arg;
+            if (arg.startsWith('-'))
+            {
+                testOptions << arg;
+                if (valueOptions.contains(arg) && hasValue)
+                {
+                    testArgs << args.at(++i);
+                    testOptions << args.at(i);
+                }
+            }
+        }
+    }
+
+    BenchResults baseline;
+    if (!baselineFile.isEmpty() && !baseline.loadJson(baselineFile))
+    {
+        qWarning() << "Couldn't read the baseline" << baselineFile;
+        return 1;
+    }
+
+    BenchChart bench;
+    BenchResults results;
+    int retval(0);
+
+    for (int run = 0; run < runs; ++run)
+        retval += runBenchmarks(&bench, testArgs, &results);
+
+    bool regression = false;
+    if (!baselineFile.isEmpty())
+    {
+        BenchCompare compare(baseline);
+        for (int i = 0; i < tolerances.count(); ++i)
+            compare.setTolerance(tolerances.at(i).first, tolerances.at(i).second);
+
+        // the reruns are only for the comparison, the saved results keep the runs that were
+        // asked for so they can be used as a baseline.
+        BenchResults compared = results;
+        QList<BenchCompare::Comparison> comparisons = compare.compare(compared);
+        for (int rerun = 0; rerun < reruns; ++rerun)
+        {
+            QStringList suspects = BenchCompare::slower(comparisons);
+            if (suspects.isEmpty())
+                break;
+
+            // the new runs are added to the old ones, so one slow run is outvoted by the median.
+            retval += runBenchmarks(&bench, testOptions + suspects, &compared);
+            comparisons = compare.compare(compared);
+        }
+
+        QTextStream(stdout) << "\nCompared with " << baselineFile << ":\n\n"
+                            << BenchCompare::report(comparisons);
+        regression = !BenchCompare::slower(comparisons).isEmpty();
+    }
+
+    if (!jsonFile.isEmpty() && !results.saveJson(jsonFile))
+    {
+        qWarning() << "Couldn't write" << jsonFile;
+        retval++;
+    }
+    if (!csvFile.isEmpty() && !results.saveCsv(csvFile))
+    {
+        qWarning() << "Couldn't write" << csvFile;
+        retval++;
+    }
+
+    return (retval || regression ? 1 : 0);
+}
@@ -0,0 +1,186 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "benchresults.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QXmlStreamReader>
+
+static QString
+indexKey(const QString& name, const QString& metric)
+{
+    return name + QLatin1Char('\n') + metric;
+}
+
+/**
+ * quote a csv field if it needs it.
+ */
+static QString
+csvField(QString field)
+{
+    if (!field.contains(QLatin1Char(',')) && !field.contains(QLatin1Char('"')))
+        return field;
+    return "\"" + field.replace("\"", "\"\"") + "\"";
+}
+
+void
+BenchResults::add(const QString& function,
+                  const QString& tag,
+                  const QString& metric,
+                  int iterations,
+                  qreal value)
+{
+    Result r;
+    r.function = function;
+    r.tag = tag;
+    r.metric = metric;
+
+    QString key = indexKey(r.name(), metric);
+    int index = mIndex.value(key, -1);
+    if (index < 0)
+    {
+        r.iterations = iterations;
+        index = mResults.count();
+        mResults.append(r);
+        mIndex.insert(key, index);
+    }
+
+    mResults[index].values.append(value);
+}
+
+const BenchResults::Result*
+BenchResults::find(const QString& name, const QString& metric) const
+{
+    int index = mIndex.value(indexKey(name, metric), -1);
+    return index < 0 ? 0 : &mResults.at(index);
+}
+
+bool
+BenchResults::readTestLog(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QXmlStreamReader xml(&file);
+    QString function;
+    while (!xml.atEnd())
+    {
+        xml.readNext();
+        if (!xml.isStartElement())
+            continue;
+
+        if (xml.name() == "TestFunction")
+        {
+            function = xml.attributes().value("name").toString();
+        }
+        else if (xml.name() == "BenchmarkResult")
+        {
+            // the xml logger writes the value of one iteration.
+            QXmlStreamAttributes attrs = xml.attributes();
+            add(function, attrs.value("tag").toString(), attrs.value("metric").toString(),
+                attrs.value("iterations").toInt(), attrs.value("value").toDouble());
+        }
+    }
+
+    return !xml.hasError();
+}
+
+bool
+BenchResults::loadJson(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject())
+        return false;
+
+    foreach (const QJsonValue& v, doc.object().value("results").toArray())
+    {
+        QJsonObject o = v.toObject();
+        foreach (const QJsonValue& value, o.value("values").toArray())
+        {
+            add(o.value("function").toString(), o.value("tag").toString(),
+                o.value("metric").toString(), o.value("iterations").toInt(), value.toDouble());
+        }
+    }
+
+    return true;
+}
+
+bool
+BenchResults::saveJson(const QString& fileName) const
+{
+    QJsonArray results;
+    foreach (const Result& r, mResults)
+    {
+        QJsonArray values;
+        foreach (qreal v, r.values)
+            values.append(v);
+
+        QJsonObject o;
+        o.insert("function", r.function);
+        o.insert("tag", r.tag);
+        o.insert("metric", r.metric);
+        o.insert("iterations", r.iterations);
+        o.insert("values", values);
+        results.append(o);
+    }
+
+    QJsonObject root;
+    root.insert("version", 1);
+    root.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("qt", QString(qVersion()));
+    root.insert("results", results);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+bool
+BenchResults::saveCsv(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "function,tag,metric,iterations,run,value\n";
+    foreach (const Result& r, mResults)
+    {
+        for (int run = 0; run < r.values.count(); ++run)
+        {
+            out << csvField(r.function) << ',' << csvField(r.tag) << ',' << csvField(r.metric)
+                << ',' << r.iterations << ',' << run << ',' << QString::number(r.values.at(run), 'g', 12)
+                << '\n';
+        }
+    }
+    return true;
+}
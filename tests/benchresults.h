@@ -0,0 +1,93 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef BENCHRESULTS_H
+#define BENCHRESULTS_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * The benchmark results of one or more runs of crochetcharts-bench.
+ *
+ * Each result is one benchmark, one data row and one metric, with the value of every run.
+ * Values are per iteration, in the unit of the metric: milliseconds for the default walltime
+ * measurements.
+ */
+class BenchResults
+{
+public:
+    struct Result
+    {
+        QString function;
+        QString tag;
+        QString metric;
+        int iterations;
+        QVector<qreal> values;
+
+        /**
+         * function:tag, the name QtTest takes on the command line to run just this result.
+         */
+        QString
+        name() const
+        {
+            return tag.isEmpty() ? function : function + ":" + tag;
+        }
+    };
+
+    /**
+     * add the benchmarks in a log written by QtTest's xml logger as one more run.
+     */
+    bool readTestLog(const QString& fileName);
+
+    bool loadJson(const QString& fileName);
+    bool saveJson(const QString& fileName) const;
+
+    /**
+     * one line for every run of every result.
+     */
+    bool saveCsv(const QString& fileName) const;
+
+    const QList<Result>&
+    results() const
+    {
+        return mResults;
+    }
+
+    /**
+     * the result with name and metric, or 0.
+     */
+    const Result* find(const QString& name, const QString& metric) const;
+
+    void add(const QString& function,
+             const QString& tag,
+             const QString& metric,
+             int iterations,
+             qreal value);
+
+private:
+    QList<Result> mResults;
+    // name + metric -> index in mResults.
+    QHash<QString, int> mIndex;
+};
+
+#endif // BENCHRESULTS_H
@@ -24,6 +24,16 @@
 #include "testcell.h"
 #include "testtextview.h"
 #include "teststitchlibrary.h"
+#include "testfile_v2.h"
+#include "testsvgsymbolwriter.h"
+#include "testcharttiler.h"
+#include "testrowsmodel.h"
+#include "testchartmimedata.h"
+#include "testscene.h"
+#include "testtiledimage.h"
+#include "testsnaplattice.h"
+#include "testchartexportjob.h"
+#include "testbenchcompare.h"
 
 int main(int argc, char** argv) 
 {
@@ -64,6 +74,56 @@ int main(int argc, char** argv)
     retval +=QTest::qExec(test, argc, argv);
     delete test;
     test = 0;
+
+    test = new TestFile_v2();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestSvgSymbolWriter();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestChartTiler();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestRowsModel();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestChartMimeData();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestScene();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestTiledImage();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestSnapLattice();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestChartExportJob();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
+
+    test = new TestBenchCompare();
+    retval +=QTest::qExec(test, argc, argv);
+    delete test;
+    test = 0;
     
     return (retval ? 1 : 0);
 }
@@ -0,0 +1,97 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testbenchcompare.h"
+
+#include "benchcompare.h"
+#include "benchresults.h"
+
+/**
+ * add one walltime result with a value for each run.
+ */
+static void addRuns(BenchResults *results, const QString &function, const QVector<qreal> &values)
+{
+    foreach(qreal v, values)
+        results->add(function, "rows", "WalltimeMilliseconds", 1, v);
+}
+
+void TestBenchCompare::median()
+{
+    QCOMPARE(BenchCompare::median(QVector<qreal>()), 0.0);
+    QCOMPARE(BenchCompare::median(QVector<qreal>() << 3 << 1 << 2), 2.0);
+    QCOMPARE(BenchCompare::median(QVector<qreal>() << 4 << 1 << 3 << 2), 2.5);
+}
+
+void TestBenchCompare::mad()
+{
+    QCOMPARE(BenchCompare::mad(QVector<qreal>() << 5 << 5 << 5), 0.0);
+
+    // one outlier doesn't move it.
+    QCOMPARE(BenchCompare::mad(QVector<qreal>() << 1 << 2 << 3 << 4 << 100), 1.0);
+}
+
+void TestBenchCompare::compare()
+{
+    BenchResults baseline;
+    addRuns(&baseline, "slower", QVector<qreal>() << 100 << 101 << 99);
+    addRuns(&baseline, "faster", QVector<qreal>() << 100 << 101 << 99);
+    addRuns(&baseline, "same", QVector<qreal>() << 100 << 101 << 99);
+    addRuns(&baseline, "noisy", QVector<qreal>() << 100 << 100 << 100);
+
+    BenchResults current;
+    addRuns(&current, "slower", QVector<qreal>() << 130 << 131 << 129);
+    addRuns(&current, "faster", QVector<qreal>() << 80 << 81 << 79);
+    addRuns(&current, "same", QVector<qreal>() << 105 << 104 << 106);
+    // 25% slower, but the runs are too far apart to tell.
+    addRuns(&current, "noisy", QVector<qreal>() << 100 << 150 << 125 << 100 << 150);
+    addRuns(&current, "new", QVector<qreal>() << 10);
+
+    QList<BenchCompare::Comparison> comparisons = BenchCompare(baseline).compare(current);
+    QCOMPARE(comparisons.count(), 5);
+
+    QCOMPARE(comparisons.at(0).name, QString("slower:rows"));
+    QCOMPARE(comparisons.at(0).verdict, BenchCompare::Slower);
+    QCOMPARE(comparisons.at(0).baseline, 100.0);
+    QCOMPARE(comparisons.at(0).current, 130.0);
+    QCOMPARE(comparisons.at(0).threshold, 10.0);
+
+    QCOMPARE(comparisons.at(1).verdict, BenchCompare::Faster);
+    QCOMPARE(comparisons.at(2).verdict, BenchCompare::Unchanged);
+    QCOMPARE(comparisons.at(3).verdict, BenchCompare::Unchanged);
+    QVERIFY(comparisons.at(3).threshold > 25);
+    QCOMPARE(comparisons.at(4).verdict, BenchCompare::New);
+
+    QCOMPARE(BenchCompare::slower(comparisons), QStringList() << "slower:rows");
+}
+
+void TestBenchCompare::tolerance()
+{
+    BenchResults baseline;
+    BenchCompare compare(baseline);
+    QCOMPARE(compare.tolerance("render", "rows", "WalltimeMilliseconds"), 0.10);
+    QCOMPARE(compare.tolerance("render", "rows", "InstructionReads"), 0.02);
+
+    // the most specific tolerance is used.
+    compare.setTolerance("render", 0.5);
+    compare.setTolerance("render:rows", 0.3);
+    QCOMPARE(compare.tolerance("render", "rows", "WalltimeMilliseconds"), 0.3);
+    QCOMPARE(compare.tolerance("render", "rounds", "WalltimeMilliseconds"), 0.5);
+    QCOMPARE(compare.tolerance("load", "rows", "WalltimeMilliseconds"), 0.10);
+}
@@ -0,0 +1,44 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testchartexportjob.h"
+
+#include <QFile>
+#include <QSignalSpy>
+
+#include "../src/chartexportjob.h"
+
+void TestChartExportJob::noPages()
+{
+    ChartExportJob job;
+    QCOMPARE(job.pageCount(), 0);
+
+    // a job without pages still finishes, whoever's waiting for it would wait forever.
+    QSignalSpy finished(&job, SIGNAL(finished(bool)));
+    job.renderPictures(QRect(0, 0, 100, 100));
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toBool(), true);
+
+    job.writeImage("testchartexportjob.png", QSize(100, 100), 96);
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(finished.count(), 2);
+    QVERIFY(!QFile::exists("testchartexportjob.png"));
+}
@@ -0,0 +1,139 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testchartmimedata.h"
+
+#include <QDataStream>
+
+#include "../src/cell.h"
+#include "../src/chartmimedata.h"
+#include "../src/ChartItemTools.h"
+#include "testutils.h"
+
+static QList<QGraphicsItem *> createCells()
+{
+    QList<QGraphicsItem *> items;
+    QList<Cell *> row = TestUtils::createRow(QStringList() << "sc" << "ch" << "sc" << "ch" << "sc" << "ch");
+    for (int i = 0; i < row.count(); ++i)
+    {
+        Cell *c = row.at(i);
+        c->setColor(i % 3 ? QColor(Qt::black) : QColor(Qt::red));
+        c->setBgColor(QColor(Qt::white));
+        c->setPos(i * 32, 10);
+        items.append(c);
+    }
+    return items;
+}
+
+void TestChartMimeData::dictionary()
+{
+    QList<QGraphicsItem *> items = createCells();
+    ChartMimeData data;
+    data.addItems(items);
+
+    QCOMPARE(data.topLevelCount(), 6);
+    QCOMPARE(data.records().count(), 6);
+
+    // each name and colour is only stored once.
+    QCOMPARE(data.string(data.records().at(0).key), QString("sc"));
+    QCOMPARE(data.string(data.records().at(1).key), QString("ch"));
+    QCOMPARE(data.records().at(2).key, data.records().at(0).key);
+    QCOMPARE(data.color(data.records().at(3).color), QColor(Qt::red));
+    QCOMPARE(data.records().at(4).color, data.records().at(1).color);
+    QCOMPARE(data.color(data.records().at(5).bgColor), QColor(Qt::white));
+
+    qDeleteAll(items);
+}
+
+void TestChartMimeData::transforms()
+{
+    QList<QGraphicsItem *> items = createCells();
+    ChartItemTools::setRotation(items.at(1), 45);
+    ChartItemTools::setRotationPivot(items.at(1), QPointF(16, 16), false);
+    ChartItemTools::setScaleX(items.at(2), 2);
+
+    ChartMimeData data;
+    data.addItems(items);
+
+    QCOMPARE(int(data.records().at(0).flags), 0);
+    QCOMPARE(int(data.records().at(1).flags), int(ChartMimeData::Rotated));
+    QCOMPARE(int(data.records().at(2).flags), int(ChartMimeData::Scaled));
+
+    int cursor = 0;
+    ChartMimeData::Transform t = data.transform(data.records().at(0), &cursor);
+    QCOMPARE(cursor, 0);
+    QCOMPARE(t.scaleX, 1.0);
+
+    t = data.transform(data.records().at(1), &cursor);
+    QCOMPARE(t.rotation, 45.0);
+    QCOMPARE(t.rotationPivot, QPointF(16, 16));
+
+    t = data.transform(data.records().at(2), &cursor);
+    QCOMPARE(t.rotation, 0.0);
+    QCOMPARE(t.scaleX, 2.0);
+    QCOMPARE(t.scaleY, 1.0);
+
+    qDeleteAll(items);
+}
+
+void TestChartMimeData::roundTrip()
+{
+    QList<QGraphicsItem *> items = createCells();
+    ChartItemTools::setRotation(items.at(3), 90);
+
+    ChartMimeData data;
+    data.addItems(items);
+    qDeleteAll(items);
+
+    QVERIFY(data.hasFormat(ChartMimeData::format));
+    QByteArray bytes = data.data(ChartMimeData::format);
+    QVERIFY(!bytes.isEmpty());
+
+    ChartMimeData copy;
+    QVERIFY(copy.decode(bytes));
+    QCOMPARE(copy.topLevelCount(), data.topLevelCount());
+    QCOMPARE(copy.records().count(), data.records().count());
+
+    int cursor = 0, copyCursor = 0;
+    for (int i = 0; i < data.records().count(); ++i)
+    {
+        const ChartMimeData::Record &a = data.records().at(i);
+        const ChartMimeData::Record &b = copy.records().at(i);
+        QCOMPARE(copy.string(b.key), data.string(a.key));
+        QCOMPARE(copy.color(b.color), data.color(a.color));
+        QCOMPARE(b.pos, a.pos);
+        QCOMPARE(data.transform(a, &cursor).rotation, copy.transform(b, &copyCursor).rotation);
+    }
+
+    // a truncated copy isn't read.
+    ChartMimeData broken;
+    QVERIFY(!broken.decode(bytes.left(bytes.count() - 4)));
+}
+
+void TestChartMimeData::oldFormat()
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << 1 << int(Cell::Type) << QString("ch");
+
+    ChartMimeData data;
+    QVERIFY(!data.decode(bytes));
+    QCOMPARE(data.records().count(), 0);
+}
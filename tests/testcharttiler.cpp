@@ -0,0 +1,106 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testcharttiler.h"
+
+#include <QGraphicsItem>
+#include <QSharedPointer>
+
+#include "../src/charttiler.h"
+#include "../src/chartsnapshot.h"
+
+// a resolution of 40 leaves a label 10 pixels high at the top of the page.
+static const int resolution = 40;
+
+static QSharedPointer<ChartSnapshot>
+emptyChart(const QSizeF& size)
+{
+    return QSharedPointer<ChartSnapshot>(
+        new ChartSnapshot(QList<QGraphicsItem*>(), QRectF(QPointF(-50, -50), size)));
+}
+
+void TestChartTiler::pageCount()
+{
+    QFETCH(QSizeF, chartSize);
+    QFETCH(qreal, scale);
+    QFETCH(int, overlap);
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+
+    ChartTiler tiler(emptyChart(chartSize), "Chart", QRect(0, 0, 200, 110), resolution, scale,
+                     overlap);
+
+    QCOMPARE(tiler.rows(), rows);
+    QCOMPARE(tiler.columns(), columns);
+    QCOMPARE(tiler.pageCount(), rows * columns);
+}
+
+void TestChartTiler::pageCount_data()
+{
+    QTest::addColumn<QSizeF>("chartSize");
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<int>("overlap");
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("columns");
+
+    QTest::newRow("fits") << QSizeF(150, 80) << 1.0 << 20 << 1 << 1;
+    QTest::newRow("exact") << QSizeF(200, 100) << 1.0 << 20 << 1 << 1;
+    QTest::newRow("no overlap") << QSizeF(1000, 500) << 1.0 << 0 << 5 << 5;
+    QTest::newRow("overlap") << QSizeF(1000, 500) << 1.0 << 20 << 6 << 6;
+    QTest::newRow("scaled") << QSizeF(1000, 500) << 0.5 << 0 << 3 << 3;
+    QTest::newRow("huge overlap") << QSizeF(300, 100) << 1.0 << 500 << 1 << 2;
+}
+
+void TestChartTiler::tileSource()
+{
+    ChartTiler tiler(emptyChart(QSizeF(1000, 500)), "Chart", QRect(0, 0, 200, 110), resolution,
+                     1.0, 20);
+
+    QCOMPARE(tiler.tileSource(0), QRectF(-50, -50, 200, 100));
+    // the second row and column start an overlap before the end of the first page.
+    QCOMPARE(tiler.tileSource(tiler.columns() + 1), QRectF(130, 30, 200, 100));
+
+    // the last page reaches the bottom right corner of the chart.
+    QRectF last = tiler.tileSource(tiler.pageCount() - 1);
+    QVERIFY(last.right() >= 950);
+    QVERIFY(last.bottom() >= 450);
+
+    QVERIFY(tiler.label(tiler.columns() + 1).contains("row 2 of 6, column 2 of 6"));
+}
+
+void TestChartTiler::scaleFor()
+{
+    // 10mm at 254 dpi is 100 pixels.
+    QCOMPARE(ChartTiler::scaleFor(254, 10, 64), 100.0 / 64);
+    QCOMPARE(ChartTiler::scaleFor(254, 10, 0), 1.0);
+}
+
+void TestChartTiler::picture()
+{
+    ChartTiler tiler(emptyChart(QSizeF(400, 200)), "Chart", QRect(0, 0, 200, 110), resolution,
+                     1.0, 20);
+
+    for (int i = 0; i < tiler.pageCount(); ++i)
+    {
+        QPicture picture = tiler.picture(i);
+        QVERIFY(!picture.isNull());
+        QCOMPARE(picture.boundingRect(), QRect(0, 0, 200, 110));
+    }
+}
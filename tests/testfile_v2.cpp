@@ -0,0 +1,311 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testfile_v2.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QTabWidget>
+#include <QXmlStreamWriter>
+
+#include "../src/appinfo.h"
+#include "../src/crochettab.h"
+#include "../src/file_v2.h"
+#include "../src/filefactory.h"
+#include "../src/mainwindow.h"
+#include "../src/settings.h"
+#include "../src/stitchlibrary.h"
+
+void TestFile_v2::initTestCase()
+{
+    StitchLibrary::inst()->loadStitchSets();
+}
+
+void TestFile_v2::toReal()
+{
+    QFETCH(QString, number);
+
+    QCOMPARE(File_v2::toReal(QStringRef(&number)), number.toDouble());
+}
+
+void TestFile_v2::toReal_data()
+{
+    QTest::addColumn<QString>("number");
+
+    QTest::newRow("zero") << "0";
+    QTest::newRow("negative zero") << "-0";
+    QTest::newRow("integer") << "1234";
+    QTest::newRow("negative") << "-96.5";
+    QTest::newRow("fraction") << "0.005";
+    QTest::newRow("precision") << QString::number(0.1 + 0.2, 'g', 15);
+    QTest::newRow("long") << "3.14159265358979323846";
+    QTest::newRow("exponent") << QString::number(1e-05);
+    QTest::newRow("large exponent") << QString::number(1.5e+20);
+    QTest::newRow("empty") << "";
+    QTest::newRow("invalid") << "abc";
+}
+
+void TestFile_v2::readMetadata()
+{
+    QString fileName = "testfile_v2-metadata.pattern";
+
+    PatternMetadata metadata;
+    PatternMetadata::Chart chart;
+    chart.name = "Chart";
+    chart.style = Scene::Blank;
+    chart.size = QSizeF(320.5, 128);
+    metadata.charts.append(chart);
+    metadata.stitches.insert("ch", 4);
+    metadata.stitches.insert("sc", 6);
+    metadata.colors.insert("#000000", 10);
+    metadata.preview = QImage(32, 16, QImage::Format_ARGB32);
+    metadata.preview.fill(Qt::red);
+
+    createPatternFile(fileName, 10, &metadata);
+
+    PatternMetadata read = FileFactory::readMetadata(fileName);
+    QVERIFY(read.isValid());
+    QCOMPARE(read.charts.count(), 1);
+    QCOMPARE(read.charts.first().name, chart.name);
+    QCOMPARE(read.charts.first().style, chart.style);
+    QCOMPARE(read.charts.first().size, chart.size);
+    QCOMPARE(read.stitches, metadata.stitches);
+    QCOMPARE(read.colors, metadata.colors);
+    QCOMPARE(read.preview.size(), metadata.preview.size());
+    QCOMPARE(read.preview.pixel(0, 0), metadata.preview.pixel(0, 0));
+
+    // the rest of the file still loads after the chunk.
+    MainWindow* mw = new MainWindow(QStringList() << fileName);
+    QTabWidget* tabs = mw->findChild<QTabWidget*>("tabWidget");
+    QVERIFY(tabs);
+    QCOMPARE(tabs->count(), 1);
+    Settings::inst()->files.remove(fileName.toLower());
+    delete mw;
+
+    // files without a chunk have no metadata.
+    QString plainName = "testfile_v2-plain.pattern";
+    createPatternFile(plainName, 10);
+    QVERIFY(!FileFactory::readMetadata(plainName).isValid());
+
+    QFile::remove(plainName);
+    QFile::remove(fileName);
+}
+
+/**
+ * the count of each colour in the pattern, without the time it was added.
+ */
+static QMap<QString, qint64> colorCounts(const QMap<QString, QMap<QString, qint64> >& colors)
+{
+    QMap<QString, qint64> counts;
+    foreach (QString color, colors.keys())
+        counts.insert(color, colors.value(color).value("count"));
+    return counts;
+}
+
+void TestFile_v2::pendingChartCounts()
+{
+    QString loadedName = "testfile_v2-loaded.pattern";
+    QString pendingName = "testfile_v2-pending.pattern";
+    createPatternFile(loadedName, 40);
+    createPatternFile(pendingName, 40, 0, true);
+
+    MainWindow* loaded = new MainWindow(QStringList() << loadedName);
+    MainWindow* pending = new MainWindow(QStringList() << pendingName);
+
+    QCOMPARE(pending->tabWidget()->count(), 2);
+    CrochetTab* tab = qobject_cast<CrochetTab*>(pending->tabWidget()->widget(1));
+    QVERIFY(tab);
+    QVERIFY(tab->hasPendingChart());
+
+    // the chart that's left pending counts its cells the same way as the one that's loaded.
+    QMap<QString, qint64> colors = colorCounts(loaded->patternColors());
+    QCOMPARE(pending->patternStitches(), loaded->patternStitches());
+    QCOMPARE(colorCounts(pending->patternColors()), colors);
+
+    QCOMPARE(loaded->patternStitches().value("ch"), 8);
+    // 14 cells are black and the 10 cells without a background colour have a black one.
+    QCOMPARE(colors.value("#000000"), qint64(24));
+    QCOMPARE(colors.value("#00ff00"), qint64(10));
+    QVERIFY(!colors.contains(""));
+    QVERIFY(!colors.contains("#ffffff"));
+
+    // loading the pending chart doesn't count its cells again.
+    tab->loadPendingChart();
+    QVERIFY(!tab->hasPendingChart());
+    QCOMPARE(tab->scene()->items().count() >= 40, true);
+    QCOMPARE(pending->patternStitches(), loaded->patternStitches());
+    QCOMPARE(colorCounts(pending->patternColors()), colors);
+
+    Settings::inst()->files.remove(loadedName.toLower());
+    Settings::inst()->files.remove(pendingName.toLower());
+    delete loaded;
+    delete pending;
+    QFile::remove(loadedName);
+    QFile::remove(pendingName);
+}
+
+/**
+ * the version in the header of a pattern file.
+ */
+static qint32 fileVersion(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    QDataStream in(&file);
+    quint32 magicNumber;
+    qint32 version;
+    in >> magicNumber >> version;
+    return version;
+}
+
+void TestFile_v2::saveKeepsVersion()
+{
+    QString fileName = "testfile_v2-version.pattern";
+    createPatternFile(fileName, 10);
+    QCOMPARE(fileVersion(fileName), qint32(FileFactory::Version_1_2));
+
+    MainWindow* mw = new MainWindow(QStringList() << fileName);
+
+    // saving keeps the version so older releases can still open the file.
+    QCOMPARE(mw->mFile->save(), FileFactory::No_Error);
+    QCOMPARE(fileVersion(fileName), qint32(FileFactory::Version_1_2));
+
+    QCOMPARE(mw->mFile->save(FileFactory::Version_1_3), FileFactory::No_Error);
+    QCOMPARE(fileVersion(fileName), qint32(FileFactory::Version_1_3));
+    QVERIFY(FileFactory::readMetadata(fileName).isValid());
+
+    Settings::inst()->files.remove(fileName.toLower());
+    delete mw;
+    QFile::remove(fileName);
+}
+
+void TestFile_v2::cleanupTestCase()
+{
+}
+
+void TestFile_v2::createPatternFile(const QString& fileName, int cellCount,
+                                    const PatternMetadata* metadata, bool pending)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    QDataStream out(&file);
+    out << AppInfo::inst()->magicNumber;
+    out << (qint32)(metadata ? FileFactory::Version_1_3 : FileFactory::Version_1_2);
+    out.setVersion(QDataStream::Qt_4_7);
+
+    if (metadata) {
+        QByteArray chunk;
+        QDataStream chunkStream(&chunk, QIODevice::WriteOnly);
+        chunkStream.setVersion(QDataStream::Qt_4_7);
+        chunkStream << *metadata;
+        out << chunk;
+    }
+
+    // no embedded icons.
+    out << QMap<QString, QByteArray>();
+
+    QByteArray data;
+    QXmlStreamWriter xml(&data);
+    xml.writeStartDocument();
+    xml.writeStartElement("pattern");
+    xml.writeAttribute("version", QString::number(FileFactory::Version_1_2));
+
+    xml.writeStartElement("colors");
+    xml.writeStartElement("color");
+    xml.writeAttribute("added", "0");
+    xml.writeCharacters("#000000");
+    xml.writeEndElement();
+    xml.writeEndElement(); // colors
+
+    if (pending) {
+        xml.writeStartElement("chart");
+        xml.writeTextElement("name", "Empty");
+        xml.writeTextElement("style", QString::number(Scene::Blank));
+        xml.writeEndElement();
+    }
+
+    xml.writeStartElement("chart");
+    xml.writeTextElement("name", "Chart");
+    xml.writeTextElement("style", QString::number(Scene::Blank));
+    xml.writeTextElement("defaultSt", "ch");
+
+    xml.writeStartElement("chartLayer");
+    xml.writeAttribute("name", "Layer 1");
+    xml.writeAttribute("uid", "1");
+    xml.writeAttribute("visible", "1");
+    xml.writeEndElement();
+
+    QStringList stitches;
+    stitches << "ch" << "sc" << "hdc" << "dc" << "tr";
+    QStringList colors;
+    colors << "#000000" << "#ff0000" << "#0000ff";
+
+    int columns = 500;
+    for (int i = 0; i < cellCount; ++i) {
+        qreal x = (i % columns) * 32.5;
+        qreal y = (i / columns) * 64.25;
+
+        xml.writeStartElement("cell");
+        xml.writeTextElement("stitch", stitches.at(i % stitches.count()));
+        xml.writeTextElement("layer", "1");
+
+        xml.writeStartElement("position");
+        xml.writeAttribute("x", QString::number(x));
+        xml.writeAttribute("y", QString::number(y));
+        xml.writeEndElement();
+
+        xml.writeStartElement("newscale");
+        xml.writeAttribute("scaleX", "1");
+        xml.writeAttribute("scaleY", "1");
+        xml.writeAttribute("pivotX", "16");
+        xml.writeAttribute("pivotY", "8");
+        xml.writeEndElement();
+
+        xml.writeStartElement("rotation");
+        xml.writeAttribute("rotation", QString::number((i % 360) * 0.5));
+        xml.writeAttribute("pivotX", "16");
+        xml.writeAttribute("pivotY", "8");
+        xml.writeEndElement();
+
+        xml.writeTextElement("color", colors.at(i % colors.count()));
+        // a quarter of the cells have no background colour and a quarter a green one.
+        if (i % 4 == 2)
+            xml.writeTextElement("bgColor", "#00ff00");
+        else if (i % 4 != 1)
+            xml.writeTextElement("bgColor", "#ffffff");
+
+        xml.writeStartElement("pivotPoint");
+        xml.writeAttribute("x", "0");
+        xml.writeAttribute("y", "0");
+        xml.writeEndElement();
+
+        xml.writeEndElement(); // cell
+    }
+
+    xml.writeEndElement(); // chart
+    xml.writeEndElement(); // pattern
+    xml.writeEndDocument();
+
+    out << data;
+    file.close();
+}
@@ -0,0 +1,52 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef TESTFILE_V2_H
+#define TESTFILE_V2_H
+
+#include <QtTest/QTest>
+#include <QDebug>
+#include <QObject>
+
+struct PatternMetadata;
+
+class TestFile_v2 : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void toReal();
+    void toReal_data();
+    void readMetadata();
+    void pendingChartCounts();
+    void saveKeepsVersion();
+    void cleanupTestCase();
+
+private:
+    /**
+     * write a v2 pattern file with a single blank chart holding cellCount free cells.
+     * If metadata is given the file is written as v1.3 with a metadata chunk. If pending is
+     * true an empty chart comes first, so the chart with the cells isn't loaded when it's opened.
+     */
+    void createPatternFile(const QString& fileName, int cellCount,
+                           const PatternMetadata* metadata = 0, bool pending = false);
+};
+
+#endif // TESTFILE_V2_H
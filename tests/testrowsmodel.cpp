@@ -0,0 +1,154 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testrowsmodel.h"
+
+#include <QSignalSpy>
+
+#include "../src/scene.h"
+#include "../src/rowsmodel.h"
+#include "../src/cell.h"
+#include "../src/settings.h"
+#include "testutils.h"
+
+/**
+ * The colour of each row, 'p' when all its cells use the primary stitch colour,
+ * 'a' when they all use the alternate one and '?' when they are mixed.
+ */
+static QString rowColors(Scene &scene)
+{
+    QColor primary(Settings::inst()->value("stitchPrimaryColor").toString());
+    QColor alternate(Settings::inst()->value("stitchAlternateColor").toString());
+
+    QString colors;
+    for (int row = 0; row < scene.rowCount(); ++row)
+    {
+        QChar color;
+        for (int col = 0; col < scene.columnCount(row); ++col)
+        {
+            QColor c = scene.cell(row, col)->color();
+            QChar cellColor = (c == primary) ? 'p' : (c == alternate) ? 'a' : '?';
+            color = (color.isNull() || color == cellColor) ? cellColor : QChar('?');
+        }
+        colors.append(color);
+    }
+    return colors;
+}
+
+void TestRowsModel::addRows()
+{
+    Scene scene;
+    RowsModel* model = scene.rowsModel();
+    QSignalSpy inserted(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    QSignalSpy reset(model, SIGNAL(modelReset()));
+
+    scene.gridAddRow(TestUtils::createRow(3, &scene));
+    scene.gridAddRow(TestUtils::createRow(2, &scene));
+    scene.gridAddRow(TestUtils::createRow(1, &scene), false, 0);
+
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(inserted.count(), 3);
+    QCOMPARE(inserted.last().at(1).toInt(), 0);
+    QCOMPARE(reset.count(), 0);
+
+    QCOMPARE(model->data(model->index(0)).toInt(), 1);
+    QCOMPARE(model->data(model->index(2)).toInt(), 3);
+    QCOMPARE(model->data(model->index(1), Qt::ToolTipRole).toString(), QString("3 stitches"));
+}
+
+void TestRowsModel::moveRows()
+{
+    Scene scene;
+    RowsModel* model = scene.rowsModel();
+
+    for (int i = 1; i <= 4; ++i)
+        scene.gridAddRow(TestUtils::createRow(i, &scene));
+
+    QSignalSpy moved(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)));
+
+    scene.moveRowDown(0);
+    QCOMPARE(scene.columnCount(0), 2);
+    QCOMPARE(scene.columnCount(1), 1);
+
+    scene.moveRowUp(3);
+    QCOMPARE(scene.columnCount(2), 4);
+    QCOMPARE(scene.columnCount(3), 3);
+
+    // moving past the ends does nothing.
+    scene.moveRowUp(0);
+    scene.moveRowDown(3);
+
+    QCOMPARE(moved.count(), 2);
+    QCOMPARE(model->rowCount(), 4);
+}
+
+void TestRowsModel::removeRows()
+{
+    Scene scene;
+    RowsModel* model = scene.rowsModel();
+
+    for (int i = 1; i <= 3; ++i)
+        scene.gridAddRow(TestUtils::createRow(i, &scene));
+    scene.gridAddRow(QList<Cell *>() << 0 << 0);
+
+    QSignalSpy removed(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+
+    scene.removeRow(1);
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(scene.columnCount(1), 3);
+
+    // the row without any cells left in it goes.
+    scene.removeEmptyRows();
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(removed.count(), 2);
+}
+
+void TestRowsModel::alternateRows()
+{
+    Scene scene;
+    QColor primary(Settings::inst()->value("stitchPrimaryColor").toString());
+
+    QList<Cell *> first;
+    for (int i = 1; i <= 5; ++i)
+    {
+        QList<Cell *> row = TestUtils::createRow(i, &scene);
+        foreach(Cell *c, row)
+            c->setColor(primary);
+        scene.gridAddRow(row);
+        if (i == 1)
+            first = row;
+    }
+
+    // removing the first row recolours every row after it.
+    scene.removeRow(0);
+    QCOMPARE(rowColors(scene), QString("papa"));
+    QCOMPARE(first.first()->color(), primary);
+
+    scene.moveRowDown(1);
+    QCOMPARE(scene.columnCount(1), 4);
+    QCOMPARE(rowColors(scene), QString("papa"));
+
+    scene.moveRowUp(3);
+    QCOMPARE(scene.columnCount(2), 5);
+    QCOMPARE(rowColors(scene), QString("papa"));
+
+    scene.removeRow(1);
+    QCOMPARE(rowColors(scene), QString("pap"));
+}
@@ -0,0 +1,671 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testscene.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QDataStream>
+#include <QGraphicsRectItem>
+#include <QGraphicsView>
+#include <QImage>
+#include <QMimeData>
+#include <QPainter>
+#include <QSignalSpy>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "../src/ChartItemTools.h"
+#include "../src/cell.h"
+#include "../src/chartmimedata.h"
+#include "../src/guideline.h"
+#include "../src/itemgroup.h"
+#include "../src/scene.h"
+#include "../src/selectionproxy.h"
+#include "../src/settings.h"
+#include "testutils.h"
+
+void TestScene::setSelection()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 10);
+    QSignalSpy changed(&scene, SIGNAL(selectionChanged()));
+
+    scene.setSelection(cells.mid(0, 5));
+    QCOMPARE(scene.selectedItems().count(), 5);
+    QCOMPARE(scene.selectionCount(), 5);
+    QCOMPARE(changed.count(), 1);
+
+    // the items that are in both selections stay selected.
+    scene.setSelection(cells.mid(3, 5));
+    QCOMPARE(scene.selectedItems().count(), 5);
+    QCOMPARE(scene.selectionCount(), 5);
+    QCOMPARE(scene.selectionProperties().count(), 5);
+    QVERIFY(!cells.at(2)->isSelected());
+    QVERIFY(cells.at(3)->isSelected());
+    QVERIFY(cells.at(7)->isSelected());
+    QCOMPARE(changed.count(), 2);
+
+    // nothing changes so nothing is sent.
+    scene.setSelection(cells.mid(3, 5));
+    QCOMPARE(changed.count(), 2);
+
+    scene.setSelection(QList<QGraphicsItem *>());
+    QCOMPARE(scene.selectedItems().count(), 0);
+    QCOMPARE(scene.selectionCount(), 0);
+    QCOMPARE(scene.selectionProperties().count(), 0);
+    QCOMPARE(changed.count(), 3);
+
+    // selecting an item on its own still counts it.
+    cells.at(0)->setSelected(true);
+    QCOMPARE(scene.selectionCount(), 1);
+}
+
+void TestScene::addToSelection()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 10);
+    cells.at(9)->setFlag(QGraphicsItem::ItemIsSelectable, false);
+
+    scene.setSelection(cells.mid(0, 2));
+    scene.setSelection(cells.mid(6), true);
+
+    QCOMPARE(scene.selectedItems().count(), 5);
+    QVERIFY(cells.at(0)->isSelected());
+    QVERIFY(!cells.at(9)->isSelected());
+}
+
+void TestScene::highlightRow()
+{
+    Scene scene;
+    scene.gridAddRow(TestUtils::createRow(4, &scene));
+
+    QSignalSpy changed(&scene, SIGNAL(selectionChanged()));
+    scene.highlightRow(0);
+
+    QCOMPARE(scene.selectedItems().count(), 4);
+    QCOMPARE(changed.count(), 1);
+}
+
+void TestScene::moveProxy()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 3);
+
+    QRectF rect;
+    foreach (QGraphicsItem *item, cells)
+        rect |= item->sceneBoundingRect();
+
+    SelectionProxy proxy(cells, 2.0);
+    QCOMPARE(proxy.pos(), rect.topLeft());
+    QCOMPARE(proxy.boundingRect().size(), rect.size());
+    QCOMPARE(proxy.offset(), QPointF(0, 0));
+
+    proxy.setOffset(QPointF(40, -8));
+    QCOMPARE(proxy.pos(), rect.topLeft() + QPointF(40, -8));
+    QCOMPARE(proxy.offset(), QPointF(40, -8));
+
+    // the items stay where they are until the drag is over.
+    QCOMPARE(cells.first()->sceneBoundingRect().topLeft(), rect.topLeft());
+}
+
+void TestScene::selectionCount()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 5);
+    QCOMPARE(scene.selectionCount(), 0);
+
+    cells.at(0)->setSelected(true);
+    QVERIFY(scene.isSingleSelection());
+
+    scene.setSelection(cells.mid(1));
+    QCOMPARE(scene.selectionCount(), 4);
+    QVERIFY(!scene.isSingleSelection());
+
+    // items keep their selected state outside of the scene.
+    scene.removeItem(cells.at(1));
+    QCOMPARE(scene.selectionCount(), 3);
+    scene.addItem(cells.at(1));
+    QCOMPARE(scene.selectionCount(), 4);
+
+    delete cells.takeLast();
+    QCOMPARE(scene.selectionCount(), 3);
+
+    cells.at(2)->setFlag(QGraphicsItem::ItemIsSelectable, false);
+    QCOMPARE(scene.selectionCount(), 2);
+    QCOMPARE(scene.selectionCount(), scene.selectedItems().count());
+
+    scene.clearSelection();
+    QCOMPARE(scene.selectionCount(), 0);
+}
+
+void TestScene::hiddenCenterSelection()
+{
+    Scene scene;
+    // the center symbol is put in the middle of the view.
+    QGraphicsView view(&scene);
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 2);
+
+    scene.setShowChartCenter(true);
+    QList<QGraphicsItem *> items = cells;
+    foreach(QGraphicsItem *item, scene.items())
+    {
+        if (item->flags() & QGraphicsItem::ItemIsSelectable && !cells.contains(item))
+            items.append(item);
+    }
+    QCOMPARE(items.count(), 3);
+
+    scene.setSelection(items);
+    QCOMPARE(scene.selectionCount(), 3);
+    QCOMPARE(scene.selectionCount(), scene.selectedItems().count());
+
+    scene.setShowChartCenter(false);
+    QCOMPARE(scene.selectionCount(), 2);
+    QCOMPARE(scene.selectionCount(), scene.selectedItems().count());
+    QVERIFY(!scene.isSingleSelection());
+
+    scene.setShowChartCenter(true);
+    QCOMPARE(scene.selectionCount(), scene.selectedItems().count());
+}
+
+void TestScene::guidelines()
+{
+    QFETCH(QString, type);
+    QFETCH(QRectF, rect);
+
+    Scene scene;
+    Guidelines g;
+    g.setType(type);
+    g.setRows(4);
+    g.setColumns(6);
+    g.setCellWidth(32);
+    g.setCellHeight(16);
+    scene.propertiesUpdate("Guidelines", QVariant::fromValue(g));
+
+    QCOMPARE(scene.guidelinesRect(), rect);
+
+    if (rect.isNull())
+    {
+        QCOMPARE(scene.items().count(), 0);
+        return;
+    }
+
+    // one item draws all the guidelines, above background images and below the chart.
+    QCOMPARE(scene.items().count(), 1);
+    QCOMPARE(scene.items().first()->type(), int(Guideline::Type));
+    QCOMPARE(scene.items().first()->zValue(), qreal(-1));
+    QVERIFY(scene.itemsBoundingRect().contains(rect));
+
+    // something is drawn where the guidelines are and nothing outside of them.
+    QImage img(rect.size().toSize() + QSize(40, 40), QImage::Format_ARGB32);
+    img.fill(Qt::white);
+    QPainter p(&img);
+    p.translate(-rect.topLeft() + QPointF(20, 20));
+    scene.drawGuidelines(&p, rect.adjusted(-20, -20, 20, 20));
+    p.end();
+
+    bool drawn = false;
+    for (int x = 0; x < img.width() && !drawn; ++x)
+        for (int y = 0; y < img.height() && !drawn; ++y)
+            drawn = img.pixel(x, y) != qRgb(255, 255, 255);
+    QVERIFY(drawn);
+    QCOMPARE(img.pixel(5, 5), qRgb(255, 255, 255));
+
+    // rounds only have the dividing lines, on the first ring half way between two of them
+    // nothing is drawn.
+    if (type == "Rounds")
+    {
+        QCOMPARE(img.pixel(116, 127), qRgb(255, 255, 255));
+        QCOMPARE(img.pixel(116, 128), qRgb(255, 255, 255));
+    }
+
+    // nothing is drawn for an area away from the guidelines.
+    img.fill(Qt::white);
+    p.begin(&img);
+    p.translate(-rect.bottomRight() - QPointF(100, 100));
+    scene.drawGuidelines(&p, QRectF(rect.bottomRight() + QPointF(100, 100), img.size()));
+    p.end();
+    QCOMPARE(img.pixel(img.width() / 2, img.height() / 2), qRgb(255, 255, 255));
+}
+
+void TestScene::guidelines_data()
+{
+    QTest::addColumn<QString>("type");
+    QTest::addColumn<QRectF>("rect");
+
+    QTest::newRow("none") << "None" << QRectF();
+    QTest::newRow("rows") << "Rows" << QRectF(0, 0, 6 * 32, 4 * 16);
+    QTest::newRow("rounds") << "Rounds" << QRectF(-80, -80, 160, 160);
+    QTest::newRow("triangles") << "Triangles" << QRectF(-64, 0, 128, 64);
+}
+
+void TestScene::cellIndexes()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 6);
+    Cell *first = qgraphicsitem_cast<Cell *>(cells.at(0));
+    Cell *second = qgraphicsitem_cast<Cell *>(cells.at(1));
+
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 6);
+    QCOMPARE(scene.cellsWithStitch("sc").count(), 0);
+
+    first->setStitch("sc");
+    second->setColor(QColor(Qt::red));
+    second->setBgColor(QColor(Qt::blue));
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 5);
+    QCOMPARE(scene.cellsWithStitch("sc"), QList<Cell *>() << first);
+    QCOMPARE(scene.cellsWithColor(QColor(Qt::red)), QList<Cell *>() << second);
+    QCOMPARE(scene.cellsWithBgColor(QColor(Qt::blue)), QList<Cell *>() << second);
+    QCOMPARE(scene.cellsWithColor(QColor(Qt::blue)).count(), 0);
+
+    // cells leave the indexes with the scene and come back with it.
+    scene.removeItem(first);
+    QCOMPARE(scene.cellsWithStitch("sc").count(), 0);
+    first->setStitch("ch");
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 5);
+    scene.addItem(first);
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 6);
+
+    delete second;
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 5);
+    QCOMPARE(scene.cellsWithColor(QColor(Qt::red)).count(), 0);
+
+    // the scene still passes changes on to the tab, once.
+    QSignalSpy changed(&scene, SIGNAL(stitchChanged(QString, QString)));
+    scene.removeItem(first);
+    scene.addItem(first);
+    first->setStitch("sc");
+    QCOMPARE(changed.count(), 1);
+}
+
+void TestScene::replaceFromIndexes()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 10);
+    for (int i = 0; i < 10; i += 2)
+    {
+        Cell *c = qgraphicsitem_cast<Cell *>(cells.at(i));
+        c->setColor(QColor(Qt::red));
+        c->setBgColor(i < 4 ? QColor(Qt::red) : QColor(Qt::white));
+    }
+
+    scene.replaceColor(QColor(Qt::red), QColor(Qt::green), 1);
+    QCOMPARE(scene.cellsWithColor(QColor(Qt::green)).count(), 5);
+    QCOMPARE(scene.cellsWithBgColor(QColor(Qt::red)).count(), 2);
+
+    scene.replaceColor(QColor(Qt::red), QColor(Qt::green), 3);
+    QCOMPARE(scene.cellsWithBgColor(QColor(Qt::green)).count(), 2);
+
+    scene.replaceStitches("ch", "sc");
+    QCOMPARE(scene.cellsWithStitch("sc").count(), 10);
+    scene.undoStack()->undo();
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 10);
+
+    scene.selectColor(QColor(Qt::green));
+    QCOMPARE(scene.selectionCount(), 5);
+    scene.selectStitch("ch");
+    QCOMPARE(scene.selectionCount(), 10);
+}
+
+void TestScene::selectionProperties()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 4);
+    const SelectionProperties &props = scene.selectionProperties();
+
+    QCOMPARE(props.count(), 0);
+    QCOMPARE(props.type(), 0);
+
+    scene.setSelection(cells.mid(0, 2));
+    QCOMPARE(props.count(), 2);
+    QCOMPARE(props.type(), int(Cell::Type));
+    QCOMPARE(props.properties().stitch, QString("ch"));
+    QVERIFY(!props.isMixed(SelectionProperties::Stitch));
+    // the cells are side by side.
+    QVERIFY(props.isMixed(SelectionProperties::PositionX));
+    QVERIFY(!props.isMixed(SelectionProperties::PositionY));
+    QCOMPARE(props.properties().position, QPointF(0, 0));
+
+    // changes to selected items are counted straight away.
+    Cell *c = qgraphicsitem_cast<Cell *>(cells.at(0));
+    c->setStitch("sc");
+    QVERIFY(props.isMixed(SelectionProperties::Stitch));
+    QCOMPARE(props.properties().stitch, QString());
+
+    ChartItemTools::setRotation(c, 45);
+    QVERIFY(props.isMixed(SelectionProperties::Angle));
+    QCOMPARE(props.minAngle(), 0.0);
+    QCOMPARE(props.maxAngle(), 45.0);
+
+    c->setPos(32, 0);
+    QVERIFY(!props.isMixed(SelectionProperties::PositionX));
+    QCOMPARE(props.properties().position, QPointF(32, 0));
+
+    // leaving the selection takes the item out again.
+    c->setSelected(false);
+    QCOMPARE(props.count(), 1);
+    QVERIFY(!props.isMixed(SelectionProperties::Stitch));
+    QVERIFY(!props.isMixed(SelectionProperties::Angle));
+    QCOMPARE(props.properties().stitch, QString("ch"));
+
+    // changes to items that aren't selected are ignored.
+    ChartItemTools::setScaleX(c, 2);
+    QCOMPARE(props.maxScale(), QPointF(1, 1));
+
+    Indicator *i = new Indicator();
+    scene.addItem(i);
+    i->setSelected(true);
+    QCOMPARE(props.count(), 2);
+    QCOMPARE(props.count(Indicator::Type), 1);
+    QCOMPARE(props.type(), 0);
+
+    delete i;
+    QCOMPARE(props.count(), 1);
+    QCOMPARE(props.type(), int(Cell::Type));
+}
+
+void TestScene::roundsChart()
+{
+    Scene scene;
+    scene.createRoundsChart(3, 8, "ch", QSizeF(32, 96), 4);
+
+    QCOMPARE(scene.rowCount(), 3);
+    QCOMPARE(scene.columnCount(0), 8);
+    QCOMPARE(scene.columnCount(2), 16);
+    QCOMPARE(scene.cellsWithStitch("ch").count(), 8 + 12 + 16);
+
+    // the cells are centered on the circle of their round, facing away from the middle.
+    for (int row = 0; row < 3; ++row)
+    {
+        qreal radius = 96 * (row + 1) + 32;
+        int columns = scene.columnCount(row);
+        for (int col = 0; col < columns; ++col)
+        {
+            Cell *c = scene.cell(row, col);
+            qreal degrees = 360.0 / columns * col;
+            QRectF r = c->boundingRect();
+            QPointF center = c->pos() + QPointF(r.width() / 2, r.height() / 2);
+
+            QVERIFY(qAbs(center.x() - radius * qCos(qDegreesToRadians(degrees))) < 0.0001);
+            QVERIFY(qAbs(center.y() - radius * qSin(qDegreesToRadians(degrees))) < 0.0001);
+            QCOMPARE(c->rotation(), degrees + 90);
+            QCOMPARE(c->transformOriginPoint(), QPointF(r.width() / 2, r.height()));
+        }
+    }
+}
+
+void TestScene::rowsChart()
+{
+    Scene scene;
+    scene.createRowsChart(4, 5, "ch", QSizeF(32, 96));
+
+    QCOMPARE(scene.rowCount(), 4);
+    QCOMPARE(scene.columnCount(3), 5);
+
+    // the first row of the grid is at the top, and each row is right to left.
+    Cell *c = scene.cell(0, 0);
+    QCOMPARE(c->pos().y(), 96.0);
+    QCOMPARE(scene.cell(3, 0)->pos().y(), 4 * 96.0);
+    QVERIFY(scene.cell(0, 1)->pos().x() < c->pos().x());
+    QCOMPARE(c->pos().x(), (c->stitch()->width() + 32) * 5);
+}
+
+void TestScene::align()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 4);
+    cells.at(1)->setPos(100, 50);
+    cells.at(2)->setPos(20, 200);
+    cells.at(3)->setPos(300, 10);
+    scene.setSelection(cells);
+
+    // align to the right edge.
+    scene.align(0, 3);
+    qreal right = cells.at(3)->sceneBoundingRect().right();
+    foreach (QGraphicsItem *i, cells)
+        QCOMPARE(i->sceneBoundingRect().right(), right);
+    QCOMPARE(cells.at(2)->pos().y(), 200.0);
+
+    // the whole selection moves back in one step.
+    QCOMPARE(scene.undoStack()->count(), 1);
+    scene.undoStack()->undo();
+    QCOMPARE(cells.at(1)->pos(), QPointF(100, 50));
+    QCOMPARE(cells.at(0)->pos(), QPointF(0, 0));
+}
+
+void TestScene::distribute()
+{
+    Scene scene;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&scene, 4);
+    cells.at(0)->setPos(0, 0);
+    cells.at(1)->setPos(500, 10);
+    cells.at(2)->setPos(20, 20);
+    cells.at(3)->setPos(60, 30);
+    scene.setSelection(cells);
+
+    QList<QGraphicsItem *> sorted = scene.sortItemsHorizontally(cells, 1);
+    QCOMPARE(sorted, QList<QGraphicsItem *>() << cells.at(0) << cells.at(2) << cells.at(3)
+                                              << cells.at(1));
+
+    // the left edges are spread evenly between the first and the last.
+    scene.distribute(0, 1);
+    QCOMPARE(cells.at(0)->pos().x(), 0.0);
+    QCOMPARE(cells.at(2)->pos().x(), 500.0 / 3);
+    QCOMPARE(cells.at(3)->pos().x(), 1000.0 / 3);
+    QCOMPARE(cells.at(1)->pos().x(), 500.0);
+    QCOMPARE(cells.at(3)->pos().y(), 30.0);
+
+    QCOMPARE(scene.undoStack()->count(), 1);
+    scene.undoStack()->undo();
+    QCOMPARE(cells.at(3)->pos(), QPointF(60, 30));
+}
+
+void TestScene::indicatorCache()
+{
+    Scene scene;
+    Indicator *ind = new Indicator();
+    scene.addItem(ind);
+    ind->setStyle("Dots and Text");
+    ind->setText("1");
+    QRectF rect = ind->sceneBoundingRect().adjusted(-2, -2, 2, 2);
+
+    QImage first(rect.size().toSize(), QImage::Format_ARGB32_Premultiplied);
+    first.fill(Qt::white);
+    QPainter p(&first);
+    scene.render(&p, QRectF(), rect);
+    p.end();
+
+    // painting again comes from the cache and looks the same.
+    QImage again(first.size(), first.format());
+    again.fill(Qt::white);
+    p.begin(&again);
+    scene.render(&p, QRectF(), rect);
+    p.end();
+    QCOMPARE(again, first);
+
+    // changing the text or the style draws it again.
+    ind->setText("8");
+    QImage text(first.size(), first.format());
+    text.fill(Qt::white);
+    p.begin(&text);
+    scene.render(&p, QRectF(), rect);
+    p.end();
+    QVERIFY(text != first);
+
+    ind->setStyle("Dots");
+    QImage dots(first.size(), first.format());
+    dots.fill(Qt::white);
+    p.begin(&dots);
+    scene.render(&p, QRectF(), rect);
+    p.end();
+    QVERIFY(dots != text);
+}
+
+void TestScene::stackingOrder()
+{
+    QGraphicsScene scene;
+
+    // two levels of groups, with children stacked below their siblings and behind their parent.
+    QGraphicsRectItem* bottom = scene.addRect(0, 0, 10, 10);
+    bottom->setZValue(1);
+    QGraphicsRectItem* group = new QGraphicsRectItem(0, 0, 10, 10, bottom);
+    group->setZValue(5);
+    QGraphicsRectItem* nested = new QGraphicsRectItem(0, 0, 10, 10, group);
+    nested->setZValue(-3);
+    QGraphicsRectItem* behind = new QGraphicsRectItem(0, 0, 10, 10, group);
+    behind->setFlag(QGraphicsItem::ItemStacksBehindParent);
+    QGraphicsRectItem* sibling = new QGraphicsRectItem(0, 0, 10, 10, bottom);
+    sibling->setZValue(2);
+
+    QGraphicsRectItem* top = scene.addRect(0, 0, 10, 10);
+    top->setZValue(2);
+    QGraphicsRectItem* topChild = new QGraphicsRectItem(0, 0, 10, 10, top);
+    topChild->setZValue(-10);
+
+    QList<QGraphicsItem*> expected = scene.items(Qt::AscendingOrder);
+    QList<QGraphicsItem*> items = expected;
+    std::reverse(items.begin(), items.end());
+    Scene::sortByStackingOrder(items);
+    QCOMPARE(items, expected);
+
+    QCOMPARE(items.indexOf(behind) < items.indexOf(group), true);
+    QCOMPARE(items.indexOf(nested) > items.indexOf(group), true);
+    QCOMPARE(items.indexOf(sibling) < items.indexOf(group), true);
+}
+
+void TestScene::selectedStackingOrder()
+{
+    Scene scene;
+    QList<QGraphicsItem*> cells = TestUtils::addCells(&scene, 4);
+    ItemGroup* group = scene.group(QList<QGraphicsItem*>() << cells.at(0) << cells.at(1));
+    cells.at(3)->setZValue(-5);
+    group->setZValue(5);
+
+    scene.clearSelection();
+    group->setSelected(true);
+    cells.at(3)->setSelected(true);
+
+    QList<QGraphicsItem*> expected;
+    foreach(QGraphicsItem* item, scene.items(Qt::AscendingOrder))
+    {
+        if (item == cells.at(3) || item == group || item->parentItem() == group)
+            expected.append(item);
+    }
+
+    QList<QGraphicsItem*> items = scene.selectedItemsInStackingOrder();
+    QCOMPARE(items, expected);
+    QCOMPARE(items.count(), 4);
+    QCOMPARE(items.first(), cells.at(3));
+    QVERIFY(!items.contains(cells.at(2)));
+}
+
+/**
+ * put data on the clipboard the way another copy of the application would, so it has to be
+ * decoded when it's pasted.
+ */
+static void setClipboard(const QByteArray &data)
+{
+    QMimeData *mimeData = new QMimeData;
+    mimeData->setData(ChartMimeData::format, data);
+    QApplication::clipboard()->setMimeData(mimeData);
+}
+
+void TestScene::pasteGroups()
+{
+    QVariant pasteOffset = Settings::inst()->value("pasteOffset");
+    Settings::inst()->setValue("pasteOffset", QString("Down and Right"));
+
+    Scene source;
+    QList<QGraphicsItem *> cells = TestUtils::addCells(&source, 3);
+    qgraphicsitem_cast<Cell *>(cells.at(2))->setStitch("sc");
+    ItemGroup *inner = source.group(QList<QGraphicsItem *>() << cells.at(0) << cells.at(1));
+    ItemGroup *outer = source.group(QList<QGraphicsItem *>() << inner << cells.at(2));
+
+    ChartMimeData copy;
+    copy.addItems(QList<QGraphicsItem *>() << outer);
+    setClipboard(copy.data(ChartMimeData::format));
+
+    Scene scene;
+    scene.paste();
+
+    QList<QGraphicsItem *> pasted = scene.selectedItems();
+    QCOMPARE(pasted.count(), 1);
+    ItemGroup *group = qgraphicsitem_cast<ItemGroup *>(pasted.first());
+    QVERIFY(group);
+    QCOMPARE(group->childItems().count(), 2);
+
+    ItemGroup *nested = 0;
+    Cell *cell = 0;
+    foreach(QGraphicsItem *child, group->childItems())
+    {
+        if (!nested)
+            nested = qgraphicsitem_cast<ItemGroup *>(child);
+        if (!cell)
+            cell = qgraphicsitem_cast<Cell *>(child);
+    }
+    QVERIFY(nested);
+    QVERIFY(cell);
+    QCOMPARE(cell->name(), QString("sc"));
+    QCOMPARE(nested->childItems().count(), 2);
+    foreach(QGraphicsItem *child, nested->childItems())
+        QCOMPARE(qgraphicsitem_cast<Cell *>(child)->name(), QString("ch"));
+
+    // the whole paste is undone in one step.
+    QCOMPARE(scene.undoStack()->count(), 1);
+
+    Settings::inst()->setValue("pasteOffset", pasteOffset);
+}
+
+void TestScene::pasteCorrupted()
+{
+    QVariant pasteOffset = Settings::inst()->value("pasteOffset");
+    Settings::inst()->setValue("pasteOffset", QString("Down and Right"));
+
+    Scene source;
+    ChartMimeData copy;
+    copy.addItems(TestUtils::addCells(&source, 10));
+    QByteArray data = copy.data(ChartMimeData::format);
+
+    // a copy that was cut short isn't pasted at all.
+    Scene scene;
+    int count = scene.items().count();
+    setClipboard(data.left(data.size() / 2));
+    scene.paste();
+    QCOMPARE(scene.items().count(), count);
+    QCOMPARE(scene.undoStack()->count(), 0);
+
+    // the old format stops at the end of the data, whatever count it claims.
+    QByteArray legacy;
+    QDataStream stream(&legacy, QIODevice::WriteOnly);
+    stream << int(1000000) << int(Cell::Type);
+    stream << QString("ch") << QColor(Qt::black) << QColor(Qt::white) << qreal(0) << QPointF();
+    stream << qreal(1) << qreal(1) << QPointF() << QPointF() << QPointF(32, 32);
+    stream << int(ItemGroup::Type) << QPointF() << int(1000000);
+    setClipboard(legacy);
+    scene.paste();
+
+    QList<QGraphicsItem *> pasted = scene.selectedItems();
+    QCOMPARE(pasted.count(), 1);
+    QVERIFY(qgraphicsitem_cast<Cell *>(pasted.first()));
+    QCOMPARE(scene.items().count(), count + 1);
+
+    Settings::inst()->setValue("pasteOffset", pasteOffset);
+}
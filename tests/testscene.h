@@ -0,0 +1,56 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef TESTSCENE_H
+#define TESTSCENE_H
+
+#include <QtTest/QTest>
+#include <QDebug>
+#include <QObject>
+
+class Scene;
+
+class TestScene : public QObject
+{
+    Q_OBJECT
+private slots:
+    void setSelection();
+    void addToSelection();
+    void highlightRow();
+    void moveProxy();
+    void selectionCount();
+    void hiddenCenterSelection();
+    void guidelines();
+    void guidelines_data();
+    void cellIndexes();
+    void replaceFromIndexes();
+    void selectionProperties();
+    void roundsChart();
+    void rowsChart();
+    void align();
+    void distribute();
+    void indicatorCache();
+    void stackingOrder();
+    void selectedStackingOrder();
+    void pasteGroups();
+    void pasteCorrupted();
+};
+
+#endif // TESTSCENE_H
@@ -0,0 +1,124 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testsnaplattice.h"
+
+#include "../src/scene.h"
+#include "../src/snaplattice.h"
+
+void TestSnapLattice::kinds()
+{
+    QCOMPARE(SnapLattice::kind("None"), SnapLattice::None);
+    QCOMPARE(SnapLattice::kind("Rows"), SnapLattice::Rows);
+    QCOMPARE(SnapLattice::kind("Rounds"), SnapLattice::Rounds);
+    QCOMPARE(SnapLattice::kind("Triangles"), SnapLattice::Triangles);
+    QCOMPARE(SnapLattice::kind("Squares"), SnapLattice::None);
+
+    // a lattice without a size doesn't move anything.
+    SnapLattice empty(SnapLattice::Rows, 10, 10, 0, 32, QPointF(0, 0));
+    QCOMPARE(empty.kind(), SnapLattice::None);
+    QCOMPARE(empty.snap(QPointF(13, 7)), QPointF(13, 7));
+}
+
+void TestSnapLattice::rows()
+{
+    SnapLattice lattice(SnapLattice::Rows, 10, 10, 32, 32, QPointF(0, 0));
+
+    QCOMPARE(lattice.snap(QPointF(40, 17)), QPointF(32, 32));
+    // clamped to the grid.
+    QCOMPARE(lattice.snap(QPointF(-50, 500)), QPointF(0, 320));
+
+    SnapLattice moved(SnapLattice::Rows, 10, 10, 32, 32, QPointF(100, 100));
+    QCOMPARE(moved.snap(QPointF(140, 117)), QPointF(132, 132));
+}
+
+void TestSnapLattice::rounds()
+{
+    SnapLattice lattice(SnapLattice::Rounds, 3, 4, 32, 32, QPointF(100, 100));
+
+    QPointF p = lattice.snap(QPointF(100, 170));
+    QVERIFY(qAbs(p.x() - 100) < 0.0001);
+    QVERIFY(qAbs(p.y() - 164) < 0.0001);
+
+    p = lattice.snap(QPointF(165, 105));
+    QVERIFY(qAbs(p.x() - 164) < 0.0001);
+    QVERIFY(qAbs(p.y() - 100) < 0.0001);
+
+    // the outer ring is one past the last round.
+    p = lattice.snap(QPointF(100, 1000));
+    QVERIFY(qAbs(p.y() - 228) < 0.0001);
+
+    QCOMPARE(lattice.snap(QPointF(101, 101)), QPointF(100, 100));
+}
+
+void TestSnapLattice::triangles()
+{
+    SnapLattice lattice(SnapLattice::Triangles, 5, 0, 32, 32, QPointF(0, 0));
+
+    QCOMPARE(lattice.snap(QPointF(10, 40)), QPointF(16, 32));
+    QCOMPARE(lattice.snap(QPointF(-20, 70)), QPointF(-32, 64));
+}
+
+void TestSnapLattice::batch()
+{
+    QList<SnapLattice> lattices;
+    lattices << SnapLattice(SnapLattice::Rows, 10, 12, 32, 24, QPointF(5, 5))
+             << SnapLattice(SnapLattice::Rounds, 8, 12, 32, 24, QPointF(-20, 40))
+             << SnapLattice(SnapLattice::Triangles, 8, 0, 32, 24, QPointF(0, 0));
+
+    QVector<QPointF> points;
+    for (int i = 0; i < 200; ++i)
+        points.append(QPointF((i * 37) % 400 - 200, (i * 53) % 300 - 100));
+
+    // snapping a list of points gives the same points as snapping them one at a time.
+    foreach (const SnapLattice& lattice, lattices)
+    {
+        QVector<QPointF> snapped = points;
+        lattice.snap(snapped);
+        for (int i = 0; i < points.count(); ++i)
+            QCOMPARE(snapped.at(i), lattice.snap(points.at(i)));
+    }
+}
+
+void TestSnapLattice::sceneLattice()
+{
+    Scene scene;
+    QCOMPARE(scene.snapLattice().kind(), SnapLattice::None);
+    QCOMPARE(scene.snapPositionToGrid(QPointF(13, 7)), QPointF(13, 7));
+
+    Guidelines g;
+    g.setType("Rows");
+    g.setRows(10);
+    g.setColumns(10);
+    g.setCellWidth(32);
+    g.setCellHeight(32);
+    scene.propertiesUpdate("Guidelines", QVariant::fromValue(g));
+
+    QCOMPARE(scene.snapLattice().kind(), SnapLattice::Rows);
+    QCOMPARE(scene.snapPositionToGrid(QPointF(40, 17)), QPointF(32, 32));
+
+    Cell *c = new Cell();
+    c->setStitch("ch");
+    scene.addItem(c);
+    c->setPos(40, 17);
+    scene.snapItemsToGrid(QList<QGraphicsItem *>() << c);
+    QCOMPARE(c->sceneBoundingRect().center(), scene.snapPositionToGrid(QPointF(40, 17)
+                                                                       + c->boundingRect().center()));
+}
@@ -20,6 +20,12 @@
  \****************************************************************************/
 #include "teststitchset.h"
 
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+
+#include "../src/stitchiconstore.h"
+
 void TestStitchSet::initTestCase()
 {
     mSet = new StitchSet();
@@ -97,6 +103,43 @@ void TestStitchSet::saveLoadDataSet()
 
 }
 
+void TestStitchSet::loadEmbeddedIcons()
+{
+    QFile f(":/stitches/chain.svg");
+    QVERIFY(f.open(QIODevice::ReadOnly));
+
+    QMap<QString, QByteArray> icons;
+    icons.insert("custom.svg", f.readAll());
+    f.close();
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << icons;
+
+    int iconCount = StitchIconStore::inst()->count();
+
+    StitchSet* first = new StitchSet();
+    first->isTemporary = true;
+    first->stitchSetFileName = "teststitchset-embedded.xml";
+    QDataStream in(data);
+    first->loadIcons(&in);
+
+    StitchSet* second = new StitchSet();
+    second->isTemporary = true;
+    second->stitchSetFileName = "teststitchset-embedded.xml";
+    QDataStream in2(data);
+    second->loadIcons(&in2);
+
+    //both sets share the same icon and nothing is written to disk.
+    QCOMPARE(StitchIconStore::inst()->count(), iconCount + 1);
+    QVERIFY(!QDir(first->stitchSetFolder()).exists());
+
+    delete first;
+    QCOMPARE(StitchIconStore::inst()->count(), iconCount + 1);
+    delete second;
+    QCOMPARE(StitchIconStore::inst()->count(), iconCount);
+}
+
 void TestStitchSet::cleanupTestCase()
 {
 }
@@ -36,6 +36,7 @@ private slots:
     void findStitch();
     void findStitch_data();
     void saveLoadDataSet();
+    void loadEmbeddedIcons();
     void cleanupTestCase();
 
 private:
@@ -0,0 +1,144 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testsvgsymbolwriter.h"
+
+#include <QBuffer>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QXmlStreamReader>
+
+#include "../src/ChartItemTools.h"
+#include "../src/cell.h"
+#include "../src/stitchlibrary.h"
+#include "../src/svgsymbolwriter.h"
+
+/**
+ * write the items of scene as svg, with the symbol writer or by painting them.
+ */
+static QByteArray exportSvgData(QGraphicsScene* scene, bool useSymbols)
+{
+    QRectF rect = scene->itemsBoundingRect();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    if (useSymbols)
+    {
+        SvgSymbolWriter writer;
+        writer.write(&buffer, scene->items(Qt::AscendingOrder), rect);
+    }
+    else
+    {
+        QSvgGenerator gen;
+        gen.setOutputDevice(&buffer);
+        gen.setSize(rect.size().toSize());
+        gen.setViewBox(rect);
+
+        QPainter p;
+        p.begin(&gen);
+        scene->render(&p, rect, rect);
+        p.end();
+    }
+
+    return data;
+}
+
+void TestSvgSymbolWriter::initTestCase()
+{
+    StitchLibrary::inst()->loadStitchSets();
+}
+
+void TestSvgSymbolWriter::symbols()
+{
+    QGraphicsScene* scene = createScene(100);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    SvgSymbolWriter writer;
+    QVERIFY(writer.write(&buffer, scene->items(Qt::AscendingOrder), scene->itemsBoundingRect()));
+
+    // 3 stitches in 2 colors, each with and without a background.
+    QCOMPARE(writer.symbolCount(), 12);
+
+    int symbols = 0;
+    int uses = 0;
+    QXmlStreamReader reader(data);
+    while (!reader.atEnd())
+    {
+        reader.readNext();
+        if (!reader.isStartElement())
+            continue;
+
+        if (reader.name() == "symbol")
+            symbols++;
+        else if (reader.name() == "use")
+            uses++;
+    }
+
+    QVERIFY(!reader.hasError());
+    QCOMPARE(symbols, 12);
+    QCOMPARE(uses, 100);
+
+    delete scene;
+}
+
+void TestSvgSymbolWriter::exportSize()
+{
+    QGraphicsScene* scene = createScene(1000);
+
+    QByteArray painted = exportSvgData(scene, false);
+    QByteArray symbols = exportSvgData(scene, true);
+
+    // every cell is a <use> of one of 12 symbols instead of its own copy of the stitch.
+    QVERIFY(symbols.size() > 0);
+    QVERIFY(symbols.size() * 2 < painted.size());
+
+    delete scene;
+}
+
+QGraphicsScene* TestSvgSymbolWriter::createScene(int cellCount)
+{
+    QGraphicsScene* scene = new QGraphicsScene();
+
+    QStringList stitches;
+    stitches << "ch" << "sc" << "dc";
+    QList<QColor> colors;
+    colors << QColor(Qt::black) << QColor(Qt::red);
+
+    int columns = 200;
+    for (int i = 0; i < cellCount; ++i)
+    {
+        Cell* c = new Cell();
+        scene->addItem(c);
+        c->setStitch(stitches.at(i % stitches.count()));
+        c->setColor(colors.at((i / stitches.count()) % colors.count()));
+        if ((i / (stitches.count() * colors.count())) % 2)
+            c->setBgColor(QColor(Qt::yellow));
+        c->setPos((i % columns) * 32, (i / columns) * 80);
+        ChartItemTools::setRotation(c, (i % 8) * 45);
+    }
+
+    return scene;
+}
@@ -20,6 +20,8 @@
  \****************************************************************************/
 #include "testtextview.h"
 #include "../src/stitchlibrary.h"
+#include "../src/repeatfinder.h"
+#include "testutils.h"
 
 void TestTextView::initTestCase()
 {
@@ -29,9 +31,11 @@ void TestTextView::initTestCase()
 
     QList< QList<Cell*> > grid = createGrid();
     qDebug() << grid;
-    foreach(QList<Cell*> row, grid) {
+    foreach(QList<Cell*> row, grid)
+    {
         QStringList rowText;
-        foreach(Cell *c, row) {
+        foreach(Cell *c, row)
+        {
             rowText.append(c->name());
         }
         mScene->gridAddRow(row, true);
@@ -79,19 +83,132 @@ void TestTextView::testGenerateTextRow_data()
      QTest::addColumn<QString>("repeatOutput");
      QTest::addColumn<QString>("cleanRepeat");
      
-     QTest::newRow("row 1") << 1 << "" << "" << "" << "";
-
+     QTest::newRow("row 1") << 0
+        << "ch 2, tr 1, ch 2, tr 1, ch 2, tr 1"
+        << "Ch 2, tr 1, ch 2, tr 1, ch 2, tr 1."
+        << "[ch 2, tr 1] 3 times"
+        << "[Ch 2, tr 1] 3 times.";
+     QTest::newRow("row 2") << 1
+        << "ch 1, twisted sc 1, tr 1, hdc3tog 1, ch 1, tr 1, hdc2tog 1, twisted sc 1, tr 2"
+        << "Ch 1, twisted sc 1, tr 1, hdc3tog 1, ch 1, tr 1, hdc2tog 1, twisted sc 1, tr 2."
+        << "ch 1, twisted sc 1, tr 1, hdc3tog 1, ch 1, tr 1, hdc2tog 1, twisted sc 1, tr 2"
+        << "Ch 1, twisted sc 1, tr 1, hdc3tog 1, ch 1, tr 1, hdc2tog 1, twisted sc 1, tr 2.";
+     QTest::newRow("row 3") << 2
+        << "ext sc 1, dc 1, ch-3 sc pic 1, ch-3 picot 1, ch-3 pic 1, bouillon 1, FPsc 1, "
+           "3-hdc cluster 1, tr 1, 3-hdc cluster 1, tr 1"
+        << "Ext sc 1, dc 1, ch-3 sc pic 1, ch-3 picot 1, ch-3 pic 1, bouillon 1, FPsc 1, "
+           "3-hdc cluster 1, tr 1, 3-hdc cluster 1, tr 1."
+        << "ext sc 1, dc 1, ch-3 sc pic 1, ch-3 picot 1, ch-3 pic 1, bouillon 1, FPsc 1, "
+           "[3-hdc cluster 1, tr 1] 2 times"
+        << "Ext sc 1, dc 1, ch-3 sc pic 1, ch-3 picot 1, ch-3 pic 1, bouillon 1, FPsc 1, "
+           "[3-hdc cluster 1, tr 1] 2 times.";
 }
 
 void TestTextView::testCopyInstructions_data()
 {
+    QTest::addColumn<QString>("instructions");
 
+    QTest::newRow("chart") << "Row 1: [Ch 2, tr 1] 3 times.\n"
+        "Row 2: Ch 1, twisted sc 1, tr 1, hdc3tog 1, ch 1, tr 1, hdc2tog 1, twisted sc 1, tr 2.\n"
+        "Row 3: Ext sc 1, dc 1, ch-3 sc pic 1, ch-3 picot 1, ch-3 pic 1, bouillon 1, FPsc 1, "
+        "[3-hdc cluster 1, tr 1] 2 times.\n";
 }
 
 void TestTextView::testCopyInstructions()
 {
-    QString instructions = mTv->copyInstructions();
-    qDebug() << instructions;
+    QFETCH(QString, instructions);
+
+    QCOMPARE(mTv->copyInstructions(), instructions);
+}
+
+void TestTextView::testRepeatRows()
+{
+    Scene scene;
+    TextView tv(0, &scene);
+
+    QStringList rows;
+    rows << "ch" << "tr" << "ch" << "tr" << "ch" << "tr" << "dc" << "dc" << "dc" << "sc" << "ch";
+    foreach(QString stitch, rows)
+        scene.gridAddRow(TestUtils::createRow(QStringList() << stitch, &scene), true);
+
+    QString expected = "Row 1: Ch 1.\n"
+        "Row 2: Tr 1.\n"
+        "Rows 3-6: Repeat rows 1-2.\n"
+        "Row 7: Dc 1.\n"
+        "Rows 8-9: Repeat row 7.\n"
+        "Row 10: Sc 1.\n"
+        "Row 11: Repeat row 1.\n";
+    QCOMPARE(tv.copyInstructions(), expected);
+}
+
+void TestTextView::testRowCache()
+{
+    Scene scene;
+    TextView tv(0, &scene);
+
+    QList<Cell *> row = TestUtils::createRow(QStringList() << "ch" << "tr" << "ch" << "tr", &scene);
+    scene.gridAddRow(row, true);
+    QCOMPARE(tv.generateTextRow(0, false, true), QString("[ch 1, tr 1] 2 times"));
+
+    // changing a stitch only regenerates its own row.
+    row[3]->setStitch("dc");
+    QCOMPARE(tv.generateTextRow(0, false, true), QString("ch 1, tr 1, ch 1, dc 1"));
+
+    // inserting a row moves the cached row down with its cells.
+    scene.gridAddRow(TestUtils::createRow(QStringList() << "sc", &scene), false, 0);
+    QCOMPARE(tv.generateTextRow(0, false, true), QString("sc 1"));
+    QCOMPARE(tv.generateTextRow(1, false, true), QString("ch 1, tr 1, ch 1, dc 1"));
+    QCOMPARE(tv.generateTextRow(1, true, false), QString("Ch 1, tr 1, ch 1, dc 1."));
+}
+
+void TestTextView::testRuns()
+{
+    QFETCH(QString, sequence);
+    QFETCH(int, minPeriod);
+    QFETCH(QString, runs);
+
+    RepeatFinder finder(RepeatFinder::encode(sequence.split(" ")));
+
+    QStringList found;
+    foreach(RepeatFinder::Run run, finder.runs(minPeriod))
+        found << QString("%1:%2x%3").arg(run.start).arg(run.period).arg(run.count);
+    found.sort();
+
+    QCOMPARE(found.join(" "), runs);
+}
+
+void TestTextView::testRuns_data()
+{
+    QTest::addColumn<QString>("sequence");
+    QTest::addColumn<int>("minPeriod");
+    QTest::addColumn<QString>("runs");
+
+    QTest::newRow("none") << "a b c d" << 1 << "";
+    QTest::newRow("single stitch") << "a a a b" << 1 << "0:1x3";
+    QTest::newRow("not primitive") << "a a a a" << 2 << "";
+    QTest::newRow("pair") << "a b a b a b c" << 1 << "0:2x3";
+    QTest::newRow("partial copy") << "c a b a b a" << 1 << "1:2x2";
+    QTest::newRow("nested") << "a b a b c a b a b c" << 2 << "0:2x2 0:5x2 5:2x2";
+}
+
+void TestTextView::testGroup()
+{
+    QHash<QString, int> codes;
+    QVector<int> sequence = RepeatFinder::encode(
+        QString("sc ch ch sc ch ch dc sc ch ch sc ch ch dc").split(" "), &codes);
+
+    QList<RepeatFinder::Item> items = RepeatFinder::group(sequence);
+
+    // [[sc, ch 2] 2 times, dc] 2 times
+    QCOMPARE(items.count(), 1);
+    QCOMPARE(items[0].value, -1);
+    QCOMPARE(items[0].count, 2);
+    QCOMPARE(items[0].items.count(), 2);
+    QCOMPARE(items[0].items[0].value, -1);
+    QCOMPARE(items[0].items[0].count, 2);
+    QCOMPARE(items[0].items[0].items[1].value, codes.value("ch"));
+    QCOMPARE(items[0].items[0].items[1].count, 2);
+    QCOMPARE(items[0].items[1].value, codes.value("dc"));
 }
 
 void TestTextView::cleanupTestCase()
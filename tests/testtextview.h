@@ -39,6 +39,11 @@ private slots:
     void testGenerateTextRow_data();
     void testCopyInstructions();
     void testCopyInstructions_data();
+    void testRepeatRows();
+    void testRowCache();
+    void testRuns();
+    void testRuns_data();
+    void testGroup();
     void cleanupTestCase();
     
 private:
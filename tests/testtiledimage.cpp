@@ -0,0 +1,209 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testtiledimage.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QSignalSpy>
+
+#include "../src/tiledimage.h"
+
+/**
+ * an image with a different colour in each 100px square.
+ */
+static QImage createImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&image);
+    for (int y = 0; y < height; y += 100) {
+        for (int x = 0; x < width; x += 100)
+            p.fillRect(x, y, 100, 100, QColor((x / 100 * 40) % 256, (y / 100 * 40) % 256, 128));
+    }
+    p.end();
+    return image;
+}
+
+void TestTiledImage::levels()
+{
+    TiledImage image;
+    image.setImage(createImage(1000, 600));
+
+    QCOMPARE(image.size(), QSize(1000, 600));
+    // 1000, 500, 250
+    QCOMPARE(image.levelCount(), 3);
+    QCOMPARE(image.levelSize(1), QSize(500, 300));
+    QCOMPARE(image.levelSize(2), QSize(250, 150));
+
+    TiledImage small;
+    small.setImage(createImage(200, 100));
+    QCOMPARE(small.levelCount(), 1);
+
+    TiledImage empty;
+    QVERIFY(empty.isNull());
+    QVERIFY(!empty.setFile("missing.png"));
+}
+
+void TestTiledImage::levelFor()
+{
+    TiledImage image;
+    image.setImage(createImage(1000, 600));
+
+    QCOMPARE(image.levelFor(2.0), 0);
+    QCOMPARE(image.levelFor(1.0), 0);
+    QCOMPARE(image.levelFor(0.75), 0);
+    QCOMPARE(image.levelFor(0.5), 1);
+    QCOMPARE(image.levelFor(0.3), 1);
+    QCOMPARE(image.levelFor(0.25), 2);
+    QCOMPARE(image.levelFor(0.01), 2);
+}
+
+void TestTiledImage::paint()
+{
+    QImage source = createImage(1000, 600);
+    TiledImage image;
+    image.setImage(source);
+
+    QImage result(1000, 600, QImage::Format_ARGB32_Premultiplied);
+    result.fill(Qt::transparent);
+    QPainter p(&result);
+    image.paint(&p, QRectF(0, 0, 1000, 600), true);
+    p.end();
+
+    // the middle of every square, away from the edges of the tiles.
+    for (int y = 50; y < 600; y += 100) {
+        for (int x = 50; x < 1000; x += 100)
+            QCOMPARE(result.pixel(x, y), source.pixel(x, y));
+    }
+
+    // only the exposed tiles are loaded.
+    TiledImage part;
+    part.setImage(source);
+    int count = TileCache::inst()->count();
+
+    result.fill(Qt::transparent);
+    p.begin(&result);
+    part.paint(&p, QRectF(10, 10, 100, 100), true);
+    p.end();
+
+    QCOMPARE(TileCache::inst()->count(), count + 1);
+    QCOMPARE(result.pixel(50, 50), source.pixel(50, 50));
+    QCOMPARE(qAlpha(result.pixel(550, 350)), 0);
+}
+
+void TestTiledImage::paintScaled()
+{
+    QImage source = createImage(1000, 600);
+    TiledImage image;
+    image.setImage(source);
+
+    QImage result(250, 150, QImage::Format_ARGB32_Premultiplied);
+    result.fill(Qt::transparent);
+    QPainter p(&result);
+    p.scale(0.25, 0.25);
+    image.paint(&p, QRectF(0, 0, 1000, 600), true);
+    p.end();
+
+    for (int y = 50; y < 600; y += 100) {
+        for (int x = 50; x < 1000; x += 100) {
+            QRgb expected = source.pixel(x, y);
+            QRgb actual = result.pixel(x / 4, y / 4);
+            QVERIFY(qAbs(qRed(expected) - qRed(actual)) <= 2);
+            QVERIFY(qAbs(qGreen(expected) - qGreen(actual)) <= 2);
+        }
+    }
+}
+
+void TestTiledImage::loadInBackground()
+{
+    QImage source = createImage(1000, 600);
+    TiledImage image;
+    QSignalSpy spy(&image, SIGNAL(tilesLoaded()));
+    image.setImage(source);
+
+    // the smallest level is loaded straight away.
+    QVERIFY(spy.wait(5000));
+
+    QImage result(1000, 600, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&result);
+    image.paint(&p, QRectF(0, 0, 1000, 600));
+    p.end();
+
+    // the thumbnail covers the image while the tiles are loading.
+    QVERIFY(qAlpha(result.pixel(500, 300)) > 0);
+
+    QVERIFY(spy.wait(5000));
+
+    p.begin(&result);
+    image.paint(&p, QRectF(0, 0, 1000, 600));
+    p.end();
+    QCOMPARE(result.pixel(550, 350), source.pixel(550, 350));
+}
+
+void TestTiledImage::cacheLimit()
+{
+    TileCache* cache = TileCache::inst();
+    int maxCost = cache->maxCost();
+
+    TiledImage image;
+    image.setImage(createImage(2000, 2000));
+    // room for four tiles next to the image.
+    cache->setMaxCost(cache->reservedCost() + 4 * 256);
+
+    QImage result(2000, 2000, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&result);
+    image.paint(&p, QRectF(0, 0, 2000, 2000), true);
+    p.end();
+
+    QVERIFY(cache->totalCost() <= 4 * 256);
+    QVERIFY(cache->count() <= 4);
+
+    cache->setMaxCost(maxCost);
+}
+
+void TestTiledImage::wholeFile()
+{
+    QImage source = createImage(1000, 600);
+    QVERIFY(source.save("testtiledimage.png"));
+
+    TileCache* cache = TileCache::inst();
+    int reserved = cache->reservedCost();
+    {
+        TiledImage image;
+        QVERIFY(image.setFile("testtiledimage.png"));
+
+        // png can't be decoded a piece at a time, the decoded file is charged to the cache.
+        QCOMPARE(cache->reservedCost(), reserved + 1000 * 600 * 4 / 1024);
+
+        QImage result(1000, 600, QImage::Format_ARGB32_Premultiplied);
+        result.fill(Qt::transparent);
+        QPainter p(&result);
+        image.paint(&p, QRectF(0, 0, 1000, 600), true);
+        p.end();
+
+        for (int y = 50; y < 600; y += 100) {
+            for (int x = 50; x < 1000; x += 100)
+                QCOMPARE(result.pixel(x, y), source.pixel(x, y));
+        }
+    }
+    QCOMPARE(cache->reservedCost(), reserved);
+
+    QFile::remove("testtiledimage.png");
+}
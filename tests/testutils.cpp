@@ -0,0 +1,60 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#include "testutils.h"
+
+#include "../src/cell.h"
+#include "../src/scene.h"
+
+QList<Cell *> TestUtils::createRow(const QStringList &stitches, Scene *scene)
+{
+    QList<Cell *> row;
+    foreach(const QString &stitch, stitches)
+    {
+        Cell *c = new Cell();
+        c->setStitch(stitch);
+        if (scene)
+            scene->addItem(c);
+        row.append(c);
+    }
+    return row;
+}
+
+QList<Cell *> TestUtils::createRow(int count, Scene *scene)
+{
+    QStringList stitches;
+    for (int i = 0; i < count; ++i)
+        stitches.append("ch");
+    return createRow(stitches, scene);
+}
+
+QList<QGraphicsItem *> TestUtils::addCells(Scene *scene, int count)
+{
+    QList<QGraphicsItem *> cells;
+    for (int i = 0; i < count; ++i)
+    {
+        Cell *c = new Cell();
+        c->setStitch("ch");
+        c->setPos((i % 300) * 32, (i / 300) * 32);
+        scene->addItem(c);
+        cells.append(c);
+    }
+    return cells;
+}
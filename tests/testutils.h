@@ -0,0 +1,48 @@
+/****************************************************************************\
+ Copyright (c) 2010-2014 Stitch Works Software
+ Brian C. Milco <bcmilco@gmail.com>
+
+ This file is part of Crochet Charts.
+
+ Crochet Charts is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Crochet Charts is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Crochet Charts. If not, see <http://www.gnu.org/licenses/>.
+
+ \****************************************************************************/
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <QList>
+#include <QStringList>
+
+class Cell;
+class QGraphicsItem;
+class Scene;
+
+/**
+ * Fixtures shared by the tests and the benchmarks.
+ *
+ * Cells handed to a scene are owned by it, the rest have to be deleted by the caller.
+ */
+class TestUtils
+{
+public:
+    /** One new cell for each stitch in stitches, added to scene when there is one. */
+    static QList<Cell *> createRow(const QStringList &stitches, Scene *scene = 0);
+    /** count new chains, added to scene when there is one. */
+    static QList<Cell *> createRow(int count, Scene *scene = 0);
+
+    /** Adds count chains to scene, laid out 300 to a line. */
+    static QList<QGraphicsItem *> addCells(Scene *scene, int count);
+};
+
+#endif // TESTUTILS_H